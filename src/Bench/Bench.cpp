@@ -0,0 +1,1354 @@
+/*************************************/
+/** Bench <source file>				**/
+/**									**/
+/** Headless benchmarks of the game	**/
+/** systems. Built by the Bench		**/
+/** target, runs without a window.	**/
+/*************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../Game/Game.h"
+#include "../Gym/Gym.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif // __linux__
+
+#define BENCH_TICKS 100000
+
+#define BENCH_GYM_GAMES 256
+#define BENCH_GYM_STEPS 2000
+
+#define BENCH_SOFT_FRAMES 2000
+
+#define BENCH_CAPTURE_FRAMES 600
+#define BENCH_CAPTURE_READ (64*1024) 			// the slow reader's bytes a read
+#define BENCH_CAPTURE_READ_DELAY 2 				// and ms rest between reads
+#define BENCH_CAPTURE_STALL_MS (500.0 / FPS) 	// half a frame
+#ifdef _WIN32
+#define BENCH_CAPTURE_FILE "NUL"
+#else
+#define BENCH_CAPTURE_FILE "/dev/null"
+#endif // _WIN32
+
+// Bytes per particle in the Particle System arrays. The update walks
+// position, velocity, age, life, frame scale and frame, and the type
+// is only read to draw
+#define BENCH_PARTICLE_HOT (7*sizeof(float) + sizeof(Sint32))
+#define BENCH_PARTICLE_COLD sizeof(Uint32)
+
+// Bytes per enemy projectile in Bullet Paths, all walked every tick
+#define BENCH_BULLET_PATH ( sizeof(BulletPaths) / POOLSIZE_ENEMY_PROJ )
+
+/*
+	The entity structs as they were before the hot/cold
+	split, with every field in one struct, so the working
+	set is compared against the old layout on whatever
+	the bench is built for.
+*/
+
+struct BenchOldAnimation
+{
+	float 					image_index;
+	float 					image_speed;
+	Uint16					image_count;
+	bool					loops;
+	Uint16 					y_offset;
+	SDL_Rect				rect;
+};
+
+struct BenchOldEnemy
+{
+	Game* 					runner;
+	EnemyType				type;
+
+	Vector2D				pos;
+	Vector2D				vel;
+
+	bool					alive;
+	Sint16					hp;
+	Sint16					hp_max;
+	Uint32					score_value;
+
+	SDL_Rect				collision;
+	Point					col_offset;
+
+	BenchOldAnimation		ship_ani;
+	AssetTexture*			sprite_texture;
+
+	Uint32					cooldown;
+
+	bool					(*update)(BenchOldEnemy*, Uint32);
+};
+
+struct BenchOldParticle
+{
+	Game*					runner;
+
+	Vector2D				pos;
+
+	bool 					alive;
+
+	BenchOldAnimation		ani;
+	AssetTexture*			texture;
+};
+
+struct BenchOldProjectile
+{
+	Game*					runner;
+
+	bool 					alive;
+	Uint8					damage;
+	bool					friendly;
+
+	Vector2D				pos;
+	Vector2D				vel;
+
+	SDL_Rect 				collision;
+	Point 					col_offset;
+
+	BenchOldAnimation		ani;
+	AssetTexture*			texture;
+};
+
+/*
+	Bench Now
+
+	Purpose: Reads the high resolution timer.
+
+	Parameters: Nil
+
+	Return:	The current time, in seconds
+*/
+
+static double 	BenchNow()
+{
+	return (double)SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency();
+}
+
+/*
+	Bench Branch Misses Open
+
+	Purpose: Opens a hardware counter for mispredicted
+			branches in this thread (Linux only).
+
+	Parameters: Nil
+
+	Return:	The counter's descriptor, or -1 if counters
+			aren't available
+*/
+
+static int 		BenchBranchMissesOpen()
+{
+	#ifdef __linux__
+	perf_event_attr attr;
+	memset( &attr, 0, sizeof(attr) );
+	attr.type 			= PERF_TYPE_HARDWARE;
+	attr.size 			= sizeof(attr);
+	attr.config 		= PERF_COUNT_HW_BRANCH_MISSES;
+	attr.disabled 		= 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv 	= 1;
+
+	return (int)syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 );
+	#else
+	return -1;
+	#endif // __linux__
+}
+
+/*
+	Bench Branch Misses Read
+
+	Purpose: Reads a branch miss counter, and resets
+			it.
+
+	Parameters: Fd - the counter from
+					BenchBranchMissesOpen
+
+	Return:	The misses counted since the last read
+*/
+
+static Uint64 	BenchBranchMissesRead( int fd )
+{
+	Uint64 count = 0;
+
+	#ifdef __linux__
+	if ( fd >= 0 )
+	{
+		if ( read( fd, &count, sizeof(count) ) != sizeof(count) )
+			count = 0;
+		ioctl( fd, PERF_EVENT_IOC_RESET, 0 );
+	}
+	#endif // __linux__
+
+	return count;
+}
+
+/*
+	Bench Game Setup
+
+	Purpose: Sets up a game without a window, renderer
+			or loaded assets, ready to be updated.
+
+	Parameters: Game - a pointer to the Game object
+					to set up.
+
+	Return:	Nil
+*/
+
+static void 	BenchGameSetup( Game* game )
+{
+	GameSetupHeadless( game, PARTICLE_CAPACITY );
+	GameStartPlay( game );
+
+	// Keep the player alive and shooting
+	game->players[0].hp_max = 0x7FFF;
+	game->players[0].buttons = INPUT_SHOOT;
+}
+
+/*
+	Bench Working Set
+
+	Purpose: Runs the update loop with the pools kept
+			busy, and estimates how many bytes of entity
+			data are walked per tick. The old single
+			struct layout is compared against the hot
+			data alone, and against hot and cold data
+			together. Each estimate is live entities
+			times their bytes each, not measured memory
+			traffic.
+
+	Parameters: Nil
+
+	Return:	Nil
+*/
+
+static void 	BenchWorkingSet()
+{
+	static Game game;
+	BenchGameSetup( &game );
+
+	double old_bytes = 0;
+	double hot_bytes = 0;
+	double cold_bytes = 0;
+
+	double start = BenchNow();
+
+	for( Uint32 tick = 0; tick < BENCH_TICKS; tick++ )
+	{
+		game.players[0].hp = game.players[0].hp_max;
+		game.players[0].buttons = INPUT_SHOOT | ( (tick / FPS) % 2 == 0 ? INPUT_LEFT : INPUT_RIGHT );
+
+		GameUpdate( &game, 1000 / FPS );
+
+		// Entities the update loops walked this tick
+		old_bytes += game.enemy_count * sizeof(BenchOldEnemy)
+				   + game.particles.count * sizeof(BenchOldParticle)
+				   + game.proj_friendly_count * sizeof(BenchOldProjectile)
+				   + game.proj_enemy_count * sizeof(BenchOldProjectile);
+
+		hot_bytes += game.enemy_count * sizeof(Enemy)
+				   + game.particles.count * BENCH_PARTICLE_HOT
+				   + game.proj_friendly_count * sizeof(Projectile)
+				   + game.proj_enemy_count * ( sizeof(Projectile) + BENCH_BULLET_PATH );
+
+		cold_bytes += game.enemy_count * sizeof(EnemyCold)
+					+ game.particles.count * BENCH_PARTICLE_COLD
+					+ game.proj_friendly_count * sizeof(ProjectileCold)
+					+ game.proj_enemy_count * sizeof(ProjectileCold);
+	}
+
+	double elapsed = BenchNow() - start;
+
+	printf( "--- Working Set ---\n" );
+	printf( "Enemy      old %3u bytes, hot %3u bytes, cold %3u bytes\n",
+			(Uint32)sizeof(BenchOldEnemy), (Uint32)sizeof(Enemy), (Uint32)sizeof(EnemyCold) );
+	printf( "Particle   old %3u bytes, hot %3u bytes, cold %3u bytes\n",
+			(Uint32)sizeof(BenchOldParticle), (Uint32)BENCH_PARTICLE_HOT, (Uint32)BENCH_PARTICLE_COLD );
+	printf( "Projectile old %3u bytes, hot %3u bytes, cold %3u bytes (+%u bytes of bullet path, enemy only)\n",
+			(Uint32)sizeof(BenchOldProjectile), (Uint32)sizeof(Projectile), (Uint32)sizeof(ProjectileCold), (Uint32)BENCH_BULLET_PATH );
+	printf( "Estimated bytes per tick (live count x bytes each)\n" );
+	printf( "  old single struct:           %10.1f\n", old_bytes / BENCH_TICKS );
+	printf( "  new hot only:                %10.1f\n", hot_bytes / BENCH_TICKS );
+	printf( "  new hot and cold:            %10.1f\n", (hot_bytes + cold_bytes) / BENCH_TICKS );
+	printf( "Update time per tick:          %10.1f ns\n\n", elapsed / BENCH_TICKS * 1e9 );
+}
+
+/*
+	Bench Enemy Spawn
+
+	Purpose: Times spawning enemies of random types
+			from the archetype table, with only the
+			built in types, and with the table full, to
+			show spawn cost doesn't grow with the number
+			of types.
+
+	Parameters: Nil
+
+	Return:	Nil
+*/
+
+static void 	BenchEnemySpawn()
+{
+	static Game game;
+	BenchGameSetup( &game );
+
+	printf( "--- Enemy Spawn ---\n" );
+
+	Uint16 type_counts[2] = { enemy_type_count, ENEMY_ARCHETYPE_MAX };
+
+	for( Uint16 t = 0; t < 2; t++ )
+	{
+		// Fill the table with copies of the built in types
+		for( Uint16 i = enemy_type_count; i < type_counts[t]; i++ )
+		{
+			game.enemy_archetypes[i] = game.enemy_archetypes[i % enemy_type_count];
+			game.enemy_archetypes[i].cold.type = (EnemyType)i;
+		}
+		game.enemy_archetype_count = type_counts[t];
+
+		Enemy* enemy = &(game.enemies[0]);
+		EnemyCold* cold = &(game.enemies_cold[0]);
+
+		double start = BenchNow();
+
+		for( Uint32 i = 0; i < BENCH_TICKS*10; i++ )
+		{
+			enemy->alive = false;
+			EnemySetup( &game, enemy, cold, (EnemyType)(i % game.enemy_archetype_count) );
+		}
+
+		double elapsed = BenchNow() - start;
+
+		printf( "%2u types: %6.1f ns per spawn\n", type_counts[t], elapsed / (BENCH_TICKS*10) * 1e9 );
+	}
+
+	printf( "\n" );
+}
+
+/*
+	Bench Enemy Dispatch
+
+	Purpose: Runs the same game with enemy updates
+			dispatched per enemy through the function
+			pointer, and batched by behaviour, comparing
+			time and mispredicted branches per tick.
+
+	Parameters: Nil
+
+	Return:	Nil
+*/
+
+static void 	BenchEnemyDispatch()
+{
+	static Game game;
+	BenchGameSetup( &game );
+
+	printf( "--- Enemy Dispatch ---\n" );
+
+	int counter = BenchBranchMissesOpen();
+	if ( counter < 0 )
+		printf( "(Branch miss counter unavailable)\n" );
+
+	const char* mode_names[2] = { "Per enemy pointer", "Batched by type" };
+
+	for( Uint16 mode = 0; mode < 2; mode++ )
+	{
+		// Both modes spawn the same enemies
+		GameReset( &game );
+		game.random_state = 0x2545F491;
+		GameStartPlay( &game );
+		game.players[0].hp_max = 0x7FFF;
+		game.batch_enemy_updates = ( mode == 1 );
+
+		double elapsed = 0;
+		Uint64 misses = 0;
+
+		for( Uint32 tick = 0; tick < BENCH_TICKS; tick++ )
+		{
+			game.players[0].hp = game.players[0].hp_max;
+
+			#ifdef __linux__
+			if ( counter >= 0 )
+				ioctl( counter, PERF_EVENT_IOC_ENABLE, 0 );
+			#endif // __linux__
+
+			double start = BenchNow();
+			GameUpdate( &game, 1000 / FPS );
+			elapsed += BenchNow() - start;
+
+			#ifdef __linux__
+			if ( counter >= 0 )
+				ioctl( counter, PERF_EVENT_IOC_DISABLE, 0 );
+			#endif // __linux__
+
+			misses += BenchBranchMissesRead( counter );
+		}
+
+		printf( "%-18s %8.1f ns per tick, %8.2f branch misses per tick\n",
+				mode_names[mode], elapsed / BENCH_TICKS * 1e9, (double)misses / BENCH_TICKS );
+	}
+
+	#ifdef __linux__
+	if ( counter >= 0 )
+		close( counter );
+	#endif // __linux__
+
+	printf( "\n" );
+}
+
+/*
+	Bench AABB Kernels
+
+	Purpose: Checks each batch box kernel against Utility
+			AABB Check, with small random boxes so edges
+			often touch exactly, then times them checking
+			one box against a full pool of projectiles.
+
+	Parameters: Nil
+
+	Return:	True if every kernel agreed with the check
+*/
+
+static bool 	BenchAabbKernels()
+{
+	static Game game;
+	ArenaInit( &(game.frame_arena), FRAME_ARENA_SIZE );
+
+	const char* kernel_names[aabb_kernel_count] = { "Auto", "Scalar", "SSE2", "AVX2" };
+	const Uint32 max_boxes = 67;
+	const Uint32 pool_boxes = POOLSIZE_ENEMY_PROJ;
+
+	printf( "--- AABB Kernels ---\n" );
+
+	AabbBatch batch;
+	UtilityAabbBatchInit( &batch, &(game.frame_arena), pool_boxes > max_boxes ? pool_boxes : max_boxes );
+
+	Uint32 hits[AABB_HIT_WORDS(pool_boxes > max_boxes ? pool_boxes : max_boxes)];
+	AabbKernel best = UtilityAabbKernelBest();
+	bool passed = true;
+
+	for( Uint16 k = AABB_KERNEL_SCALAR; k <= best; k++ )
+	{
+		// Compare with the one at a time check
+		srand( 1234 );
+		Uint32 mismatches = 0;
+
+		for( Uint32 test = 0; test < BENCH_TICKS; test++ )
+		{
+			SDL_Rect query = { rand()%48 - 8, rand()%48 - 8, rand()%17, rand()%17 };
+
+			batch.count = 0;
+			Uint32 count = rand() % (max_boxes+1);
+			for( Uint32 i = 0; i < count; i++ )
+			{
+				SDL_Rect box = { rand()%48 - 8, rand()%48 - 8, rand()%17, rand()%17 };
+				UtilityAabbBatchAdd( &batch, &box );
+			}
+
+			UtilityAabbCheckBatch( &query, &batch, hits, (AabbKernel)k );
+
+			for( Uint32 i = 0; i < count; i++ )
+			{
+				SDL_Rect box = { batch.x[i], batch.y[i], batch.w[i], batch.h[i] };
+				bool hit = ( hits[i >> 5] >> (i & 31) ) & 1;
+
+				if ( hit != UtilityAabbCheck( &query, &box ) )
+					++mismatches;
+			}
+		}
+
+		// Time a full enemy projectile pool
+		batch.count = 0;
+		for( Uint32 i = 0; i < POOLSIZE_ENEMY_PROJ; i++ )
+		{
+			SDL_Rect box = { rand()%SCREEN_WIDTH, rand()%SCREEN_HEIGHT, 5, 32 };
+			UtilityAabbBatchAdd( &batch, &box );
+		}
+
+		SDL_Rect player = { SCREEN_WIDTH/2, SCREEN_HEIGHT-64, 24, 24 };
+		Uint32 total = 0;
+
+		double start = BenchNow();
+		for( Uint32 i = 0; i < BENCH_TICKS*10; i++ )
+		{
+			player.x = i % SCREEN_WIDTH;
+			total += UtilityAabbCheckBatch( &player, &batch, hits, (AabbKernel)k );
+		}
+		double elapsed = BenchNow() - start;
+
+		printf( "%-6s %8u mismatches, %6.1f ns per %u boxes (%u hits)\n",
+				kernel_names[k], mismatches, elapsed / (BENCH_TICKS*10) * 1e9, POOLSIZE_ENEMY_PROJ, total );
+
+		if ( mismatches > 0 )
+			passed = false;
+	}
+
+	ArenaFree( &(game.frame_arena) );
+	printf( "\n" );
+	return passed;
+}
+
+/*
+	Bench Particles
+
+	Purpose: Fills the particle system with bursts of
+			each budget size, and times the update per
+			particle. Then keeps emitting past the budget,
+			to show bursts shrinking and particles being
+			dropped, rather than the update slowing down.
+
+	Parameters: Nil
+
+	Return:	Nil
+*/
+
+static void 	BenchParticles()
+{
+	static Game game;
+	BenchGameSetup( &game );
+
+	ParticleSystem* sys = &(game.particles);
+
+	printf( "--- Particles ---\n" );
+
+	Uint32 budgets[3] = { 1024, 16384, PARTICLE_CAPACITY };
+
+	for( Uint16 b = 0; b < 3; b++ )
+	{
+		ParticleSystemClear( sys );
+		ParticleSystemSetBudget( sys, budgets[b] );
+		sys->dropped = 0;
+
+		// Fill up, with sparks that live long enough to time
+		while( sys->count + 32 < sys->budget )
+			ParticleEmit( sys, Vector2D( SCREEN_WIDTH/2, SCREEN_HEIGHT/2 ), PART_SPARK );
+
+		for( Uint32 i = 0; i < sys->count; i++ )
+			sys->life[i] = 1e9f;
+
+		Uint32 count = sys->count;
+		Uint32 ticks = BENCH_TICKS * 64 / count;
+
+		double start = BenchNow();
+		for( Uint32 tick = 0; tick < ticks; tick++ )
+			ParticleSystemUpdate( sys );
+		double elapsed = BenchNow() - start;
+
+		printf( "%6u particles: %8.1f us per tick, %5.2f ns per particle\n",
+				count, elapsed / ticks * 1e6, elapsed / ((double)ticks * count) * 1e9 );
+	}
+
+	// Overload, with normal lifetimes
+	ParticleSystemClear( sys );
+	ParticleSystemSetBudget( sys, 16384 );
+	sys->dropped = 0;
+
+	Uint32 emitted = 0;
+	Uint32 peak = 0;
+
+	for( Uint32 tick = 0; tick < 1000; tick++ )
+	{
+		for( Uint16 i = 0; i < 100; i++ )
+			emitted += ParticleEmit( sys, Vector2D( rand()%SCREEN_WIDTH, rand()%SCREEN_HEIGHT ), PART_EXPLOSION_01 );
+
+		ParticleSystemUpdate( sys );
+		if ( sys->count > peak )
+			peak = sys->count;
+	}
+
+	printf( "Overload: %u emitted, %u dropped, peak %u of %u\n\n",
+			emitted, sys->dropped, peak, sys->budget );
+}
+
+/*
+	Bench Bullets
+
+	Purpose: Fills the enemy projectile pool with
+			volleys of each bullet pattern, and times
+			placing every bullet on its path, against
+			moving each one and checking it against the
+			screen as Projectile Update does.
+
+	Parameters: Nil
+
+	Return:	Nil
+*/
+
+static void 	BenchBullets()
+{
+	static Game game;
+	BenchGameSetup( &game );
+
+	const char* pattern_names[bullet_pattern_count] = { "Single", "Radial", "Spiral", "Fan" };
+
+	printf( "--- Bullets ---\n" );
+
+	for( Uint16 p = 0; p < bullet_pattern_count; p++ )
+	{
+		game.proj_enemy_count = 0;
+
+		while( game.proj_enemy_count < POOLSIZE_ENEMY_PROJ )
+		{
+			Vector2D origin( rand()%SCREEN_WIDTH, rand()%(SCREEN_HEIGHT/2) );
+			if ( BulletPatternFire( &game, origin, (BulletPattern)p ) == 0 )
+				break;
+		}
+
+		// Keep them all alive while timing
+		Uint32 count = game.proj_enemy_count;
+		for( Uint32 i = 0; i < count; i++ )
+			game.bullet_paths.exit_tick[i] = game.timers.tick + BENCH_TICKS;
+
+		Uint32 ticks = BENCH_TICKS / 10;
+
+		double start = BenchNow();
+		for( Uint32 tick = 0; tick < ticks; tick++ )
+		{
+			++game.timers.tick;
+			BulletPathsUpdate( &game );
+		}
+		double paths = BenchNow() - start;
+
+		start = BenchNow();
+		for( Uint32 tick = 0; tick < ticks; tick++ )
+		{
+			for( Uint32 i = 0; i < count; i++ )
+			{
+				game.projectiles_enemy[i].alive = true;
+				ProjectileUpdate( &(game.projectiles_enemy[i]), 16 );
+			}
+		}
+		double stepped = BenchNow() - start;
+
+		printf( "%-6s %5u bullets: %6.2f ns per bullet on paths, %6.2f ns stepped\n",
+				pattern_names[p], count, paths / ((double)ticks * count) * 1e9,
+				stepped / ((double)ticks * count) * 1e9 );
+	}
+
+	printf( "\n" );
+}
+
+/*
+	Bench Snapshot
+
+	Purpose: Times saving and restoring a snapshot of a
+			game with busy pools. Then checks that running
+			on from a restored snapshot gives the same
+			state as running on from where it was taken.
+
+	Parameters: Nil
+
+	Return:	True if the snapshot fit, and running on
+			from it matched
+*/
+
+static bool 	BenchSnapshot()
+{
+	static Game game;
+	BenchGameSetup( &game );
+
+	static Uint8 buffers[3][1024*1024];
+	Uint8* base = buffers[0];
+	Uint8* first = buffers[1];
+	Uint8* second = buffers[2];
+
+	printf( "--- Snapshot ---\n" );
+
+	// Fill the pools, keeping the player alive
+	for( Uint32 tick = 0; tick < 600; tick++ )
+	{
+		game.players[0].hp = game.players[0].hp_max;
+		GameUpdate( &game, 16 );
+	}
+
+	while( BulletPatternFire( &game, Vector2D( SCREEN_WIDTH/2, SCREEN_HEIGHT/4 ), BULLET_PATTERN_RADIAL ) > 0 )
+		;
+
+	Uint32 size = GameSnapshotSave( &game, base, sizeof(buffers[0]) );
+	if ( size == 0 )
+	{
+		printf( "Error: %u byte snapshot doesn't fit the bench buffer\n\n", GameSnapshotSize( &game ) );
+		return false;
+	}
+
+	Uint32 runs = BENCH_TICKS / 10;
+
+	double start = BenchNow();
+	for( Uint32 i = 0; i < runs; i++ )
+		GameSnapshotSave( &game, first, sizeof(buffers[1]) );
+	double saving = BenchNow() - start;
+
+	start = BenchNow();
+	for( Uint32 i = 0; i < runs; i++ )
+		GameSnapshotRestore( &game, base, size );
+	double restoring = BenchNow() - start;
+
+	printf( "%u enemies, %u projectiles: %u bytes, of %u a rollback slot holds\n",
+			game.enemy_count, game.proj_friendly_count + game.proj_enemy_count, size, ROLLBACK_SNAPSHOT_MAX );
+	printf( "Save %6.2f us, Restore %6.2f us\n", saving / runs * 1e6, restoring / runs * 1e6 );
+
+	// Run on, go back, and run on again
+	for( Uint32 tick = 0; tick < 300; tick++ )
+		GameUpdate( &game, 16 );
+	Uint32 first_size = GameSnapshotSave( &game, first, sizeof(buffers[1]) );
+
+	GameSnapshotRestore( &game, base, size );
+
+	for( Uint32 tick = 0; tick < 300; tick++ )
+		GameUpdate( &game, 16 );
+	Uint32 second_size = GameSnapshotSave( &game, second, sizeof(buffers[2]) );
+
+	bool same = ( first_size == second_size && memcmp( first, second, first_size ) == 0 );
+	printf( "Replay from a restored snapshot: %s\n\n", same ? "matches" : "DIFFERS" );
+	return same;
+}
+
+/*
+	Bench Checksum
+
+	Purpose: Times the per-tick checksum with busy pools.
+			Then runs the same inputs with batched and
+			one-at-a-time enemy updates, checking every
+			tick comes out the same.
+
+	Parameters: Nil
+
+	Return:	True if every tick came out the same
+*/
+
+static bool 	BenchChecksum()
+{
+	static Game game;
+	BenchGameSetup( &game );
+
+	printf( "--- Checksum ---\n" );
+
+	// Fill the pools, keeping the player alive
+	for( Uint32 tick = 0; tick < 600; tick++ )
+	{
+		game.players[0].hp = game.players[0].hp_max;
+		GameUpdate( &game, 16 );
+	}
+
+	while( BulletPatternFire( &game, Vector2D( SCREEN_WIDTH/2, SCREEN_HEIGHT/4 ), BULLET_PATTERN_RADIAL ) > 0 )
+		;
+
+	GameChecksum checksum;
+	Uint32 runs = BENCH_TICKS / 10;
+
+	double start = BenchNow();
+	for( Uint32 i = 0; i < runs; i++ )
+		GameChecksumCompute( &game, &checksum );
+	double hashing = BenchNow() - start;
+
+	printf( "%u enemies, %u projectiles: %6.2f us\n",
+			game.enemy_count, game.proj_friendly_count + game.proj_enemy_count, hashing / runs * 1e6 );
+
+	// Same seed and inputs, both ways of updating enemies
+	static Game batched;
+	static Game single;
+	BenchGameSetup( &batched );
+	BenchGameSetup( &single );
+
+	batched.random_state = single.random_state = 0x2545F491;
+	batched.batch_enemy_updates = true;
+	single.batch_enemy_updates = false;
+
+	Uint32 ticks = BENCH_TICKS / 10;
+	Uint32 tick = 0;
+
+	for( ; tick < ticks; tick++ )
+	{
+		Uint8 inputs[PLAYER_MAX] = { (Uint8)( INPUT_SHOOT | INPUT_START | ( (tick / FPS) % 2 == 0 ? INPUT_LEFT : INPUT_RIGHT ) ) };
+
+		GameTick( &batched, inputs, 1000 / FPS );
+		GameTick( &single, inputs, 1000 / FPS );
+
+		GameChecksum single_checksum, batched_checksum;
+		GameChecksumCompute( &single, &single_checksum );
+		GameChecksumCompute( &batched, &batched_checksum );
+
+		if ( !GameChecksumCompare( &single_checksum, &batched_checksum, tick ) )
+			break;
+	}
+
+	printf( "Batched and single enemy updates: %s over %u ticks\n\n", tick == ticks ? "match" : "DIFFER", tick );
+	return tick == ticks;
+}
+
+/*
+	Bench Rollback Run
+
+	Purpose: Plays two games against each other over
+			loopback UDP, with packets made late and
+			lost, and prints the cost of rolling back.
+
+	Parameters: Latency - ms added to every packet
+				Jitter - most ms added or taken away
+				Loss - percent of packets dropped
+
+	Return:	False if either side saw a desync. Runs
+			that can't open their ports are skipped.
+*/
+
+static bool 	BenchRollbackRun( Uint32 latency, Uint32 jitter, Uint32 loss )
+{
+	static Game games[ROLLBACK_PLAYERS];
+
+	for( Uint16 p = 0; p < ROLLBACK_PLAYERS; p++ )
+		BenchGameSetup( &(games[p]) );
+
+	if ( !RollbackStart( &(games[0]), 0, 27960, "127.0.0.1", 27961 ) )
+		return true;
+
+	if ( !RollbackStart( &(games[1]), 1, 27961, "127.0.0.1", 27960 ) )
+	{
+		RollbackStop( &(games[0]) );
+		return true;
+	}
+
+	for( Uint16 p = 0; p < ROLLBACK_PLAYERS; p++ )
+		RollbackSetConditions( &(games[p]), latency, jitter, loss );
+
+	printf( "%u ms latency, %u ms jitter, %u%% loss\n", latency, jitter, loss );
+
+	// A minute of play, the players changing direction at different
+	// times, and the second joining after two seconds
+	Uint32 ticks = 60*FPS;
+	for( Uint32 tick = 0; tick < ticks; tick++ )
+	{
+		Uint32 now = tick * 1000 / FPS;
+
+		Uint8 input0 = INPUT_SHOOT | INPUT_START | ( (tick / 45) % 2 == 0 ? INPUT_LEFT : INPUT_RIGHT );
+		Uint8 input1 = ( (tick / 70) % 3 == 0 ? INPUT_UP : ( (tick / 70) % 3 == 1 ? INPUT_DOWN : 0 ) ) |
+					   ( tick >= 2*FPS ? INPUT_START | INPUT_SHOOT : 0 );
+
+		RollbackAdvance( &(games[0]), input0, now );
+		RollbackAdvance( &(games[1]), input1, now );
+	}
+
+	Uint32 desyncs = 0;
+	for( Uint16 p = 0; p < ROLLBACK_PLAYERS; p++ )
+	{
+		desyncs += games[p].rollback.desyncs;
+		RollbackStop( &(games[p]) );
+	}
+
+	return desyncs == 0;
+}
+
+/*
+	Bench Rollback
+
+	Purpose: Runs the rollback harness on a good network
+			and a bad one.
+
+	Parameters: Nil
+
+	Return:	True if neither desynced
+*/
+
+static bool 	BenchRollback()
+{
+	printf( "--- Rollback ---\n" );
+
+	bool good = BenchRollbackRun( 20, 5, 0 );
+	bool bad = BenchRollbackRun( 80, 30, 5 );
+
+	printf( "\n" );
+	return good && bad;
+}
+
+/*
+	Bench Net State
+
+	Purpose: Runs a busy game with the enemy projectile
+			pool kept at several sizes, and encodes every
+			tick against the one before, as a client
+			acking every state would get. Reports the
+			bytes per tick, whole and as changes, the time
+			to encode and decode, and checks every decoded
+			state matches what was sent.
+
+	Parameters: Nil
+
+	Return:	True if every state decoded the same
+*/
+
+static bool 	BenchNetState()
+{
+	static Game game;
+	BenchGameSetup( &game );
+
+	static NetStateHistory sent;
+	static NetStateHistory received;
+	static Uint8 buffer[NET_STATE_BYTES_MAX];
+
+	printf( "--- Net State ---\n" );
+
+	// Fill the enemy and friendly pools, keeping the player alive
+	for( Uint32 tick = 0; tick < 600; tick++ )
+	{
+		game.players[0].hp = game.players[0].hp_max;
+		GameUpdate( &game, 16 );
+	}
+
+	const Uint16 bullet_counts[] = { 0, 128, 512, 2048 };
+	Uint32 tick = 0;
+	bool passed = true;
+
+	for( Uint16 c = 0; c < SDL_arraysize(bullet_counts); c++ )
+	{
+		Uint16 target = bullet_counts[c];
+		Uint32 ticks = BENCH_TICKS / 100;
+
+		Uint64 delta_bytes = 0;
+		Uint64 full_bytes = 0;
+		Uint64 bullets = 0;
+		double encoding = 0;
+		double decoding = 0;
+		float error = 0;
+		bool same = true;
+
+		for( Uint32 t = 0; t < ticks; t++, tick++ )
+		{
+			game.players[0].hp = game.players[0].hp_max;
+			GameUpdate( &game, 16 );
+
+			// Top the bullets up, or drop the newest
+			while( game.proj_enemy_count < target &&
+				   BulletPatternFire( &game, Vector2D( rand()%SCREEN_WIDTH, rand()%(SCREEN_HEIGHT/2) ), BULLET_PATTERN_SPIRAL ) > 0 )
+				;
+			if ( game.proj_enemy_count > target )
+				game.proj_enemy_count = target;
+
+			bullets += game.proj_enemy_count;
+
+			NetState* state = NetStateHistoryAdd( &sent, tick );
+			NetStateCapture( &game, tick, state );
+
+			full_bytes += NetStateEncode( state, nullptr, buffer, sizeof(buffer) );
+
+			double start = BenchNow();
+			Uint32 size = NetStateEncode( state, NetStateHistoryFind( &sent, tick - 1 ), buffer, sizeof(buffer) );
+			encoding += BenchNow() - start;
+
+			// The first tick has nothing to go from
+			if ( NetStateHistoryFind( &received, tick - 1 ) == nullptr )
+				size = NetStateEncode( state, nullptr, buffer, sizeof(buffer) );
+
+			delta_bytes += size;
+
+			start = BenchNow();
+			NetState* decoded = NetStateDecode( buffer, size, &received );
+			decoding += BenchNow() - start;
+
+			if ( decoded == nullptr || !NetStateEqual( state, decoded ) )
+			{
+				same = false;
+				break;
+			}
+
+			// Furthest any bullet or the player is from where it's sent
+			const NetEntity* sent_bullets = decoded->entities + PLAYER_MAX + POOLSIZE_ENEMY + POOLSIZE_FRIENDLY_PROJ;
+			for( Uint16 i = 0; i < game.proj_enemy_count; i++ )
+			{
+				error = fmaxf( error, fabsf( NetStatePosition( sent_bullets[i].fields[NET_FIELD_X] ) - game.projectiles_enemy[i].pos.x ) );
+				error = fmaxf( error, fabsf( NetStatePosition( sent_bullets[i].fields[NET_FIELD_Y] ) - game.projectiles_enemy[i].pos.y ) );
+			}
+
+			error = fmaxf( error, fabsf( NetStatePosition( decoded->entities[0].fields[NET_FIELD_X] ) - game.players[0].pos.x ) );
+			error = fmaxf( error, fabsf( NetStatePosition( decoded->entities[0].fields[NET_FIELD_Y] ) - game.players[0].pos.y ) );
+		}
+
+		printf( "%4u bullets: %6.0f bytes per tick (%6.0f whole), encode %7.0f ns, decode %7.0f ns, %.3f px error, %s\n",
+				(Uint32)( bullets / ticks ), (double)delta_bytes / ticks, (double)full_bytes / ticks,
+				encoding / ticks * 1e9, decoding / ticks * 1e9, error, same ? "decodes the same" : "DIFFERS" );
+
+		if ( !same )
+			passed = false;
+	}
+
+	printf( "\n" );
+	return passed;
+}
+
+/*
+	Bench Gym Run
+
+	Purpose: Steps a gym with scripted actions, and times
+			it. Actions depend only on the step and the
+			game, so runs on any number of threads should
+			come out the same.
+
+	Parameters: Threads - threads to step on
+				Result - where to put the summed rewards,
+					dones and observations, to compare
+
+	Return:	Env steps per second
+*/
+
+static double 	BenchGymRun( Uint32 threads, double* result )
+{
+	Gym* gym = GymCreate( BENCH_GYM_GAMES, threads, GYM_FRAME_SKIP, 0 );
+	if ( gym == nullptr )
+		return 0;
+
+	// Caller owned buffers, as a trainer would hold them
+	static float observations[BENCH_GYM_GAMES * GYM_OBS_SIZE];
+	static float rewards[BENCH_GYM_GAMES];
+	static Uint8 dones[BENCH_GYM_GAMES];
+	static Uint8 actions[BENCH_GYM_GAMES];
+	static uint64_t seeds[BENCH_GYM_GAMES];
+
+	for( Uint32 i = 0; i < BENCH_GYM_GAMES; i++ )
+		seeds[i] = 1000 + i;
+
+	GymReset( gym, seeds, observations );
+
+	double total = 0;
+	double start = BenchNow();
+
+	for( Uint32 step = 0; step < BENCH_GYM_STEPS; step++ )
+	{
+		for( Uint32 i = 0; i < BENCH_GYM_GAMES; i++ )
+			actions[i] = (Uint8)( ( (step / 8) * 2654435761u + i * 40503u ) >> 11 ) & (GYM_ACTION_COUNT-1);
+
+		GymStep( gym, actions, observations, rewards, dones );
+
+		for( Uint32 i = 0; i < BENCH_GYM_GAMES; i++ )
+			total += rewards[i] + dones[i] * 1000.0;
+	}
+
+	double seconds = BenchNow() - start;
+
+	for( Uint32 i = 0; i < BENCH_GYM_GAMES * GYM_OBS_SIZE; i++ )
+		total += observations[i];
+
+	GymDestroy( gym );
+
+	*result = total;
+	return BENCH_GYM_GAMES * (double)BENCH_GYM_STEPS / seconds;
+}
+
+/*
+	Bench Gym
+
+	Purpose: Reports the gym's throughput, in env steps
+			and game ticks a second, on one thread and
+			on every core, and checks both agree.
+
+	Parameters: Nil
+
+	Return:	True if both ran and agreed
+*/
+
+static bool 	BenchGym()
+{
+	printf( "--- Gym: %u games, %u steps ---\n", BENCH_GYM_GAMES, BENCH_GYM_STEPS );
+
+	double single_result = 0;
+	double threaded_result = 0;
+
+	double single = BenchGymRun( 1, &single_result );
+	double threaded = BenchGymRun( 0, &threaded_result );
+
+	printf( "1 thread:   %9.0f env steps/s (%9.0f ticks/s)\n", single, single * GYM_FRAME_SKIP );
+	printf( "%2u threads: %9.0f env steps/s (%9.0f ticks/s), %.2fx\n",
+			(Uint32)SDL_GetCPUCount(), threaded, threaded * GYM_FRAME_SKIP, threaded / single );
+	bool same = ( single > 0 && threaded > 0 && single_result == threaded_result );
+	printf( "Threaded and single runs: %s\n\n", same ? "match" : "DIFFER" );
+	return same;
+}
+
+/*
+	Bench Soft Render
+
+	Purpose: Times the software renderer drawing a busy
+			screen, at observation sizes and full size.
+
+	Parameters: Nil
+
+	Return:	Nil
+*/
+
+static void 	BenchSoftRender()
+{
+	static Game game;
+	BenchGameSetup( &game );
+
+	printf( "--- Soft Render: %u frames ---\n", BENCH_SOFT_FRAMES );
+
+	for( Uint32 tick = 0; tick < 600; tick++ )
+	{
+		game.players[0].hp = game.players[0].hp_max;
+		GameUpdate( &game, 16 );
+	}
+
+	for( Uint32 volley = 0; volley < 4; volley++ )
+		BulletPatternFire( &game, Vector2D( SCREEN_WIDTH/2, SCREEN_HEIGHT/4 ), BULLET_PATTERN_RADIAL );
+	BulletPathsPlace( &game );
+
+	static const struct { Uint16 width; Uint16 height; SoftRenderFormat format; const char* name; } sizes[] =
+	{
+		{ 84, 84, SOFT_RENDER_GRAY, "gray" },
+		{ 160, 120, SOFT_RENDER_RGB, "rgb" },
+		{ SCREEN_WIDTH, SCREEN_HEIGHT, SOFT_RENDER_RGBA, "rgba" },
+	};
+
+	static Uint8 pixels[SCREEN_WIDTH * SCREEN_HEIGHT * 4];
+	static SoftRenderer soft;
+
+	for( const auto& size : sizes )
+	{
+		if ( !SoftRenderInit( &game, &soft, size.width, size.height, size.format ) )
+		{
+			printf( "Skipped, the images could not be loaded\n\n" );
+			return;
+		}
+
+		Uint32 frames = BENCH_SOFT_FRAMES;
+		if ( size.width == SCREEN_WIDTH )
+			frames /= 10;
+
+		double start = BenchNow();
+		for( Uint32 i = 0; i < frames; i++ )
+			SoftRenderGame( &game, &soft, pixels, 0 );
+		double seconds = BenchNow() - start;
+
+		printf( "%3ux%-3u %-4s: %8.0f frames/s, %u sprites\n", size.width, size.height, size.name, frames / seconds,
+				game.proj_friendly_count + game.proj_enemy_count + game.enemy_count + 1 );
+	}
+
+	SoftRenderFree( &soft );
+
+	// Pixel observations for a whole gym, on every core
+	Gym* gym = GymCreate( BENCH_GYM_GAMES, 0, GYM_FRAME_SKIP, 0 );
+	if ( gym == nullptr || GymSetPixels( gym, 84, 84, GYM_PIXELS_GRAY ) != 0 )
+	{
+		GymDestroy( gym );
+		printf( "\n" );
+		return;
+	}
+
+	static float observations[BENCH_GYM_GAMES * GYM_OBS_SIZE];
+	static float rewards[BENCH_GYM_GAMES];
+	static Uint8 dones[BENCH_GYM_GAMES];
+	static Uint8 actions[BENCH_GYM_GAMES];
+	static Uint8 frames[BENCH_GYM_GAMES * 84 * 84];
+
+	GymReset( gym, nullptr, observations );
+
+	Uint32 steps = BENCH_SOFT_FRAMES / 20;
+	double rendering = 0;
+
+	for( Uint32 step = 0; step < steps; step++ )
+	{
+		for( Uint32 i = 0; i < BENCH_GYM_GAMES; i++ )
+			actions[i] = GYM_ACTION_SHOOT | ( (step / 16 + i) % 2 == 0 ? GYM_ACTION_LEFT : GYM_ACTION_RIGHT );
+
+		GymStep( gym, actions, observations, rewards, dones );
+
+		double start = BenchNow();
+		GymRender( gym, frames );
+		rendering += BenchNow() - start;
+	}
+
+	GymDestroy( gym );
+
+	printf( "Gym, 84x84 gray: %8.0f frames/s on %u threads\n\n",
+			BENCH_GYM_GAMES * (double)steps / rendering, (Uint32)SDL_GetCPUCount() );
+}
+
+/*
+	Bench Capture Run
+
+	Purpose: Offers a started capture frames from the
+			software renderer as fast as the game can
+			draw them, timing each capture on the game's
+			thread. The caller stops it.
+
+	Parameters: Game - the game being captured
+				Dropped - receives the frames dropped
+				Slowest - receives the slowest capture,
+					in seconds
+
+	Return:	Frames offered a second
+*/
+
+static double 	BenchCaptureRun( Game* game, Uint32* dropped, double* slowest )
+{
+	*slowest = 0;
+	double start = BenchNow();
+
+	for( Uint32 frame = 0; frame < BENCH_CAPTURE_FRAMES; frame++ )
+	{
+		game->players[0].hp = game->players[0].hp_max;
+		GameUpdate( game, 16 );
+		CaptureTick( game );
+
+		double before = BenchNow();
+		CaptureFrame( game );
+		double taken = BenchNow() - before;
+
+		if ( taken > *slowest )
+			*slowest = taken;
+	}
+
+	*dropped = game->capture.dropped;
+	return BENCH_CAPTURE_FRAMES / ( BenchNow() - start );
+}
+
+#ifdef __linux__
+static SDL_atomic_t bench_capture_drain;
+
+/*
+	Bench Capture Slow Reader
+
+	Purpose: <Thread Function>
+			 Reads a pipe a little at a time, resting
+			 between reads, so its writer falls behind,
+			 until told to drain it. Stops when the pipe
+			 is closed.
+
+	Parameters: Data - the pipe's read end, as an int
+
+	Return:	0
+*/
+
+static int 		BenchCaptureSlowReader( void* data )
+{
+	int fd = (int)(intptr_t)data;
+	static char buffer[BENCH_CAPTURE_READ];
+
+	while( read( fd, buffer, sizeof(buffer) ) > 0 )
+	{
+		if ( !SDL_AtomicGet( &bench_capture_drain ) )
+			SDL_Delay( BENCH_CAPTURE_READ_DELAY );
+	}
+
+	close( fd );
+	return 0;
+}
+#endif // __linux__
+
+/*
+	Bench Capture
+
+	Purpose: Captures to nowhere, to show what writing
+			each format costs, then on Linux to a pipe
+			read too slowly to keep up. Capturing must
+			then drop frames rather than hold up the
+			game's thread.
+
+	Parameters: Nil
+
+	Return:	False if the overloaded capture stalled the
+			game, or dropped nothing
+*/
+
+static bool 	BenchCapture()
+{
+	static Game game;
+	BenchGameSetup( &game );
+
+	printf( "--- Capture: %u frames ---\n", BENCH_CAPTURE_FRAMES );
+
+	static const CaptureFormat formats[] = { CAPTURE_RAW_RGB, CAPTURE_Y4M };
+
+	Uint32 dropped = 0;
+	double slowest = 0;
+
+	for( CaptureFormat format : formats )
+	{
+		if ( !CaptureStart( &game, BENCH_CAPTURE_FILE, format, CAPTURE_SOURCE_SOFT ) )
+		{
+			printf( "Skipped, capture could not start\n\n" );
+			return true;
+		}
+
+		double rate = BenchCaptureRun( &game, &dropped, &slowest );
+		CaptureStop( &game );
+
+		printf( "%-4s: %6.0f frames/s offered, %u dropped, slowest capture %.2f ms\n",
+				format == CAPTURE_Y4M ? "y4m" : "raw", rate, dropped, slowest * 1000 );
+	}
+
+	bool passed = true;
+
+	#ifdef __linux__
+	int fds[2];
+	if ( pipe( fds ) != 0 )
+	{
+		printf( "Skipped the slow writer, no pipe\n\n" );
+		return true;
+	}
+
+	// Capture opens the pipe by name, then our end is closed, so
+	// the reader sees the pipe end once capture closes its own
+	char path[32];
+	snprintf( path, sizeof(path), "/dev/fd/%d", fds[1] );
+
+	SDL_Thread* reader = SDL_CreateThread( BenchCaptureSlowReader, "BenchReader", (void*)(intptr_t)fds[0] );
+	if ( reader == nullptr )
+	{
+		close( fds[0] );
+		close( fds[1] );
+		printf( "Skipped the slow writer, no reader thread\n\n" );
+		return true;
+	}
+
+	bool started = CaptureStart( &game, path, CAPTURE_RAW_RGB, CAPTURE_SOURCE_SOFT );
+	close( fds[1] );
+
+	double rate = ( started ? BenchCaptureRun( &game, &dropped, &slowest ) : 0 );
+
+	// Timing's done, so read the rest quickly
+	SDL_AtomicSet( &bench_capture_drain, 1 );
+	CaptureStop( &game );
+	SDL_WaitThread( reader, nullptr );
+
+	passed = ( rate > 0 && dropped > 0 && slowest * 1000 < BENCH_CAPTURE_STALL_MS );
+
+	printf( "slow: %6.0f frames/s offered, %u dropped, slowest capture %.2f ms (limit %.1f ms): %s\n",
+			rate, dropped, slowest * 1000, BENCH_CAPTURE_STALL_MS, passed ? "ok" : "FAILED" );
+	#endif // __linux__
+
+	printf( "\n" );
+	return passed;
+}
+
+int main( int argc, char** argv )
+{
+	printf( "--- JetFighter Benchmarks ---\n\n" );
+
+	// Every section runs, then any failed check fails the run
+	bool passed = true;
+
+	BenchWorkingSet();
+	BenchEnemySpawn();
+	BenchEnemyDispatch();
+	passed = BenchAabbKernels() && passed;
+	BenchParticles();
+	BenchBullets();
+	passed = BenchSnapshot() && passed;
+	passed = BenchChecksum() && passed;
+	passed = BenchRollback() && passed;
+	passed = BenchNetState() && passed;
+	passed = BenchGym() && passed;
+	BenchSoftRender();
+	passed = BenchCapture() && passed;
+
+	if ( !passed )
+		printf( "--- Benchmarks FAILED a check ---\n" );
+
+	return passed ? 0 : 1;
+}
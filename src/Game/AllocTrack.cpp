@@ -0,0 +1,417 @@
+/*************************************/
+/** Alloc Track <source file>		**/
+/**									**/
+/** Instrumented build mode that	**/
+/** counts heap allocations made	**/
+/** during each phase of a tick.	**/
+/** Only built with ALLOC_TRACKING	**/
+/*************************************/
+
+#ifdef ALLOC_TRACKING
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <new>
+
+#include "Game.h"
+
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <malloc.h>
+#endif // __GLIBC__
+
+#define ALLOC_TRACK_SITES 128
+
+//////////////////////////////////////////////////////
+// Tracking State									//
+//////////////////////////////////////////////////////
+
+struct AllocSite
+{
+	void*					address;
+	Uint32					count;
+	AllocPhase				phase;
+};
+
+static const char* 			alloc_phase_names[alloc_phase_count] = { "None", "Input", "Update", "Render" };
+
+// Only the thread that called AllocTrackBegin is tracked, so
+// background threads (e.g. the asset watcher) don't add noise
+static __thread bool		alloc_track_thread = false;
+static __thread bool		alloc_track_busy = false;
+
+static AllocPhase			alloc_phase = ALLOC_PHASE_NONE;
+static Uint32				alloc_phase_allocs[alloc_phase_count];
+static Uint32				alloc_phase_frees[alloc_phase_count];
+static Uint32				alloc_tick_allocs = 0;
+
+static AllocSite			alloc_sites[ALLOC_TRACK_SITES];
+static Uint32				alloc_site_count = 0;
+static Uint32				alloc_site_dropped = 0;
+
+/*
+	Alloc Track Record
+
+	Purpose: Records one allocation against the
+			current phase, and against its call site.
+
+	Parameters: Address - the return address of the
+					allocation call
+
+	Return:	Nil
+*/
+
+static void 	AllocTrackRecord( void* address )
+{
+	if ( !alloc_track_thread || alloc_track_busy || alloc_phase == ALLOC_PHASE_NONE )
+		return;
+
+	alloc_track_busy = true;
+
+	++alloc_phase_allocs[alloc_phase];
+	++alloc_tick_allocs;
+
+	// Find the call site, adding it if it's new
+	Uint32 i = 0;
+	for( ; i < alloc_site_count; i++ )
+	{
+		if ( alloc_sites[i].address == address && alloc_sites[i].phase == alloc_phase )
+			break;
+	}
+
+	if ( i == alloc_site_count )
+	{
+		if ( alloc_site_count < ALLOC_TRACK_SITES )
+		{
+			alloc_sites[i].address 	= address;
+			alloc_sites[i].count 	= 0;
+			alloc_sites[i].phase 	= alloc_phase;
+			++alloc_site_count;
+		}
+		else
+			++alloc_site_dropped;
+	}
+
+	if ( i < alloc_site_count )
+		++alloc_sites[i].count;
+
+	alloc_track_busy = false;
+}
+
+/*
+	Alloc Track Record Free
+
+	Purpose: Records one free against the current phase.
+
+	Parameters: Nil
+
+	Return:	Nil
+*/
+
+static void 	AllocTrackRecordFree()
+{
+	if ( !alloc_track_thread || alloc_phase == ALLOC_PHASE_NONE )
+		return;
+
+	++alloc_phase_frees[alloc_phase];
+}
+
+//////////////////////////////////////////////////////
+// Interposed Allocators							//
+//////////////////////////////////////////////////////
+
+#if defined(__GLIBC__)
+
+extern "C"
+{
+	void* 		__libc_malloc( size_t size );
+	void* 		__libc_calloc( size_t count, size_t size );
+	void* 		__libc_realloc( void* ptr, size_t size );
+	void* 		__libc_memalign( size_t align, size_t size );
+	void 		__libc_free( void* ptr );
+
+	void* 		malloc( size_t size )
+	{
+		AllocTrackRecord( __builtin_return_address(0) );
+		return __libc_malloc( size );
+	}
+
+	void* 		calloc( size_t count, size_t size )
+	{
+		AllocTrackRecord( __builtin_return_address(0) );
+		return __libc_calloc( count, size );
+	}
+
+	void* 		realloc( void* ptr, size_t size )
+	{
+		AllocTrackRecord( __builtin_return_address(0) );
+		return __libc_realloc( ptr, size );
+	}
+
+	void* 		memalign( size_t align, size_t size )
+	{
+		AllocTrackRecord( __builtin_return_address(0) );
+		return __libc_memalign( align, size );
+	}
+
+	int 		posix_memalign( void** ptr, size_t align, size_t size )
+	{
+		AllocTrackRecord( __builtin_return_address(0) );
+		*ptr = __libc_memalign( align, size );
+		return ( *ptr == nullptr ? ENOMEM : 0 );
+	}
+
+	void 		free( void* ptr )
+	{
+		if ( ptr != nullptr )
+			AllocTrackRecordFree();
+		__libc_free( ptr );
+	}
+}
+
+#define ALLOC_TRACK_RAW_MALLOC __libc_malloc
+#define ALLOC_TRACK_RAW_FREE __libc_free
+
+#else
+
+// Without glibc we can only see C++ allocations
+#define ALLOC_TRACK_RAW_MALLOC malloc
+#define ALLOC_TRACK_RAW_FREE free
+
+#endif // __GLIBC__
+
+void* 			operator new( size_t size )
+{
+	AllocTrackRecord( __builtin_return_address(0) );
+
+	void* ptr = ALLOC_TRACK_RAW_MALLOC( size ? size : 1 );
+	if ( ptr == nullptr )
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* 			operator new[]( size_t size )
+{
+	AllocTrackRecord( __builtin_return_address(0) );
+
+	void* ptr = ALLOC_TRACK_RAW_MALLOC( size ? size : 1 );
+	if ( ptr == nullptr )
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* 			operator new( size_t size, const std::nothrow_t& ) noexcept
+{
+	AllocTrackRecord( __builtin_return_address(0) );
+	return ALLOC_TRACK_RAW_MALLOC( size ? size : 1 );
+}
+
+void* 			operator new[]( size_t size, const std::nothrow_t& ) noexcept
+{
+	AllocTrackRecord( __builtin_return_address(0) );
+	return ALLOC_TRACK_RAW_MALLOC( size ? size : 1 );
+}
+
+void 			operator delete( void* ptr ) noexcept
+{
+	if ( ptr != nullptr )
+		AllocTrackRecordFree();
+	ALLOC_TRACK_RAW_FREE( ptr );
+}
+
+void 			operator delete[]( void* ptr ) noexcept
+{
+	if ( ptr != nullptr )
+		AllocTrackRecordFree();
+	ALLOC_TRACK_RAW_FREE( ptr );
+}
+
+void 			operator delete( void* ptr, size_t size ) noexcept
+{
+	operator delete( ptr );
+}
+
+void 			operator delete[]( void* ptr, size_t size ) noexcept
+{
+	operator delete[]( ptr );
+}
+
+//////////////////////////////////////////////////////
+// Tracking Functions								//
+//////////////////////////////////////////////////////
+
+/*
+	Alloc Track Begin
+
+	Purpose: Starts tracking allocations made by the
+			calling thread. Call once from the main
+			thread.
+
+	Parameters: Nil
+
+	Return:	Nil
+*/
+
+void 			AllocTrackBegin()
+{
+	alloc_track_thread = true;
+	alloc_phase = ALLOC_PHASE_NONE;
+}
+
+/*
+	Alloc Track Phase
+
+	Purpose: Sets the phase that following allocations
+			are counted against. Allocations made in
+			ALLOC_PHASE_NONE are not counted.
+
+	Parameters: Phase - the phase being entered
+
+	Return:	Nil
+*/
+
+void 			AllocTrackPhase( AllocPhase phase )
+{
+	alloc_phase = phase;
+}
+
+/*
+	Alloc Track Tick End
+
+	Purpose: Ends the current tick.
+
+	Parameters: Nil
+
+	Return:	The number of allocations counted since the
+			previous call
+*/
+
+Uint32 			AllocTrackTickEnd()
+{
+	Uint32 count = alloc_tick_allocs;
+	alloc_tick_allocs = 0;
+	return count;
+}
+
+/*
+	Alloc Track Report
+
+	Purpose: Prints allocation counts for each phase,
+			and every call site that allocated.
+
+	Parameters: Nil
+
+	Return:	Nil
+*/
+
+void 			AllocTrackReport()
+{
+	AllocPhase phase = alloc_phase;
+	alloc_phase = ALLOC_PHASE_NONE;
+
+	printf( "--- Allocation Report ---\n" );
+
+	for( Uint16 i = ALLOC_PHASE_NONE+1; i < alloc_phase_count; i++ )
+	{
+		printf( "%-8s %8u allocs %8u frees\n",
+				alloc_phase_names[i], alloc_phase_allocs[i], alloc_phase_frees[i] );
+	}
+
+	for( Uint32 i = 0; i < alloc_site_count; i++ )
+	{
+		AllocSite* site = &(alloc_sites[i]);
+		const char* symbol = "?";
+		const char* object = "?";
+
+		#if defined(__GLIBC__)
+		Dl_info info;
+		if ( dladdr( site->address, &info ) != 0 )
+		{
+			if ( info.dli_sname != nullptr )
+				symbol = info.dli_sname;
+			if ( info.dli_fname != nullptr )
+				object = info.dli_fname;
+		}
+		#endif // __GLIBC__
+
+		printf( "  %-8s %8u  %p  %s (%s)\n",
+				alloc_phase_names[site->phase], site->count, site->address, symbol, object );
+	}
+
+	if ( alloc_site_dropped > 0 )
+		printf( "  (%u allocations from untracked sites, table full)\n", alloc_site_dropped );
+
+	alloc_phase = phase;
+}
+
+/*
+	Game Alloc Test
+
+	Purpose: Plays the game without a player for a
+			number of ticks, with the fire button held,
+			and checks that once warmed up, no tick
+			touches the heap. Each tick polls input,
+			updates and renders, as the game loop does,
+			with the first player's buttons scripted.
+			Runs in place of the game loop when started
+			with --alloc-test.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Warmup - ticks to run before checking
+				Ticks - ticks that must not allocate
+
+	Return:	True if no steady-state tick allocated
+*/
+
+bool 			GameAllocTest( Game* game, Uint32 warmup, Uint32 ticks )
+{
+	const Uint32 time_per_frame = 1000 / FPS;
+	Uint32 failed_ticks = 0;
+
+	printf( "--- Allocation Test: %u warmup, %u ticks ---\n", warmup, ticks );
+
+	GameStartPlay(game);
+
+	for( Uint32 tick = 0; tick < warmup + ticks; tick++ )
+	{
+		ArenaReset( &(game->frame_arena) );
+
+		// Input, then Scripted, strafing side to side while shooting
+		AllocTrackPhase( ALLOC_PHASE_INPUT );
+		GameInput(game);
+		game->inputs[0] = INPUT_SHOOT | ( (tick / FPS) % 2 == 0 ? INPUT_LEFT : INPUT_RIGHT );
+
+		// Update
+		AllocTrackPhase( ALLOC_PHASE_UPDATE );
+		GameTick( game, game->inputs, time_per_frame );
+
+		// Render
+		AllocTrackPhase( ALLOC_PHASE_RENDER );
+		GameRender( game );
+
+		AllocTrackPhase( ALLOC_PHASE_NONE );
+
+		// Check the tick
+		Uint32 count = AllocTrackTickEnd();
+		if ( tick >= warmup && count > 0 )
+		{
+			printf( "Tick %u: %u heap allocations\n", tick, count );
+			++failed_ticks;
+		}
+	}
+
+	AllocTrackReport();
+
+	if ( failed_ticks > 0 )
+	{
+		printf( "--- Allocation Test FAILED: %u of %u ticks allocated ---\n", failed_ticks, ticks );
+		return false;
+	}
+
+	printf( "--- Allocation Test Passed ---\n" );
+	return true;
+}
+
+#endif // ALLOC_TRACKING
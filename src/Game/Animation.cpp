@@ -6,82 +6,232 @@
 /** maintaining of an Animation.	**/
 /*************************************/
 
-#include <math.h>
+#include <stdio.h>
 
 #include "Game.h"
 
 /*
-	Sign
+	The built in animations, indexed by AnimationId.
+	Frames are 32x32, counted across the sprite sheet
+	from Column, on Row.
+*/
+
+struct AnimationBuiltin
+{
+	Uint16 					column;
+	Uint16 					row;
+	Uint16 					frame_count;
+	float 					speed;
+	bool 					loops;
+};
+
+static constexpr AnimationBuiltin animation_builtins[animation_builtin_count] =
+{
+	// Column	Row		Frames	Speed	Loops
+	{ 0,		1,		1,		0,		false },	// ANIMATION_PLAYER
+	{ 0,		7,		1,		0,		false },	// ANIMATION_SHOT_FRIENDLY
+	{ 1,		7,		1,		0,		false },	// ANIMATION_SHOT_ENEMY
+};
+
+/*
+	Animations Init
+
+	Purpose: Empties the animation table, and adds the
+			built in animations. Must be called before
+			anything starts an animation.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
 
-	Purpose: Returns whether a value is larger or
-			smaller than 0.
+	Return:	Nil
+*/
+
+void 			AnimationsInit( Game* game )
+{
+	game->animation_count = 0;
+	game->animation_frame_count = 0;
 
-	Parameters: Value - the value we are checking.
+	for( Uint16 i = 0; i < animation_builtin_count; i++ )
+	{
+		const AnimationBuiltin* b = &(animation_builtins[i]);
+		AnimationDefine( game, b->column, b->row, b->frame_count, b->speed, b->loops );
+	}
+}
 
-	Return:	0 - if the value is 0
-			1 - if the value is greater than 0
-		   -1 - if the value is less than 0
+/*
+	Animation Define
+
+	Purpose: Adds an animation to the table, working out
+			the clip rectangle of every frame up front.
+			If the same animation is already in the
+			table, that one is used instead.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Column - the sprite sheet column of the
+					first frame
+				Row - the sprite sheet row
+				Frame Count - the number of frames
+				Speed - frames to move on each tick
+				Loops - whether it starts again at the
+					end, or stays on the last frame
+
+	Return:	The animation's index, or ANIMATION_PLAYER if
+			the table is full
 */
 
-inline float sign( float value )
+Uint16 			AnimationDefine( Game* game, Uint16 column, Uint16 row, Uint16 frame_count, float speed, bool loops )
 {
-	return ( (0.0f < value) - (value < 0.0f) );
+	if ( frame_count == 0 )
+		frame_count = 1;
+
+	// Don't go faster than the number of frames we have
+	if ( speed > frame_count-1 )
+		speed = frame_count-1;
+	if ( speed < 0 )
+		speed = 0;
+
+	Uint32 fixed_speed = (Uint32)( speed * ANIMATION_ONE );
+
+	// Look for a match
+	for( Uint16 i = 0; i < game->animation_count; i++ )
+	{
+		const AnimationDef* def = &(game->animation_defs[i]);
+		const SDL_Rect* frame = &(game->animation_frames[def->first_frame]);
+
+		if ( def->frame_count == frame_count && def->speed == fixed_speed && def->loops == loops &&
+			 frame->x == column*32 && frame->y == row*32 )
+			return i;
+	}
+
+	if ( game->animation_count >= ANIMATION_MAX ||
+		 game->animation_frame_count + frame_count > ANIMATION_FRAME_MAX )
+	{
+		printf( "Error: Animation table is full!\n" );
+		return ANIMATION_PLAYER;
+	}
+
+	AnimationDef* def = &(game->animation_defs[game->animation_count]);
+	def->first_frame 	= game->animation_frame_count;
+	def->frame_count 	= frame_count;
+	def->speed 			= fixed_speed;
+	def->loops 			= loops;
+
+	for( Uint16 f = 0; f < frame_count; f++ )
+	{
+		SDL_Rect* frame = &(game->animation_frames[game->animation_frame_count++]);
+		frame->x = (column+f) * 32;
+		frame->y = row * 32;
+		frame->w = 32;
+		frame->h = 32;
+	}
+
+	return game->animation_count++;
 }
 
 /*
-	Animation Update
+	Animation Start
 
-	Purpose: Called to run the Animation and
-			reposition the Animation
-			rectangle based on the animation's
-			attributes.
+	Purpose: Sets an animation playing from its first
+			frame.
 
 	Parameters: Ani - a pointer to the animation
-			that we are updating.
+				Def - the animation to play
 
 	Return:	Nil
 */
 
-void 			AnimationUpdate( Animation* ani )
+void 			AnimationStart( Animation* ani, Uint16 def )
 {
-	// Make sure we have at least 1 image in the sprite
-	if (ani->image_count == 0)
-		return;
+	ani->def = def;
+	ani->position = 0;
+}
+
+/*
+	Animation Step Batch
 
-    // Update Current Frame
-    ani->image_index += ani->image_speed;
+	Purpose: Moves a run of animations on by one tick.
+			The animations can sit inside other objects,
+			Stride bytes apart. Looping and stopping are
+			worked out with masks rather than branches.
 
-    // Make sure we don't animate faster that the number
-    // of images we have
-    if ( fabsf(ani->image_speed) > ani->image_count )
-		ani->image_speed = (ani->image_count-1) * sign( ani->image_speed );
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				First - the first animation
+				Count - the number of animations
+				Stride - bytes from one animation to the
+					next
 
-    // Make Animation Frame Roll Over if Nessesary
-    if (ani->loops == true )
-	{
-		ani->image_index = fmodf(ani->image_index, (float)ani->image_count );
-		if ( ani->image_index < 0 )
-			ani->image_index = ani->image_count+ani->image_index;
-	}
-    else
-	// We Stop the Animation When It Ends
+	Return:	Nil
+*/
+
+void 			AnimationStepBatch( Game* game, Animation* first, Uint32 count, Uint32 stride )
+{
+	const AnimationDef* defs = game->animation_defs;
+	Uint8* bytes = (Uint8*)first;
+
+	for( Uint32 i = 0; i < count; i++, bytes += stride )
 	{
-		if (ani->image_index < 0)
-		{
-			ani->image_index = 0;
-			ani->image_speed = 0;
-		}
-
-		if (ani->image_index >= ani->image_count)
-		{
-			ani->image_speed = 0;
-			ani->image_index = ani->image_count-1;
-		}
+		Animation* ani = (Animation*)bytes;
+		const AnimationDef* def = &(defs[ani->def]);
+
+		Uint32 end = (Uint32)def->frame_count << 16;
+		Uint32 next = ani->position + def->speed;
+
+		// All ones if we ran off the end
+		Uint32 over = 0u - (Uint32)( next >= end );
+
+		// Looping goes back round, otherwise stay on the last frame
+		Uint32 wrapped = next - ( end & over );
+		Uint32 held = ( next & ~over ) | ( (end - ANIMATION_ONE) & over );
+
+		Uint32 loops = 0u - (Uint32)def->loops;
+		ani->position = ( wrapped & loops ) | ( held & ~loops );
 	}
+}
+
+/*
+	Animation Step All
+
+	Purpose: Moves every animation in the game on by one
+			tick. Called once per sim tick, so drawing
+			never changes an animation.
 
-	// Update the SDL Rect Position
-	int pos_x = ani->rect.w * (int)ani->image_index;
+	Parameters: Game - a pointer to the Game object
+					running the game.
 
-	ani->rect.x = pos_x;
-	ani->rect.y = ani->y_offset;
+	Return:	Nil
+*/
+
+void 			AnimationStepAll( Game* game )
+{
+	AnimationStepBatch( game, &(game->players[0].ship_ani), PLAYER_MAX, sizeof(Player) );
+
+	AnimationStepBatch( game, &(game->enemies_cold[0].ship_ani),
+						game->enemy_count, sizeof(EnemyCold) );
+
+	AnimationStepBatch( game, &(game->projectiles_friendly[0].ani),
+						game->proj_friendly_count, sizeof(Projectile) );
+
+	AnimationStepBatch( game, &(game->projectiles_enemy[0].ani),
+						game->proj_enemy_count, sizeof(Projectile) );
+}
+
+/*
+	Animation Rect
+
+	Purpose: Finds the sprite sheet clip for the frame
+			an animation is on.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Ani - a pointer to the animation
+
+	Return:	The clip rectangle
+*/
+
+SDL_Rect* 		AnimationRect( Game* game, const Animation* ani )
+{
+	const AnimationDef* def = &(game->animation_defs[ani->def]);
+	return &(game->animation_frames[def->first_frame + (ani->position >> 16)]);
 }
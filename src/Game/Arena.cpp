@@ -0,0 +1,207 @@
+/*************************************/
+/** Arena <source file>				**/
+/**									**/
+/** A linear (bump) allocator, used	**/
+/** for short lived data that only	**/
+/** needs to last a single frame.	**/
+/*************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#include "Game.h"
+
+/*
+	Arena Init
+
+	Purpose: Allocates the memory block used by the
+			arena. This is the only heap allocation the
+			arena ever makes.
+
+	Parameters: Arena - a pointer to the arena
+				Capacity - the size of the arena, in
+					bytes
+
+	Return:	True if the memory was allocated
+*/
+
+bool 			ArenaInit( FrameArena* arena, Uint32 capacity )
+{
+	arena->memory = (Uint8*)malloc( capacity );
+	if ( arena->memory == nullptr )
+	{
+		printf( "Error: Unable to allocate %u byte arena\n", capacity );
+		return false;
+	}
+
+	arena->capacity 	= capacity;
+	arena->used 		= 0;
+	arena->high_water 	= 0;
+	arena->failed 		= 0;
+
+	return true;
+}
+
+/*
+	Arena Free
+
+	Purpose: Releases the arena's memory block.
+
+	Parameters: Arena - a pointer to the arena
+
+	Return:	Nil
+*/
+
+void 			ArenaFree( FrameArena* arena )
+{
+	free( arena->memory );
+
+	arena->memory 		= nullptr;
+	arena->capacity 	= 0;
+	arena->used 		= 0;
+}
+
+/*
+	Arena Reset
+
+	Purpose: Releases everything allocated from the
+			arena at once. Called at the start of each
+			frame, so nothing allocated from it may be
+			kept past the end of the frame.
+
+	Parameters: Arena - a pointer to the arena
+
+	Return:	Nil
+*/
+
+void 			ArenaReset( FrameArena* arena )
+{
+	arena->used = 0;
+}
+
+/*
+	Arena Mark
+
+	Purpose: Remembers how much of the arena is in use,
+			so scratch memory used within a frame can be
+			handed back early with Arena Rewind.
+
+	Parameters: Arena - a pointer to the arena
+
+	Return:	The mark to rewind to
+*/
+
+Uint32 			ArenaMark( FrameArena* arena )
+{
+	return arena->used;
+}
+
+/*
+	Arena Rewind
+
+	Purpose: Releases everything allocated since a mark
+			was taken.
+
+	Parameters: Arena - a pointer to the arena
+				Mark - a mark from Arena Mark
+
+	Return:	Nil
+*/
+
+void 			ArenaRewind( FrameArena* arena, Uint32 mark )
+{
+	arena->used = mark;
+}
+
+/*
+	Arena Alloc
+
+	Purpose: Allocates memory from the arena.
+
+	Parameters: Arena - a pointer to the arena
+				Size - the number of bytes wanted
+				Align - the alignment wanted, must be
+					a power of two
+
+	Return:	A pointer to the memory, or nullptr if the
+			arena is out of space this frame
+*/
+
+void* 			ArenaAlloc( FrameArena* arena, Uint32 size, Uint32 align )
+{
+	// Round the offset up to the alignment
+	uintptr_t base 		= (uintptr_t)arena->memory;
+	uintptr_t start 	= (base + arena->used + (align-1)) & ~(uintptr_t)(align-1);
+	Uint32 offset 		= (Uint32)(start - base);
+
+	// Check we have room
+	if ( offset + size > arena->capacity )
+	{
+		++arena->failed;
+		return nullptr;
+	}
+
+	arena->used = offset + size;
+
+	// Keep track of the most we have ever used
+	if ( arena->used > arena->high_water )
+		arena->high_water = arena->used;
+
+	return arena->memory + offset;
+}
+
+/*
+	Arena Printf
+
+	Purpose: Formats a string into arena memory.
+
+	Parameters: Arena - a pointer to the arena
+				Format - printf style format string
+				... - the values to format
+
+	Return:	The formatted string, or an empty string if
+			the arena is out of space
+*/
+
+const char* 	ArenaPrintf( FrameArena* arena, const char* format, ... )
+{
+	va_list args;
+
+	// Find the length we need
+	va_start( args, format );
+	int length = vsnprintf( nullptr, 0, format, args );
+	va_end( args );
+
+	if ( length < 0 )
+		return "";
+
+	char* text = (char*)ArenaAlloc( arena, length+1, 1 );
+	if ( text == nullptr )
+		return "";
+
+	// Format into the arena
+	va_start( args, format );
+	vsnprintf( text, length+1, format, args );
+	va_end( args );
+
+	return text;
+}
+
+/*
+	Arena Print Stats
+
+	Purpose: Prints how much of the arena has been
+			used, so the size can be tuned.
+
+	Parameters: Arena - a pointer to the arena
+				Name - the name to print the stats under
+
+	Return:	Nil
+*/
+
+void 			ArenaPrintStats( FrameArena* arena, const char* name )
+{
+	printf( "%s: %u / %u bytes high water, %u failed allocations\n",
+			name, arena->high_water, arena->capacity, arena->failed );
+}
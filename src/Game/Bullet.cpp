@@ -0,0 +1,372 @@
+/*************************************/
+/** Bullet <source file>			**/
+/**									**/
+/** Bullet patterns, and the paths	**/
+/** enemy projectiles follow. Each	**/
+/** position is worked out from the	**/
+/** time since it was fired.		**/
+/*************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "Game.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
+#define BULLET_PI 3.14159265f
+
+/*
+	How each BulletPattern fires, indexed by BulletPattern.
+	Single is the original enemy shot.
+*/
+
+static constexpr BulletPatternDef bullet_patterns[bullet_pattern_count] =
+{
+	// Count	Spread			Speed	Accel	Spin	Aimed	Damage
+	{ 1,		0,				15,		0,		0,		false,	5 },
+	{ 16,		2*BULLET_PI,	2,		0.05f,	0,		false,	5 },
+	{ 4,		2*BULLET_PI,	4,		0,		0.2f,	false,	5 },
+	{ 5,		0.8f,			6,		0,		0,		true,	5 },
+};
+
+// Pattern names used in the archetype file, indexed by BulletPattern
+static const char* 	bullet_pattern_names[bullet_pattern_count] =
+{
+	"single",
+	"radial",
+	"spiral",
+	"fan",
+};
+
+/*
+	Bullet Exit Distance
+
+	Purpose: Finds how far along a straight line a
+			bullet goes before it is off the screen, with
+			the same 16 pixel margin other projectiles
+			use.
+
+	Parameters: Origin - where the bullet starts
+				Dir - the bullet's direction, of length 1
+
+	Return:	The distance, or a negative value if it
+			never leaves
+*/
+
+static float 	BulletExitDistance( const Vector2D& origin, const Vector2D& dir )
+{
+	const float eps = 1e-6f;
+	float dist = -1;
+
+	if ( dir.x > eps )
+		dist = ( SCREEN_WIDTH+16 - origin.x ) / dir.x;
+	else if ( dir.x < -eps )
+		dist = ( -16 - origin.x ) / dir.x;
+
+	float dist_y = -1;
+	if ( dir.y > eps )
+		dist_y = ( SCREEN_HEIGHT+16 - origin.y ) / dir.y;
+	else if ( dir.y < -eps )
+		dist_y = ( -16 - origin.y ) / dir.y;
+
+	if ( dist < 0 || ( dist_y >= 0 && dist_y < dist ) )
+		dist = dist_y;
+
+	return dist;
+}
+
+/*
+	Bullet Path Start
+
+	Purpose: Sets the path of the enemy projectile at an
+			index, starting on this tick. The tick it
+			goes off screen is worked out now, so it
+			never has to be checked against the screen.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Index - the projectile's index in
+					projectiles_enemy
+				Origin - where it is fired from
+				Vel - its starting velocity, per tick
+				Accel - how much faster it gets each
+					tick, can't be negative
+
+	Return:	Nil
+*/
+
+void 			BulletPathStart( Game* game, Uint16 index, const Vector2D& origin, const Vector2D& vel, float accel )
+{
+	BulletPaths* paths = &(game->bullet_paths);
+
+	float speed = vel.length();
+	Vector2D dir = ( speed > 0 ? vel / speed : Vector2D( 0, 1 ) );
+
+	if ( accel < 0 )
+		accel = 0;
+
+	// Solve speed*t + accel*t*t/2 = distance for t
+	float dist = BulletExitDistance( origin, dir );
+	float life = BULLET_LIFE_MAX;
+
+	if ( dist >= 0 )
+	{
+		if ( accel > 0 )
+			life = ( sqrtf( speed*speed + 2*accel*dist ) - speed ) / accel;
+		else if ( speed > 0 )
+			life = dist / speed;
+	}
+
+	if ( life > BULLET_LIFE_MAX )
+		life = BULLET_LIFE_MAX;
+
+	paths->origin_x[index] 		= origin.x;
+	paths->origin_y[index] 		= origin.y;
+	paths->dir_x[index] 		= dir.x;
+	paths->dir_y[index] 		= dir.y;
+	paths->speed[index] 		= speed;
+	paths->accel[index] 		= accel;
+	paths->spawn_tick[index] 	= game->timers.tick;
+
+	// From this tick on, the bullet is off screen
+	paths->exit_tick[index] 	= game->timers.tick + (Uint32)floorf( life );
+}
+
+/*
+	Bullet Path Copy
+
+	Purpose: Copies one path over another, for when an
+			enemy projectile is moved in its pool.
+
+	Parameters: Paths - the bullet paths
+				Dst - the index to copy to
+				Src - the index to copy from
+
+	Return:	Nil
+*/
+
+void 			BulletPathCopy( BulletPaths* paths, Uint16 dst, Uint16 src )
+{
+	paths->origin_x[dst] 	= paths->origin_x[src];
+	paths->origin_y[dst] 	= paths->origin_y[src];
+	paths->dir_x[dst] 		= paths->dir_x[src];
+	paths->dir_y[dst] 		= paths->dir_y[src];
+	paths->speed[dst] 		= paths->speed[src];
+	paths->accel[dst] 		= paths->accel[src];
+	paths->spawn_tick[dst] 	= paths->spawn_tick[src];
+	paths->exit_tick[dst] 	= paths->exit_tick[src];
+}
+
+/*
+	Bullet Place
+
+	Purpose: Moves an enemy projectile, and its collision
+			box, to where its path puts it.
+
+	Parameters: Proj - the projectile
+				X - the new x position
+				Y - the new y position
+				Vel X - how far it moved this tick in x
+				Vel Y - how far it moved this tick in y
+
+	Return:	Nil
+*/
+
+static inline void 	BulletPlace( Projectile* proj, float x, float y, float vel_x, float vel_y )
+{
+	proj->pos.x = x;
+	proj->pos.y = y;
+	proj->vel.x = vel_x;
+	proj->vel.y = vel_y;
+
+	proj->collision.x = (Sint32)x-16 + proj->col_offset.x;
+	proj->collision.y = (Sint32)y-16 + proj->col_offset.y;
+}
+
+/*
+	Bullet Paths Update
+
+	Purpose: Removes the enemy projectiles that have
+			reached their exit tick, then places every
+			other one on its path for this tick. Used in
+			place of Projectile Update for enemy
+			projectiles.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			BulletPathsUpdate( Game* game )
+{
+	BulletPaths* paths = &(game->bullet_paths);
+	Uint32 tick = game->timers.tick;
+
+	// Remove the ones that have left the screen
+	for( Uint16 i = 0; i < game->proj_enemy_count; i++ )
+	{
+		if ( (Sint32)( tick - paths->exit_tick[i] ) >= 0 )
+		{
+			GameKillProjectile( game, &(game->projectiles_enemy[i]) );
+			--i;
+		}
+	}
+
+	BulletPathsPlace( game );
+}
+
+/*
+	Bullet Paths Place
+
+	Purpose: Works out the position, velocity and
+			collision box of every enemy projectile from
+			its path, for the current tick. Done four at
+			a time where SSE2 is available.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			BulletPathsPlace( Game* game )
+{
+	BulletPaths* paths = &(game->bullet_paths);
+	Uint32 tick = game->timers.tick;
+
+	// Bullets move once on the tick they are fired
+	Uint32 count = game->proj_enemy_count;
+	Uint32 i = 0;
+
+	#ifdef __SSE2__
+	const __m128i next = _mm_set1_epi32( (int)tick + 1 );
+	const __m128 half = _mm_set1_ps( 0.5f );
+
+	for( ; i + 4 <= count; i += 4 )
+	{
+		__m128 t = _mm_cvtepi32_ps( _mm_sub_epi32( next, _mm_load_si128( (const __m128i*)(paths->spawn_tick + i) ) ) );
+		__m128 speed = _mm_load_ps( paths->speed + i );
+		__m128 accel = _mm_load_ps( paths->accel + i );
+		__m128 dir_x = _mm_load_ps( paths->dir_x + i );
+		__m128 dir_y = _mm_load_ps( paths->dir_y + i );
+
+		// Distance along the path, and how far it moved since last tick
+		__m128 dist = _mm_mul_ps( t, _mm_add_ps( speed, _mm_mul_ps( half, _mm_mul_ps( accel, t ) ) ) );
+		__m128 step = _mm_add_ps( speed, _mm_mul_ps( accel, _mm_sub_ps( t, half ) ) );
+
+		float x[4], y[4], vel_x[4], vel_y[4];
+		_mm_storeu_ps( x, _mm_add_ps( _mm_load_ps( paths->origin_x + i ), _mm_mul_ps( dir_x, dist ) ) );
+		_mm_storeu_ps( y, _mm_add_ps( _mm_load_ps( paths->origin_y + i ), _mm_mul_ps( dir_y, dist ) ) );
+		_mm_storeu_ps( vel_x, _mm_mul_ps( dir_x, step ) );
+		_mm_storeu_ps( vel_y, _mm_mul_ps( dir_y, step ) );
+
+		for( Uint32 n = 0; n < 4; n++ )
+			BulletPlace( &(game->projectiles_enemy[i+n]), x[n], y[n], vel_x[n], vel_y[n] );
+	}
+	#endif // __SSE2__
+
+	for( ; i < count; i++ )
+	{
+		float t = (float)(Sint32)( tick + 1 - paths->spawn_tick[i] );
+		float dist = t * ( paths->speed[i] + 0.5f * paths->accel[i] * t );
+		float step = paths->speed[i] + paths->accel[i] * ( t - 0.5f );
+
+		BulletPlace( &(game->projectiles_enemy[i]),
+					 paths->origin_x[i] + paths->dir_x[i] * dist,
+					 paths->origin_y[i] + paths->dir_y[i] * dist,
+					 paths->dir_x[i] * step, paths->dir_y[i] * step );
+	}
+}
+
+/*
+	Bullet Pattern Fire
+
+	Purpose: Fires one volley of a bullet pattern into
+			the enemy projectile pool.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Origin - where the volley is fired from
+				Pattern - the pattern to fire
+
+	Return:	The number of bullets fired, fewer than the
+			pattern's count if the pool is full
+*/
+
+Uint16 			BulletPatternFire( Game* game, const Vector2D& origin, BulletPattern pattern )
+{
+	if ( pattern >= bullet_pattern_count )
+		return 0;
+
+	const BulletPatternDef* def = &(bullet_patterns[pattern]);
+
+	// Centre of the volley, as an angle from straight down
+	float centre = 0;
+	if ( def->aimed )
+	{
+		const Player* target = PlayerNearest( game, origin );
+		centre = atan2f( target->pos.x - origin.x, target->pos.y - origin.y );
+	}
+
+	centre += def->spin * game->timers.tick;
+
+	// A full ring spaces bullets evenly, anything less spans the spread
+	float first = centre;
+	float step = 0;
+
+	if ( def->spread >= 2*BULLET_PI - 1e-3f )
+		step = def->spread / def->count;
+	else if ( def->count > 1 )
+	{
+		first = centre - def->spread / 2;
+		step = def->spread / (def->count - 1);
+	}
+
+	Uint16 fired = 0;
+	for( Uint16 n = 0; n < def->count; n++ )
+	{
+		float angle = first + step * n;
+		Vector2D vel( sinf( angle ) * def->speed, cosf( angle ) * def->speed );
+
+		Projectile* proj = GameSpawnProjectile( game, false, origin, vel );
+		if ( proj == nullptr )
+			break;
+
+		BulletPathStart( game, (Uint16)(proj - game->projectiles_enemy), origin, vel, def->accel );
+		AnimationStart( &(proj->ani), ANIMATION_SHOT_ENEMY );
+		proj->damage = def->damage;
+
+		++fired;
+	}
+
+	return fired;
+}
+
+/*
+	Bullet Pattern Find
+
+	Purpose: Finds a bullet pattern by the name used in
+			the archetype file.
+
+	Parameters: Name - the name of the pattern
+
+	Return:	The pattern, or bullet_pattern_count if there
+			is no pattern by that name
+*/
+
+BulletPattern 	BulletPatternFind( const char* name )
+{
+	Uint16 p = 0;
+	for( ; p < bullet_pattern_count; p++ )
+	{
+		if ( strcmp( name, bullet_pattern_names[p] ) == 0 )
+			break;
+	}
+
+	return (BulletPattern)p;
+}
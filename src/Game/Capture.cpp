@@ -0,0 +1,460 @@
+/*************************************/
+/** Capture <source file>			**/
+/**									**/
+/** Records a frame for each time	**/
+/** step the game runs, and			**/
+/** streams them as raw video at	**/
+/** FPS to a file or a pipe, from	**/
+/** a thread of its own.			**/
+/*************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Game.h"
+
+#ifdef __linux__
+#include <signal.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif // __linux__
+
+/*
+	Capture Open Output
+
+	Purpose: Opens where the video goes. "-" is stdout,
+			which then holds only video: everything the
+			game prints goes to stderr from then on. Only
+			on Linux and Windows, where stdout can be
+			swapped, and made binary.
+
+	Parameters: Capture - the capture
+				Path - the file, or "-"
+
+	Return:	True if it was opened
+*/
+
+static bool 	CaptureOpenOutput( FrameCapture* capture, const char* path )
+{
+	if ( strcmp( path, "-" ) != 0 )
+	{
+		capture->file = fopen( path, "wb" );
+		capture->close_file = true;
+		return capture->file != nullptr;
+	}
+
+	capture->close_file = false;
+
+	#ifdef __linux__
+	// Keep the real stdout for video, and point printf at stderr
+	fflush( stdout );
+	int video = dup( STDOUT_FILENO );
+	if ( video < 0 || dup2( STDERR_FILENO, STDOUT_FILENO ) < 0 )
+		return false;
+
+	capture->file = fdopen( video, "wb" );
+	capture->close_file = true;
+
+	// A reader that goes away should fail the write, not end the game
+	signal( SIGPIPE, SIG_IGN );
+	#elif defined(_WIN32)
+	// Keep the real stdout for video, in binary so bytes that look like
+	// newlines aren't written as CRLF, and point printf at stderr
+	fflush( stdout );
+	int video = _dup( _fileno( stdout ) );
+	if ( video < 0 || _dup2( _fileno( stderr ), _fileno( stdout ) ) < 0 )
+		return false;
+
+	_setmode( video, _O_BINARY );
+	capture->file = _fdopen( video, "wb" );
+	capture->close_file = true;
+	#else
+	printf( "Error: Capturing to stdout isn't supported on this platform\n" );
+	return false;
+	#endif // __linux__
+
+	return capture->file != nullptr;
+}
+
+/*
+	Capture Write Frame
+
+	Purpose: Writes one frame, once for each time step
+			it stands for. Raw frames are written straight
+			from the buffer they were captured into. Y4M
+			frames are converted to BT.601 YUV planes
+			first.
+
+	Parameters: Capture - the capture
+				Frame - RGB24 pixels
+				Repeats - times to write it
+
+	Return:	True if it was written
+*/
+
+static bool 	CaptureWriteFrame( FrameCapture* capture, const Uint8* frame, Uint32 repeats )
+{
+	if ( capture->format == CAPTURE_RAW_RGB )
+	{
+		for( Uint32 r = 0; r < repeats; r++ )
+			if ( fwrite( frame, capture->frame_size, 1, capture->file ) != 1 )
+				return false;
+
+		return true;
+	}
+
+	Uint32 count = capture->width * capture->height;
+	Uint8* y = capture->planes;
+	Uint8* u = y + count;
+	Uint8* v = u + count;
+
+	for( Uint32 i = 0; i < count; i++, frame += 3 )
+	{
+		int r = frame[0], g = frame[1], b = frame[2];
+
+		y[i] = (Uint8)( 16 + ( ( 66*r + 129*g + 25*b + 128 ) >> 8 ) );
+		u[i] = (Uint8)( 128 + ( ( -38*r - 74*g + 112*b + 128 ) >> 8 ) );
+		v[i] = (Uint8)( 128 + ( ( 112*r - 94*g - 18*b + 128 ) >> 8 ) );
+	}
+
+	for( Uint32 r = 0; r < repeats; r++ )
+		if ( fputs( "FRAME\n", capture->file ) < 0 || fwrite( capture->planes, count * 3, 1, capture->file ) != 1 )
+			return false;
+
+	return true;
+}
+
+/*
+	Capture Writer Run
+
+	Purpose: <Thread Function>
+			 Writes frames as they are handed over, in
+			 order, and gives each buffer back. After a
+			 failed write, frames are still taken, but
+			 thrown away, so the game is never held up.
+			 Stops once woken with nothing left to write.
+
+	Parameters: Data - the FrameCapture
+
+	Return:	0
+*/
+
+static int 		CaptureWriterRun( void* data )
+{
+	FrameCapture* capture = (FrameCapture*)data;
+	Uint32 tail = 0;
+
+	for( ;; )
+	{
+		SDL_SemWait( capture->full_slots );
+
+		if ( (Uint32)SDL_AtomicGet( &(capture->published) ) == tail )
+			break;
+
+		const Uint8* frame = capture->frames[tail % CAPTURE_BUFFERS];
+		Uint32 repeats = capture->repeats[tail % CAPTURE_BUFFERS];
+
+		if ( !SDL_AtomicGet( &(capture->failed) ) )
+		{
+			if ( CaptureWriteFrame( capture, frame, repeats ) )
+				SDL_AtomicAdd( &(capture->written), (int)repeats );
+			else
+				SDL_AtomicSet( &(capture->failed), 1 );
+		}
+
+		++tail;
+		SDL_SemPost( capture->free_slots );
+	}
+
+	fflush( capture->file );
+	return 0;
+}
+
+/*
+	Capture Start
+
+	Purpose: Starts capturing a frame each time step, to
+			a file or stdout. All buffers are allocated
+			here, and the writer thread started.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Path - the file to write, or "-" for
+					stdout
+				Format - how to write the frames
+				Source - where frames come from. The
+					renderer needs Game Init to have made
+					one. The software renderer works
+					without, but leaves out HUD text.
+
+	Return:	True if capturing started
+*/
+
+bool 			CaptureStart( Game* game, const char* path, CaptureFormat format, CaptureSource source )
+{
+	FrameCapture* capture = &(game->capture);
+
+	if ( capture->active )
+		CaptureStop( game );
+
+	capture->format = format;
+	capture->source = source;
+
+	// Frame size
+	if ( source == CAPTURE_SOURCE_SOFT )
+	{
+		capture->soft = new SoftRenderer;
+		if ( !SoftRenderInit( game, capture->soft, SCREEN_WIDTH, SCREEN_HEIGHT, SOFT_RENDER_RGB ) )
+		{
+			CaptureStop( game );
+			return false;
+		}
+
+		capture->width = SCREEN_WIDTH;
+		capture->height = SCREEN_HEIGHT;
+	}
+	else
+	{
+		int width = 0, height = 0;
+		if ( game->render == nullptr || SDL_GetRendererOutputSize( game->render, &width, &height ) != 0 )
+		{
+			printf( "Error: Unable to capture, there is no renderer to read back. SDL Error: %s\n", SDL_GetError() );
+			return false;
+		}
+
+		capture->width = (Uint16)width;
+		capture->height = (Uint16)height;
+	}
+
+	// Every buffer, then the Y4M planes
+	capture->frame_size = capture->width * capture->height * 3;
+	Uint32 size = capture->frame_size * ( CAPTURE_BUFFERS + ( format == CAPTURE_Y4M ? 1 : 0 ) );
+
+	capture->memory = (Uint8*)malloc( size );
+	if ( capture->memory == nullptr )
+	{
+		printf( "Error: Unable to allocate %u bytes for capture buffers\n", size );
+		CaptureStop( game );
+		return false;
+	}
+
+	for( Uint32 i = 0; i < CAPTURE_BUFFERS; i++ )
+		capture->frames[i] = capture->memory + i * capture->frame_size;
+
+	capture->planes = ( format == CAPTURE_Y4M ? capture->memory + CAPTURE_BUFFERS * capture->frame_size : nullptr );
+
+	if ( !CaptureOpenOutput( capture, path ) )
+	{
+		printf( "Error: Unable to open %s to capture to\n", path );
+		CaptureStop( game );
+		return false;
+	}
+
+	// Each frame written stands for one time step
+	if ( format == CAPTURE_Y4M )
+		fprintf( capture->file, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", capture->width, capture->height, FPS );
+
+	capture->head 		= 0;
+	capture->ticks 		= 0;
+	capture->captured 	= 0;
+	capture->dropped 	= 0;
+	capture->grab_time 	= 0;
+	SDL_AtomicSet( &(capture->published), 0 );
+	SDL_AtomicSet( &(capture->failed), 0 );
+	SDL_AtomicSet( &(capture->written), 0 );
+
+	capture->free_slots = SDL_CreateSemaphore( CAPTURE_BUFFERS );
+	capture->full_slots = SDL_CreateSemaphore( 0 );
+
+	if ( capture->free_slots == nullptr || capture->full_slots == nullptr )
+	{
+		printf( "Error: Unable to create the capture semaphores. SDL Error: %s\n", SDL_GetError() );
+		CaptureStop( game );
+		return false;
+	}
+
+	capture->thread = SDL_CreateThread( CaptureWriterRun, "Capture", capture );
+	if ( capture->thread == nullptr )
+	{
+		printf( "Error: Unable to start the capture thread. SDL Error: %s\n", SDL_GetError() );
+		CaptureStop( game );
+		return false;
+	}
+
+	capture->active = true;
+
+	printf( "Capturing %ux%u %s to %s\n", capture->width, capture->height,
+			format == CAPTURE_Y4M ? "Y4M" : "raw RGB24", strcmp( path, "-" ) == 0 ? "stdout" : path );
+
+	return true;
+}
+
+/*
+	Capture Tick
+
+	Purpose: Notes that a time step has passed, so the
+			next frame captured stands for it. The video
+			is played back at FPS, whatever rate frames
+			are drawn at.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			CaptureTick( Game* game )
+{
+	FrameCapture* capture = &(game->capture);
+	if ( !capture->active )
+		return;
+
+	++capture->ticks;
+	++capture->captured;
+}
+
+/*
+	Capture Frame
+
+	Purpose: Captures the frame just drawn, straight into
+			the next free buffer, and hands it to the
+			writer, to be written once for each time step
+			since the last one. Frames drawn with no step
+			since are skipped. Call before the frame is
+			presented. Never waits on the writer: if every
+			buffer is still waiting to be written, the
+			frame is dropped and counted, and the next
+			one grabbed covers its time steps too.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			CaptureFrame( Game* game )
+{
+	FrameCapture* capture = &(game->capture);
+	if ( !capture->active )
+		return;
+
+	if ( SDL_AtomicGet( &(capture->failed) ) )
+	{
+		printf( "Error: Capture output can't be written to any more, stopping\n" );
+		CaptureStop( game );
+		return;
+	}
+
+	if ( capture->ticks == 0 )
+		return;
+
+	if ( SDL_SemTryWait( capture->free_slots ) != 0 )
+	{
+		++capture->dropped;
+		return;
+	}
+
+	Uint8* frame = capture->frames[capture->head % CAPTURE_BUFFERS];
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	bool grabbed;
+	if ( capture->source == CAPTURE_SOURCE_SOFT )
+		grabbed = SoftRenderGame( game, capture->soft, frame, 0 );
+	else
+		grabbed = SDL_RenderReadPixels( game->render, nullptr, SDL_PIXELFORMAT_RGB24, frame, capture->width * 3 ) == 0;
+
+	capture->grab_time += SDL_GetPerformanceCounter() - start;
+
+	if ( !grabbed )
+	{
+		SDL_SemPost( capture->free_slots );
+		++capture->dropped;
+		return;
+	}
+
+	// The semaphore orders the frame's pixels before the writer reads them
+	capture->repeats[capture->head % CAPTURE_BUFFERS] = capture->ticks;
+	capture->ticks = 0;
+	++capture->head;
+	SDL_AtomicSet( &(capture->published), (int)capture->head );
+	SDL_SemPost( capture->full_slots );
+}
+
+/*
+	Capture Stop
+
+	Purpose: Lets the writer finish the frames it has,
+			then stops it, frees the buffers and prints
+			how many frames were written and dropped.
+			Time steps since the last frame grabbed are
+			filled with that frame, so the video lasts
+			as long as the game did.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			CaptureStop( Game* game )
+{
+	FrameCapture* capture = &(game->capture);
+
+	// Wake the writer with nothing new, once it has caught up
+	if ( capture->thread != nullptr )
+	{
+		SDL_SemPost( capture->full_slots );
+		SDL_WaitThread( capture->thread, nullptr );
+		capture->thread = nullptr;
+
+		// The writer is done with the last frame, so it's still whole
+		if ( capture->head > 0 && capture->ticks > 0 && !SDL_AtomicGet( &(capture->failed) ) )
+		{
+			if ( CaptureWriteFrame( capture, capture->frames[(capture->head - 1) % CAPTURE_BUFFERS], capture->ticks ) )
+				SDL_AtomicAdd( &(capture->written), (int)capture->ticks );
+		}
+	}
+
+	if ( capture->active )
+	{
+		Uint32 written = (Uint32)SDL_AtomicGet( &(capture->written) );
+		Uint32 grabbed = capture->head;
+
+		printf( "Capture: %u time steps, %u frames written, %u grabs dropped, %.2f ms a grab\n",
+				capture->captured, written, capture->dropped,
+				grabbed > 0 ? capture->grab_time * 1000.0 / SDL_GetPerformanceFrequency() / grabbed : 0.0 );
+	}
+
+	if ( capture->file != nullptr && capture->close_file )
+		fclose( capture->file );
+	else if ( capture->file != nullptr )
+		fflush( capture->file );
+
+	if ( capture->free_slots != nullptr )
+		SDL_DestroySemaphore( capture->free_slots );
+	if ( capture->full_slots != nullptr )
+		SDL_DestroySemaphore( capture->full_slots );
+
+	if ( capture->soft != nullptr )
+	{
+		SoftRenderFree( capture->soft );
+		delete capture->soft;
+	}
+
+	free( capture->memory );
+
+	capture->file 		= nullptr;
+	capture->close_file = false;
+	capture->memory 	= nullptr;
+	capture->planes 	= nullptr;
+	capture->soft 		= nullptr;
+	capture->free_slots = nullptr;
+	capture->full_slots = nullptr;
+	capture->active 	= false;
+
+	for( Uint32 i = 0; i < CAPTURE_BUFFERS; i++ )
+		capture->frames[i] = nullptr;
+}
@@ -0,0 +1,332 @@
+/*************************************/
+/** Checksum <source file>			**/
+/**									**/
+/** Hashes the sim state, so two	**/
+/** runs can be checked for the		**/
+/** same outcome. Only computed		**/
+/** where it is compared: replays,	**/
+/** rollback and the benchmarks.	**/
+/*************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Game.h"
+
+/*
+	The hash works like xxHash32: values go round four
+	lanes in turn, so the multiplies of one value don't
+	wait on the last, and the lanes are mixed at the end.
+	Values are hashed field by field, never as raw structs,
+	so padding and pointers never change the result.
+*/
+
+#define CHECKSUM_PRIME_1 0x9E3779B1u
+#define CHECKSUM_PRIME_2 0x85EBCA77u
+#define CHECKSUM_PRIME_3 0xC2B2AE3Du
+#define CHECKSUM_PRIME_5 0x165667B1u
+
+struct ChecksumState
+{
+	Uint32					lanes[4];
+	Uint32					length;
+};
+
+// Names of each ChecksumField, for reporting a desync
+static const char* 	checksum_field_names[checksum_field_count] =
+{
+	"players",
+	"enemies",
+	"friendly projectiles",
+	"enemy projectiles",
+	"score",
+	"random state",
+};
+
+/*
+	Checksum Rotate
+
+	Purpose: Rotates the bits of a value left.
+
+	Parameters: Value - the value
+				Bits - how far to rotate
+
+	Return:	The rotated value
+*/
+
+static inline Uint32 	ChecksumRotate( Uint32 value, Uint32 bits )
+{
+	return ( value << bits ) | ( value >> (32 - bits) );
+}
+
+/*
+	Checksum Round
+
+	Purpose: Mixes one value into a lane.
+
+	Parameters: Lane - the lane's value so far
+				Value - the value to mix in
+
+	Return:	The lane's new value
+*/
+
+static inline Uint32 	ChecksumRound( Uint32 lane, Uint32 value )
+{
+	lane += value * CHECKSUM_PRIME_2;
+	lane = ChecksumRotate( lane, 13 );
+	return lane * CHECKSUM_PRIME_1;
+}
+
+/*
+	Checksum Begin
+
+	Purpose: Starts a new hash.
+
+	Parameters: State - the hash state
+
+	Return:	Nil
+*/
+
+static inline void 	ChecksumBegin( ChecksumState* state )
+{
+	state->lanes[0] = CHECKSUM_PRIME_1 + CHECKSUM_PRIME_2;
+	state->lanes[1] = CHECKSUM_PRIME_2;
+	state->lanes[2] = 0;
+	state->lanes[3] = 0u - CHECKSUM_PRIME_1;
+	state->length 	= 0;
+}
+
+/*
+	Checksum Add
+
+	Purpose: Mixes four values into the hash, one into
+			each lane.
+
+	Parameters: State - the hash state
+				A, B, C, D - the values
+
+	Return:	Nil
+*/
+
+static inline void 	ChecksumAdd( ChecksumState* state, Uint32 a, Uint32 b, Uint32 c, Uint32 d )
+{
+	state->lanes[0] = ChecksumRound( state->lanes[0], a );
+	state->lanes[1] = ChecksumRound( state->lanes[1], b );
+	state->lanes[2] = ChecksumRound( state->lanes[2], c );
+	state->lanes[3] = ChecksumRound( state->lanes[3], d );
+	state->length 	+= 16;
+}
+
+/*
+	Checksum End
+
+	Purpose: Mixes the lanes together into the final
+			hash.
+
+	Parameters: State - the hash state
+
+	Return:	The hash
+*/
+
+static inline Uint32 	ChecksumEnd( ChecksumState* state )
+{
+	Uint32 hash = ChecksumRotate( state->lanes[0], 1 ) + ChecksumRotate( state->lanes[1], 7 ) +
+				  ChecksumRotate( state->lanes[2], 12 ) + ChecksumRotate( state->lanes[3], 18 );
+
+	hash += state->length * CHECKSUM_PRIME_5;
+
+	hash ^= hash >> 15;
+	hash *= CHECKSUM_PRIME_2;
+	hash ^= hash >> 13;
+	hash *= CHECKSUM_PRIME_3;
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+/*
+	Checksum Float
+
+	Purpose: Gets the bits of a float, to hash.
+
+	Parameters: Value - the float
+
+	Return:	Its bits
+*/
+
+static inline Uint32 	ChecksumFloat( float value )
+{
+	Uint32 bits;
+	memcpy( &bits, &value, sizeof(bits) );
+	return bits;
+}
+
+/*
+	Checksum Projectiles
+
+	Purpose: Hashes the friendly projectile pool, up to
+			its live count.
+
+	Parameters: Projs - the projectile pool
+				Count - the number of live projectiles
+
+	Return:	The hash
+*/
+
+static Uint32 	ChecksumProjectiles( const Projectile* projs, Uint16 count )
+{
+	ChecksumState state;
+	ChecksumBegin( &state );
+
+	ChecksumAdd( &state, count, 0, 0, 0 );
+
+	for( Uint16 i = 0; i < count; i++ )
+	{
+		const Projectile* proj = &(projs[i]);
+
+		ChecksumAdd( &state, ChecksumFloat( proj->pos.x ), ChecksumFloat( proj->pos.y ),
+							 ChecksumFloat( proj->vel.x ), ChecksumFloat( proj->vel.y ) );
+		ChecksumAdd( &state, proj->alive | ( proj->damage << 8 ) | ( proj->friendly << 16 ),
+							 (Uint32)proj->collision.x, (Uint32)proj->collision.y,
+							 proj->ani.position ^ ( (Uint32)proj->ani.def << 24 ) );
+	}
+
+	return ChecksumEnd( &state );
+}
+
+/*
+	Checksum Enemy Projectiles
+
+	Purpose: Hashes the enemy projectile pool, up to its
+			live count. Velocity and collision boxes come
+			from the position along the path, so only
+			the position is hashed.
+
+	Parameters: Projs - the projectile pool
+				Count - the number of live projectiles
+
+	Return:	The hash
+*/
+
+static Uint32 	ChecksumEnemyProjectiles( const Projectile* projs, Uint16 count )
+{
+	ChecksumState state;
+	ChecksumBegin( &state );
+
+	ChecksumAdd( &state, count, 0, 0, 0 );
+
+	for( Uint16 i = 0; i < count; i++ )
+	{
+		const Projectile* proj = &(projs[i]);
+
+		ChecksumAdd( &state, ChecksumFloat( proj->pos.x ), ChecksumFloat( proj->pos.y ),
+							 proj->damage | ( (Uint32)proj->ani.def << 16 ), proj->ani.position );
+	}
+
+	return ChecksumEnd( &state );
+}
+
+/*
+	Game Checksum Compute
+
+	Purpose: Hashes the sim state: the players, live
+			enemies, projectiles, score, random state
+			and tick. Not called by the tick itself, only
+			where the hash is compared: recording and
+			playing back replays, after each rollback
+			tick, and by the benchmarks.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Checksum - where to put the hashes
+
+	Return:	Nil
+*/
+
+void 			GameChecksumCompute( Game* game, GameChecksum* checksum )
+{
+	ChecksumState state;
+
+	// Players
+	ChecksumBegin( &state );
+
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+	{
+		const Player* player = &(game->players[p]);
+
+		ChecksumAdd( &state, ChecksumFloat( player->pos.x ), ChecksumFloat( player->pos.y ),
+							 ChecksumFloat( player->vel.x ), ChecksumFloat( player->vel.y ) );
+		ChecksumAdd( &state, player->alive | ( player->reloading << 8 ) | ( player->joined << 16 ),
+							 (Uint16)player->hp | ( (Uint32)(Uint16)player->hp_max << 16 ),
+							 (Uint32)player->collision.x ^ ( (Uint32)player->collision.y << 16 ),
+							 player->ship_ani.position ^ ( (Uint32)player->ship_ani.def << 24 ) );
+	}
+
+	checksum->fields[CHECKSUM_PLAYERS] = ChecksumEnd( &state );
+
+	// Enemies
+	ChecksumBegin( &state );
+	ChecksumAdd( &state, game->enemy_count, game->enemy_behaviour_end[ENEMY_BEHAVIOUR_SIMPLE],
+						 game->enemy_behaviour_end[ENEMY_BEHAVIOUR_STRAIGHTSHOOT],
+						 game->enemy_behaviour_end[ENEMY_BEHAVIOUR_STRAFESHOOT] );
+
+	for( Uint16 i = 0; i < game->enemy_count; i++ )
+	{
+		const Enemy* enemy = &(game->enemies[i]);
+		const EnemyCold* cold = &(game->enemies_cold[i]);
+
+		ChecksumAdd( &state, ChecksumFloat( enemy->pos.x ), ChecksumFloat( enemy->pos.y ),
+							 ChecksumFloat( enemy->vel.x ), ChecksumFloat( enemy->vel.y ) );
+		ChecksumAdd( &state, enemy->alive | ( enemy->behaviour << 8 ) | ( (Uint32)cold->type << 16 ),
+							 (Uint16)enemy->hp | ( (Uint32)(Uint16)cold->hp_max << 16 ),
+							 enemy->data.straight_data.fire_interval ^ ( (Uint32)enemy->data.straight_data.pattern << 24 ),
+							 cold->ship_ani.position ^ ( (Uint32)cold->ship_ani.def << 24 ) );
+	}
+
+	checksum->fields[CHECKSUM_ENEMIES] = ChecksumEnd( &state );
+
+	// Projectiles
+	checksum->fields[CHECKSUM_PROJECTILES_FRIENDLY] 	= ChecksumProjectiles( game->projectiles_friendly, game->proj_friendly_count );
+	checksum->fields[CHECKSUM_PROJECTILES_ENEMY] 		= ChecksumEnemyProjectiles( game->projectiles_enemy, game->proj_enemy_count );
+
+	// Score
+	ChecksumBegin( &state );
+	ChecksumAdd( &state, game->score, game->high_score, game->playing | ( game->needs_reset << 8 ), 0 );
+	checksum->fields[CHECKSUM_SCORE] = ChecksumEnd( &state );
+
+	// Random State, and the timer tick it moves along with.
+	// Particles are only for show, and aren't kept in snapshots
+	ChecksumBegin( &state );
+	ChecksumAdd( &state, game->random_state, game->timers.tick, 0, 0 );
+	checksum->fields[CHECKSUM_RANDOM] = ChecksumEnd( &state );
+}
+
+/*
+	Game Checksum Compare
+
+	Purpose: Checks a checksum against the one expected,
+			and prints each field that differs.
+
+	Parameters: Expected - the checksum expected
+				Actual - the checksum found
+				Tick - the tick, for the report
+
+	Return:	True if they match
+*/
+
+bool 			GameChecksumCompare( const GameChecksum* expected, const GameChecksum* actual, Uint32 tick )
+{
+	bool same = true;
+
+	for( Uint16 f = 0; f < checksum_field_count; f++ )
+	{
+		if ( expected->fields[f] == actual->fields[f] )
+			continue;
+
+		printf( "Desync at tick %u in %s (%08X, expected %08X)\n",
+				tick, checksum_field_names[f], actual->fields[f], expected->fields[f] );
+		same = false;
+	}
+
+	return same;
+}
@@ -0,0 +1,317 @@
+/*************************************/
+/** Collision <source file>			**/
+/**									**/
+/** The collision stage of the game	**/
+/** update. Finds every contact		**/
+/** after movement, then raises		**/
+/** damage and kill events.			**/
+/*************************************/
+
+#include <stdio.h>
+
+#include "Game.h"
+
+/*
+	Collision Gather
+
+	Purpose: Packs the boxes covering where each
+			projectile in a pool moved this tick into a
+			batch, so they can all be checked against one
+			box at once.
+
+	Parameters: Arena - the arena to allocate from
+				Batch - the batch to fill
+				Projs - the projectile pool
+				Count - the number of live projectiles
+
+	Return:	True if the batch was allocated
+*/
+
+static bool 	CollisionGather( FrameArena* arena, AabbBatch* batch, Projectile* projs, Uint16 count )
+{
+	if ( !UtilityAabbBatchInit( batch, arena, count ) )
+		return false;
+
+	for( Uint16 i = 0; i < count; i++ )
+	{
+		SDL_Rect bounds;
+		UtilityAabbSweepBounds( &bounds, &(projs[i].collision), projs[i].vel );
+		UtilityAabbBatchAdd( batch, &bounds );
+	}
+
+	return true;
+}
+
+/*
+	Game Collision Find
+
+	Purpose: Tests every pair of objects that can hurt
+			each other, and writes a contact for each
+			pair that overlaps. Nothing is changed.
+			Projectiles are swept along their movement
+			for the tick, so fast ones can't skip over a
+			target. The SIMD box kernel rules out most
+			pairs first. Live players are packed into a
+			batch of their own, so each enemy is checked
+			against all of them at once. The enemy
+			projectile batch is checked once, against the
+			box covering every player's sweep, and only
+			the projectiles left are checked against each
+			player.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Contacts - the array to write contacts to
+				Max - the size of the contacts array
+
+	Return:	The number of contacts found
+*/
+
+Uint32 			GameCollisionFind( Game* game, Contact* contacts, Uint32 max )
+{
+	Uint32 count = 0;
+
+	// Pack the Projectile and Player Boxes
+	AabbBatch friendly;
+	AabbBatch hostile;
+	AabbBatch players;
+
+	if ( !CollisionGather( &(game->frame_arena), &friendly, game->projectiles_friendly, game->proj_friendly_count ) ||
+		 !CollisionGather( &(game->frame_arena), &hostile, game->projectiles_enemy, game->proj_enemy_count ) ||
+		 !UtilityAabbBatchInit( &players, &(game->frame_arena), PLAYER_MAX ) )
+	{
+		printf( "Error: No frame memory for collision boxes\n" );
+		return 0;
+	}
+
+	// Which player each box in the batch is, where each went this
+	// tick, and the box covering all of those
+	Uint16 player_index[PLAYER_MAX];
+	SDL_Rect sweeps[PLAYER_MAX];
+	SDL_Rect reach = { 0, 0, 0, 0 };
+
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+	{
+		Player* player = &(game->players[p]);
+		if ( !player->alive )
+			continue;
+
+		SDL_Rect* bounds = &(sweeps[players.count]);
+		UtilityAabbSweepBounds( bounds, &(player->collision), player->moved );
+
+		player_index[players.count] = p;
+		UtilityAabbBatchAdd( &players, &(player->collision) );
+
+		if ( players.count == 1 )
+			reach = *bounds;
+		else
+		{
+			int right = SDL_max( reach.x + reach.w, bounds->x + bounds->w );
+			int bottom = SDL_max( reach.y + reach.h, bounds->y + bounds->h );
+
+			reach.x = SDL_min( reach.x, bounds->x );
+			reach.y = SDL_min( reach.y, bounds->y );
+			reach.w = right - reach.x;
+			reach.h = bottom - reach.y;
+		}
+	}
+
+	Uint32 hits[AABB_HIT_WORDS(POOLSIZE_ENEMY_PROJ > POOLSIZE_FRIENDLY_PROJ ? POOLSIZE_ENEMY_PROJ : POOLSIZE_FRIENDLY_PROJ)];
+	Uint32 player_hits[AABB_HIT_WORDS(PLAYER_MAX)];
+
+	for( Uint16 e = 0; e < game->enemy_count && count < max; e++ )
+	{
+		Enemy* enemy = &(game->enemies[e]);
+
+		// Enemy rams the Players
+		if ( players.count > 0 && UtilityAabbCheckBatch( &(enemy->collision), &players, player_hits ) > 0 )
+		{
+			for( Uint32 w = 0; w < AABB_HIT_WORDS(players.count); w++ )
+			{
+				for( Uint32 bits = player_hits[w]; bits != 0 && count < max; bits &= bits-1 )
+				{
+					contacts[count].type 	= CONTACT_PLAYER_ENEMY;
+					contacts[count].a 		= e;
+					contacts[count].b 		= player_index[w*32 + __builtin_ctz(bits)];
+					++count;
+				}
+			}
+		}
+
+		// Friendly Projectiles hit the Enemy
+		SDL_Rect bounds;
+		UtilityAabbSweepBounds( &bounds, &(enemy->collision), enemy->moved );
+
+		if ( UtilityAabbCheckBatch( &bounds, &friendly, hits ) == 0 )
+			continue;
+
+		for( Uint32 w = 0; w < AABB_HIT_WORDS(friendly.count); w++ )
+		{
+			for( Uint32 bits = hits[w]; bits != 0 && count < max; bits &= bits-1 )
+			{
+				Uint16 p = (Uint16)(w*32 + __builtin_ctz(bits));
+				Projectile* proj = &(game->projectiles_friendly[p]);
+
+				if ( !UtilityAabbSweep( &(enemy->collision), enemy->moved, &(proj->collision), proj->vel ) )
+					continue;
+
+				contacts[count].type 	= CONTACT_ENEMY_PROJECTILE;
+				contacts[count].a 		= e;
+				contacts[count].b 		= p;
+				++count;
+			}
+		}
+	}
+
+	// Enemy Projectiles hit the Players. The hostile batch is walked
+	// once, against everywhere any player went this tick, and the few
+	// left are checked against each player's sweep. The player's sweep
+	// stays the first box of each check, as the edge tests are not
+	// the same both ways round
+	if ( players.count > 0 && count < max && UtilityAabbCheckBatch( &reach, &hostile, hits ) > 0 )
+	{
+		for( Uint32 w = 0; w < AABB_HIT_WORDS(hostile.count); w++ )
+		{
+			for( Uint32 bits = hits[w]; bits != 0 && count < max; bits &= bits-1 )
+			{
+				Uint16 p = (Uint16)(w*32 + __builtin_ctz(bits));
+				Projectile* proj = &(game->projectiles_enemy[p]);
+
+				SDL_Rect bounds = { hostile.x[p], hostile.y[p], hostile.w[p], hostile.h[p] };
+
+				for( Uint32 i = 0; i < players.count && count < max; i++ )
+				{
+					Player* player = &(game->players[player_index[i]]);
+
+					if ( !UtilityAabbCheck( &(sweeps[i]), &bounds ) ||
+						 !UtilityAabbSweep( &(player->collision), player->moved, &(proj->collision), proj->vel ) )
+						continue;
+
+					contacts[count].type 	= CONTACT_PLAYER_PROJECTILE;
+					contacts[count].a 		= player_index[i];
+					contacts[count].b 		= p;
+					++count;
+				}
+			}
+		}
+	}
+
+	return count;
+}
+
+/*
+	Game Collision Resolve
+
+	Purpose: Raises the damage and kill events for each
+			contact, and removes the projectiles that
+			hit something. The events are applied when
+			the event queue is drained.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Contacts - the contacts found this tick
+				Count - the number of contacts
+
+	Return:	Nil
+*/
+
+void 			GameCollisionResolve( Game* game, const Contact* contacts, Uint32 count )
+{
+	if ( count == 0 )
+		return;
+
+	for( Uint32 i = 0; i < count; i++ )
+	{
+		const Contact* contact = &(contacts[i]);
+
+		switch( contact->type )
+		{
+			case CONTACT_PLAYER_ENEMY:
+			{
+				GameEventPush( game, GAME_EVENT_DAMAGE, GAME_EVENT_TARGET_PLAYER + contact->b, 25 );
+				GameEventPush( game, GAME_EVENT_KILL, contact->a, 0 );
+			}
+			break;
+
+			case CONTACT_ENEMY_PROJECTILE:
+			{
+				Projectile* proj = &(game->projectiles_friendly[contact->b]);
+
+				GameEventPush( game, GAME_EVENT_DAMAGE, contact->a, proj->damage );
+				proj->alive = false;
+			}
+			break;
+
+			case CONTACT_PLAYER_PROJECTILE:
+			{
+				Projectile* proj = &(game->projectiles_enemy[contact->b]);
+
+				GameEventPush( game, GAME_EVENT_DAMAGE, GAME_EVENT_TARGET_PLAYER + contact->a, proj->damage );
+				proj->alive = false;
+			}
+			break;
+
+			default:
+			break;
+		}
+	}
+
+	// Remove Spent Projectiles
+	for( Sint32 i = 0; i < game->proj_friendly_count; i++ )
+	{
+		if ( !game->projectiles_friendly[i].alive )
+		{
+			GameKillProjectile( game, &(game->projectiles_friendly[i]) );
+			--i;
+		}
+	}
+
+	for( Sint32 i = 0; i < game->proj_enemy_count; i++ )
+	{
+		if ( !game->projectiles_enemy[i].alive )
+		{
+			GameKillProjectile( game, &(game->projectiles_enemy[i]) );
+			--i;
+		}
+	}
+}
+
+/*
+	Game Collide
+
+	Purpose: Runs the collision stage, once everything
+			has moved for the tick. Contacts and packed
+			boxes are kept in the frame arena, and
+			released afterwards.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			GameCollide( Game* game )
+{
+	// Most contacts that can happen in a tick
+	Uint32 alive = 0;
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+		alive += game->players[p].alive;
+
+	Uint32 max = game->enemy_count * (game->proj_friendly_count + alive) + game->proj_enemy_count * alive;
+	if ( max == 0 )
+		return;
+
+	Uint32 mark = ArenaMark( &(game->frame_arena) );
+
+	Contact* contacts = (Contact*)ArenaAlloc( &(game->frame_arena), max * sizeof(Contact), alignof(Contact) );
+	if ( contacts == nullptr )
+	{
+		printf( "Error: No frame memory for %u contacts\n", max );
+		return;
+	}
+
+	Uint32 count = GameCollisionFind( game, contacts, max );
+	GameCollisionResolve( game, contacts, count );
+
+	ArenaRewind( &(game->frame_arena), mark );
+}
@@ -8,6 +8,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 #include "Game.h"
@@ -18,158 +19,326 @@
 	Purpose: Called once to initialise an enemies
 			engine data.
 
-	Parameters: Enemy - a pointer to the enemy to
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Enemy - a pointer to the enemy to
 					Affect.
+				Cold - the enemy's cold data
 
 	Return:	Nil
 */
 
-void 			EnemyInit( Enemy* enemy )
+void 			EnemyInit( Game* game, Enemy* enemy, EnemyCold* cold )
 {
 	enemy->alive = false;
-	enemy->sprite_texture = GameFindTexture( enemy->runner, "Primary" );
+	cold->sprite_texture = GameFindTexture( game, "Primary" );
 }
 
 /*
-	Enemy Setup
+	Built in enemy types, indexed by EnemyType. Adding a
+	type is a new row here (or a line in the archetype
+	file), there is no per-type spawning code.
+*/
 
-	Purpose: Called to Setup an enemy to be
-			active and of a specific type. The enemy
-			must be dead to be setup.
+static constexpr EnemyArchetypeDef enemy_archetype_defaults[enemy_type_count] =
+{
+	// Behaviour						Velocity	Random		HP	Score	Collision		Row	Fire		Pattern					Spawn
+	{ ENEMY_BEHAVIOUR_SIMPLE,			0, 3,		0, 2,		1,	10,		24, 24, 4, 4,	3,	0, 0,		BULLET_PATTERN_SINGLE,	-32, -64, SCREEN_WIDTH, 0 },
+	{ ENEMY_BEHAVIOUR_STRAIGHTSHOOT,	0, 1,		0, 2,		1,	40,		24, 24, 4, 4,	4,	500, 500,	BULLET_PATTERN_SINGLE,	0, -64, SCREEN_WIDTH, 0 },
+	{ ENEMY_BEHAVIOUR_STRAFESHOOT,		3, 0,		2, 0,		1,	60,		24, 24, 4, 4,	5,	500, 600,	BULLET_PATTERN_SINGLE,	-64, 64, 0, SCREEN_HEIGHT/2 },
+};
+
+// Update function for each behaviour, indexed by EnemyBehaviour
+static bool 	(* const enemy_behaviour_updates[enemy_behaviour_count])(Game*, Enemy*, EnemyCold*, Uint32) =
+{
+	EnemyUpdateSimple,
+	EnemyUpdateSimple, 			// Shoots from its fire timer, flies like the simple one
+	EnemyUpdateStrafeShoot,
+};
 
-	Parameters: Enemy - a pointer to the enemy to
-					Change.
-				Type - the type of enemy to spawn.
-				Spawn Random - Whether or not we should
-						affect the position to be
-						random, based on the type.
+// Whether each behaviour shoots, indexed by EnemyBehaviour
+static const bool 	enemy_behaviour_shoots[enemy_behaviour_count] =
+{
+	false,
+	true,
+	true,
+};
 
-	Return:	True if the enemy was successfully initialised.
-			False returned otherwise.
+// Behaviour names used in the archetype file, indexed by EnemyBehaviour
+static const char* 	enemy_behaviour_names[enemy_behaviour_count] =
+{
+	"simple",
+	"straight",
+	"strafe",
+};
+
+/*
+	Enemy Archetype Build
+
+	Purpose: Builds the ready made enemy for an archetype
+			from its compact description.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Arch - the archetype to build
+				Def - the description to build it from
+
+	Return:	Nil
 */
 
-bool 			EnemySetup( Enemy* enemy, EnemyType type, bool spawn_random )
+void 			EnemyArchetypeBuild( Game* game, EnemyArchetype* arch, const EnemyArchetypeDef* def )
 {
-	if (enemy->alive != false)
-		return false;
+	// Hot Data
+	Enemy* hot = &(arch->hot);
+	*hot = Enemy();
 
-	switch( type )
-	{
-		/*** Simple Enemy ***/
-		case (ENEMY_SIMPLE):
-		{
-			enemy->type 					= type;
+	hot->vel 								= Vector2D( def->vel_x, def->vel_y );
+	hot->alive 								= true;
+	hot->hp 								= def->hp;
 
-			enemy->pos.zero();
-			enemy->vel						= Vector2D( 0.0f, 3.0 + rand()%200 * 0.01 );
+	hot->collision.w 						= def->col_w;
+	hot->collision.h 						= def->col_h;
+	hot->col_offset.x 						= def->col_x;
+	hot->col_offset.y 						= def->col_y;
 
-			enemy->alive 					= true;
-			enemy->hp 						= 1;
-			enemy->hp_max					= 1;
-			enemy->score_value 				= 10;
+	hot->data.straight_data.fire_interval 	= def->fire_interval;
+	hot->data.straight_data.pattern 		= def->pattern;
 
-			enemy->collision.w 				= 24;
-			enemy->collision.h 				= 24;
-			enemy->col_offset.x 			= 4;
-			enemy->col_offset.y 			= 4;
+	hot->behaviour 							= def->behaviour;
+	hot->update 							= enemy_behaviour_updates[def->behaviour];
 
-			enemy->ship_ani.image_count 	= 1;
-			enemy->ship_ani.image_speed 	= 0;
-			enemy->ship_ani.image_index 	= 0;
-			enemy->ship_ani.y_offset 		= 32*3;
-			enemy->ship_ani.rect.w 			= 32;
-			enemy->ship_ani.rect.h 			= 32;
-			enemy->ship_ani.loops 			= false;
+	// Cold Data
+	EnemyCold* cold = &(arch->cold);
+	*cold = EnemyCold();
 
-			enemy->update					= EnemyUpdateSimple;
+	cold->type 								= (EnemyType)(arch - game->enemy_archetypes);
+	cold->hp_max 							= def->hp;
+	cold->score_value 						= def->score_value;
 
-			if ( spawn_random )
-				enemy->pos = Vector2D( 32+rand()%SCREEN_WIDTH-64, -64 );
+	AnimationStart( &(cold->ship_ani), AnimationDefine( game, 0, def->sprite_row, 1, 0, false ) );
 
-			return true;
-		}
-		break;
+	cold->sprite_texture 					= GameFindTexture( game, "Primary" );
 
-		/*** Straight Shoot enemy ***/
-		case (ENEMY_STRAIGHTSHOOT):
-		{
-			enemy->type 						= type;
+	// Spawn Overrides
+	arch->vel_random 						= Vector2D( def->vel_random_x, def->vel_random_y );
+	arch->fire_delay 						= def->fire_delay;
+	arch->spawn_min.x 						= def->spawn_x;
+	arch->spawn_min.y 						= def->spawn_y;
+	arch->spawn_range.x 					= def->spawn_range_x;
+	arch->spawn_range.y 					= def->spawn_range_y;
+}
+
+/*
+	Enemy Archetypes Init
+
+	Purpose: Builds the built in archetypes, then adds
+			any extra types from the archetype file.
+			Must be called after textures are loaded.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			EnemyArchetypesInit( Game* game )
+{
+	for( Uint16 i = 0; i < enemy_type_count; i++ )
+		EnemyArchetypeBuild( game, &(game->enemy_archetypes[i]), &(enemy_archetype_defaults[i]) );
+
+	game->enemy_archetype_count = enemy_type_count;
+
+	// Extra Types are optional
+	EnemyArchetypesLoad( game, ENEMY_ARCHETYPE_FILE );
+}
+
+/*
+	Enemy Archetypes Load
+
+	Purpose: Adds enemy types from a text file. Each
+			line that isn't blank, or a '#' comment, is
+			one type, with the fields of EnemyArchetypeDef
+			in order, separated by spaces:
+
+			behaviour vel_x vel_y vel_random_x vel_random_y
+			hp score col_w col_h col_x col_y sprite_row
+			fire_delay fire_interval
+			spawn_x spawn_y spawn_range_x spawn_range_y
+			[pattern]
+
+			Behaviour is one of simple, straight or strafe.
+			Pattern is optional, one of single, radial,
+			spiral or fan, and is single if left out.
 
-			enemy->pos.zero();
-			enemy->vel							= Vector2D( 0.0f, 1.0 + rand()%200 * 0.01 );
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Filename - the file to load
 
-			enemy->alive 						= true;
-			enemy->hp 							= 1;
-			enemy->hp_max						= 1;
-			enemy->score_value 					= 40;
+	Return:	The number of types added
+*/
+
+Uint16 			EnemyArchetypesLoad( Game* game, const char* filename )
+{
+	FILE* file = fopen( filename, "r" );
+	if ( file == nullptr )
+		return 0;
 
-			enemy->collision.w 					= 24;
-			enemy->collision.h 					= 24;
-			enemy->col_offset.x 				= 4;
-			enemy->col_offset.y 				= 4;
+	char line[256];
+	char behaviour[32];
+	char pattern[32];
+	Uint16 line_number = 0;
+	Uint16 added = 0;
 
-			enemy->ship_ani.image_count 		= 1;
-			enemy->ship_ani.image_speed 		= 0;
-			enemy->ship_ani.image_index 		= 0;
-			enemy->ship_ani.y_offset 			= 32*4;
-			enemy->ship_ani.rect.w 				= 32;
-			enemy->ship_ani.rect.h 				= 32;
-			enemy->ship_ani.loops 				= false;
+	while( fgets( line, sizeof(line), file ) != nullptr )
+	{
+		++line_number;
+
+		// Skip Blank Lines and Comments
+		const char* start = line;
+		while( *start == ' ' || *start == '\t' )
+			++start;
+		if ( *start == '#' || *start == '\n' || *start == '\r' || *start == '\0' )
+			continue;
 
-			enemy->data.straight_data.cooldown	= SDL_GetTicks() + 500;
+		if ( game->enemy_archetype_count >= ENEMY_ARCHETYPE_MAX )
+		{
+			printf( "Error: %s:%u, too many enemy types (max %d)\n", filename, line_number, ENEMY_ARCHETYPE_MAX );
+			break;
+		}
 
-			enemy->update						= EnemyUpdateStraightShoot;
+		EnemyArchetypeDef def;
+		int hp, sprite_row, col_w, col_h, col_x, col_y;
+		int spawn_x, spawn_y, spawn_range_x, spawn_range_y;
 
-			if ( spawn_random )
-				enemy->pos = Vector2D( 64+rand()%SCREEN_WIDTH-64, -64 );
+		int read = sscanf( start, "%31s %f %f %f %f %d %u %d %d %d %d %d %u %u %d %d %d %d %31s",
+						   behaviour, &def.vel_x, &def.vel_y, &def.vel_random_x, &def.vel_random_y,
+						   &hp, &def.score_value, &col_w, &col_h, &col_x, &col_y, &sprite_row,
+						   &def.fire_delay, &def.fire_interval,
+						   &spawn_x, &spawn_y, &spawn_range_x, &spawn_range_y, pattern );
 
-			return true;
+		if ( read != 18 && read != 19 )
+		{
+			printf( "Error: %s:%u, expected 18 or 19 fields, found %d\n", filename, line_number, read );
+			continue;
 		}
-		break;
 
-		/*** Straight Shoot enemy ***/
-		case (ENEMY_STRAFESHOOT):
+		// Find the Bullet Pattern by Name
+		def.pattern = BULLET_PATTERN_SINGLE;
+		if ( read == 19 )
 		{
-			enemy->type 						= type;
+			def.pattern = BulletPatternFind( pattern );
+			if ( def.pattern == bullet_pattern_count )
+			{
+				printf( "Error: %s:%u, unknown bullet pattern %s\n", filename, line_number, pattern );
+				continue;
+			}
+		}
 
-			enemy->pos.zero();
-			enemy->vel							= Vector2D( 3.0 + rand()%200 * 0.01, 0.0f );
+		// Find the Behaviour by Name
+		Uint16 b = 0;
+		for( ; b < enemy_behaviour_count; b++ )
+		{
+			if ( strcmp( behaviour, enemy_behaviour_names[b] ) == 0 )
+				break;
+		}
 
-			enemy->alive 						= true;
-			enemy->hp 							= 1;
-			enemy->hp_max						= 1;
-			enemy->score_value 					= 60;
+		if ( b == enemy_behaviour_count )
+		{
+			printf( "Error: %s:%u, unknown enemy behaviour %s\n", filename, line_number, behaviour );
+			continue;
+		}
 
-			enemy->collision.w 					= 24;
-			enemy->collision.h 					= 24;
-			enemy->col_offset.x 				= 4;
-			enemy->col_offset.y 				= 4;
+		def.behaviour 		= (EnemyBehaviour)b;
+		def.hp 				= hp;
+		def.col_w 			= col_w;
+		def.col_h 			= col_h;
+		def.col_x 			= col_x;
+		def.col_y 			= col_y;
+		def.sprite_row 		= sprite_row;
+		def.spawn_x 		= spawn_x;
+		def.spawn_y 		= spawn_y;
+		def.spawn_range_x 	= spawn_range_x;
+		def.spawn_range_y 	= spawn_range_y;
+
+		EnemyArchetypeBuild( game, &(game->enemy_archetypes[game->enemy_archetype_count++]), &def );
+		++added;
+	}
 
-			enemy->ship_ani.image_count 		= 1;
-			enemy->ship_ani.image_speed 		= 0;
-			enemy->ship_ani.image_index 		= 0;
-			enemy->ship_ani.y_offset 			= 32*5;
-			enemy->ship_ani.rect.w 				= 32;
-			enemy->ship_ani.rect.h 				= 32;
-			enemy->ship_ani.loops 				= false;
+	fclose( file );
 
-			enemy->data.straight_data.cooldown	= SDL_GetTicks() + 500;
+	printf( "Loaded %u enemy types from %s\n", added, filename );
+	return added;
+}
 
-			enemy->update						= EnemyUpdateStrafeShoot;
+/*
+	Enemy Setup
 
-			if ( spawn_random )
-				enemy->pos = Vector2D( -64, 64 + (rand()%(SCREEN_HEIGHT/2)) );
+	Purpose: Called to Setup an enemy to be
+			active and of a specific type. The enemy
+			must be dead to be setup. The type's ready
+			made enemy is copied in, then the random
+			parts are filled in.
 
-			return true;
-		}
-		break;
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Enemy - a pointer to the enemy to
+					Change.
+				Cold - the enemy's cold data
+				Type - the type of enemy to spawn.
+				Spawn Random - Whether or not we should
+						affect the position to be
+						random, based on the type.
+
+	Return:	True if the enemy was successfully initialised.
+			False returned otherwise.
+*/
+
+bool 			EnemySetup( Game* game, Enemy* enemy, EnemyCold* cold, EnemyType type, bool spawn_random )
+{
+	if (enemy->alive != false)
+		return false;
 
-		/*** Fail Case ***/
-		default:
-			printf( "Error: Tried to create unknown enemy type!\n" );
-			return false;
-		break;
+	if ( type >= game->enemy_archetype_count )
+	{
+		printf( "Error: Tried to create unknown enemy type!\n" );
+		return false;
 	}
+
+	const EnemyArchetype* arch = &(game->enemy_archetypes[type]);
+
+	// Stop any shots left over from the slot's last enemy
+	TimerCancel( &(game->timers), cold->fire_timer );
+
+	// Copy the Ready Made Enemy
+	*enemy = arch->hot;
+	*cold = arch->cold;
+
+	// Randomise Speed
+	if ( arch->vel_random.x > 0 )
+		enemy->vel.x += GameRandom(game)%200 * 0.005f * arch->vel_random.x;
+	if ( arch->vel_random.y > 0 )
+		enemy->vel.y += GameRandom(game)%200 * 0.005f * arch->vel_random.y;
+
+	// Schedule the First Shot
+	if ( enemy_behaviour_shoots[enemy->behaviour] )
+	{
+		cold->fire_timer = TimerSchedule( &(game->timers), TIMER_MS_TO_TICKS(arch->fire_delay),
+										  EnemyFireTimer, (Uint16)(enemy - game->enemies) );
+	}
+
+	// Randomise Position
+	if ( spawn_random )
+	{
+		enemy->pos.x = arch->spawn_min.x;
+		enemy->pos.y = arch->spawn_min.y;
+
+		if ( arch->spawn_range.x > 0 )
+			enemy->pos.x += GameRandom(game)%arch->spawn_range.x;
+		if ( arch->spawn_range.y > 0 )
+			enemy->pos.y += GameRandom(game)%arch->spawn_range.y;
+	}
+
+	return true;
 }
 
 /*
@@ -179,13 +348,15 @@ bool 			EnemySetup( Enemy* enemy, EnemyType type, bool spawn_random )
 
 	Parameters: E1 - a pointer to the first enemy to
 					be swapped.
+				C1 - the first enemy's cold data
 				E2 - a pointer to the second enemy to
 					be swapped.
+				C2 - the second enemy's cold data
 
 	Return:	Nil
 */
 
-void 			EnemySwap( Enemy* e1, Enemy* e2 )
+void 			EnemySwap( Enemy* e1, EnemyCold* c1, Enemy* e2, EnemyCold* c2 )
 {
 	// Check that we aren't trying to swap the same value
     if (e1 == e2)
@@ -194,6 +365,10 @@ void 			EnemySwap( Enemy* e1, Enemy* e2 )
 	Enemy temp = *e1;
 	*e1 = *e2;
 	*e2 = temp;
+
+	EnemyCold temp_cold = *c1;
+	*c1 = *c2;
+	*c2 = temp_cold;
 }
 
 /*
@@ -201,133 +376,131 @@ void 			EnemySwap( Enemy* e1, Enemy* e2 )
 
 	Purpose: Called to draw an enemy to the screen
 
-	Parameters: Enemy - a pointer to the enemy to
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Enemy - a pointer to the enemy to
 					Affect.
+				Cold - the enemy's cold data
 
 	Return:	Nil
 */
 
-void 			EnemyRender( Enemy* enemy )
+void 			EnemyRender( Game* game, Enemy* enemy, EnemyCold* cold )
 {
-	AnimationUpdate( &(enemy->ship_ani) );
-
 	int pos_x = (int)roundf(enemy->pos.x-16);
 	int pos_y = (int)roundf(enemy->pos.y-16);
 
-    TextureRender(	enemy->sprite_texture, enemy->runner->render,
-					pos_x, pos_y, &(enemy->ship_ani.rect) );
+    TextureRender(	cold->sprite_texture, game->render,
+					pos_x, pos_y, AnimationRect( game, &(cold->ship_ani) ) );
 }
 
 /*
-	Enemy Update Simple
+	Enemy Move
 
-	Purpose: <Enemy Update Function>
-			 This Simple enemy will fly in a straight
-			 vertical pattern, until it goes out of
-			 screen.
+	Purpose: Moves an enemy by its velocity, and
+			moves its collision box to match. Remembers
+			the move, as behaviours may change the
+			velocity afterwards.
 
 	Parameters: Enemy - a pointer to the enemy to
 					Affect.
 
-	Return:	True if the enemy ends the update still alive
-			Otherwise false
+	Return:	Nil
 */
 
-bool			EnemyUpdateSimple( Enemy* enemy, Uint32 dt )
+static inline void 	EnemyMove( Enemy* enemy )
 {
 	// Move Positions
 	enemy->pos += enemy->vel;
+	enemy->moved = enemy->vel;
 
 	// Update Collision Box
 	enemy->collision.x = (int)enemy->pos.x-16 + enemy->col_offset.x;
 	enemy->collision.y = (int)enemy->pos.y-16 + enemy->col_offset.y;
+}
 
-	// Cache Game Pointer for Ease
-	Game* game = enemy->runner;
+/*
+	Enemy Shoot
 
-	// Check Player Collision
-	Player* player = &(game->player);
-	if (player->alive)
-	{
-		if (UtilityAabbCheck( &(enemy->collision), &(player->collision) ))
-		{
-			player->hp -= 25;
-			enemy->alive = false;
-			GameSpawnParticle( game, enemy->pos, PART_EXPLOSION_01 );
-		}
-	}
+	Purpose: Fires a volley of the enemy's bullet
+			pattern, from just below it.
 
-	// Check Projectile Collisions
-	Projectile* proj;	for( Uint16 i = 0; i < game->proj_friendly_count; i++ )
-	{
-		proj = &(game->projectiles_friendly[i]);
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Enemy - a pointer to the enemy to
+					Affect.
 
-		if ( UtilityAabbCheck( &(enemy->collision), &(proj->collision) ) )
-		{
-			enemy->hp -= proj->damage;
-			proj->alive = false;
-		}
-	}
+	Return:	Nil
+*/
 
-	// Check for Out of Screen
-	if ( enemy->pos.y > SCREEN_HEIGHT+64 )
-		enemy->alive = false;
+static inline void 	EnemyShoot( Game* game, Enemy* enemy )
+{
+	Vector2D pos = enemy->pos;
+	pos.y += 32;
 
-	// Check for no more health
-	if (enemy->hp <= 0)
-	{
-		GameSpawnParticle( game, enemy->pos, PART_EXPLOSION_01 );
-		enemy->alive = false;
-		GameScoreAdd( game, enemy->score_value );
-	}
+	BulletPatternFire( game, pos, enemy->data.straight_data.pattern );
+}
 
-	return enemy->alive;
+/*
+	Enemy Fire Timer
+
+	Purpose: <Timer Callback>
+			 Fires a shooting enemy's next shot, and
+			 schedules the one after it. Shots are timed
+			 by the timer wheel, so enemies don't check a
+			 cooldown every tick.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Target - the index of the enemy
+
+	Return:	Nil
+*/
+
+void 			EnemyFireTimer( Game* game, Uint16 target )
+{
+	Enemy* enemy = &(game->enemies[target]);
+	EnemyCold* cold = &(game->enemies_cold[target]);
+
+	cold->fire_timer = TIMER_NONE;
+
+	if ( !enemy->alive )
+		return;
+
+	EnemyShoot( game, enemy );
+
+	cold->fire_timer = TimerSchedule( &(game->timers), TIMER_MS_TO_TICKS(enemy->data.straight_data.fire_interval),
+									  EnemyFireTimer, target );
 }
 
 /*
-	Enemy Update Straight Shoot
+	Enemy Update Simple
 
 	Purpose: <Enemy Update Function>
 			 This Simple enemy will fly in a straight
 			 vertical pattern, until it goes out of
-			 screen, shooting a projectile.
-
-	Parameters: Enemy - a pointer to the enemy to
+			 screen. Collisions are handled separately,
+			 by the collision stage. Also used by the
+			 straight shooting enemy, whose shots come
+			 from its fire timer.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Enemy - a pointer to the enemy to
 					Affect.
+				Cold - the enemy's cold data
 
 	Return:	True if the enemy ends the update still alive
 			Otherwise false
 */
 
-bool			EnemyUpdateStraightShoot( Enemy* enemy, Uint32 dt )
+bool			EnemyUpdateSimple( Game* game, Enemy* enemy, EnemyCold* cold, Uint32 dt )
 {
-	// Copy Update Simple Movement
-	EnemyUpdateSimple(enemy, dt);
+	EnemyMove( enemy );
 
-	// Check for Shootinig
-	if (SDL_GetTicks() > enemy->data.straight_data.cooldown)
-	{
-		// Set Cooldown
-		enemy->data.straight_data.cooldown = SDL_GetTicks() + 500;
-
-		// Get Position and Velocity of Projectile
-		Vector2D pos = enemy->pos;
-		Vector2D vel( 0, 15 );
-		pos.y += 32;
-
-		// Spawn Projectile
-		Projectile* proj = GameSpawnProjectile( enemy->runner, false, pos, vel );
-
-		// Additional Properties
-		if (proj != nullptr)
-		{
-			proj->ani.image_count = 2;
-			proj->ani.image_speed = 0;
-			proj->ani.image_index = 1;
-			proj->ani.y_offset = 32*7;
-			proj->damage = 5;
-		}
-	}
+	// Check for Out of Screen
+	if ( enemy->pos.y > SCREEN_HEIGHT+64 )
+		enemy->alive = false;
 
 	return enemy->alive;
 }
@@ -339,21 +512,19 @@ bool			EnemyUpdateStraightShoot( Enemy* enemy, Uint32 dt )
 			 This Enemy will appear at the side of screen,
 			 strafing left to right, while shooting downward
 
-	Parameters: Enemy - a pointer to the enemy to
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Enemy - a pointer to the enemy to
 					Affect.
+				Cold - the enemy's cold data
 
 	Return:	True if the enemy ends the update still alive
 			Otherwise false
 */
 
-bool			EnemyUpdateStrafeShoot( Enemy* enemy, Uint32 dt )
+bool			EnemyUpdateStrafeShoot( Game* game, Enemy* enemy, EnemyCold* cold, Uint32 dt )
 {
-	// Move Positions
-	enemy->pos += enemy->vel;
-
-	// Update Collision Box
-	enemy->collision.x = (int)enemy->pos.x-16 + enemy->col_offset.x;
-	enemy->collision.y = (int)enemy->pos.y-16 + enemy->col_offset.y;
+	EnemyMove( enemy );
 
 	// Check for reverse direction
 	if ( enemy->pos.x < 0 && enemy->vel.x < 0 )
@@ -362,65 +533,58 @@ bool			EnemyUpdateStrafeShoot( Enemy* enemy, Uint32 dt )
 	if ( enemy->pos.x > SCREEN_WIDTH && enemy->vel.x > 0 )
 		enemy->vel.x *= -1;
 
-	// Cache Game Pointer for Ease
-	Game* game = enemy->runner;
+	return enemy->alive;
+}
 
-	// Check Player Collision
-	Player* player = &(game->player);
-	if (player->alive)
-	{
-		if (UtilityAabbCheck( &(enemy->collision), &(player->collision) ))
-		{
-			player->hp -= 25;
-			enemy->alive = false;
-			GameSpawnParticle( game, enemy->pos, PART_EXPLOSION_01 );
-		}
-	}
+/*
+	Enemy Update Batch
 
-	// Check Projectile Collisions
-	Projectile* proj;	for( Uint16 i = 0; i < game->proj_friendly_count; i++ )
-	{
-		proj = &(game->projectiles_friendly[i]);
+	Purpose: Updates every enemy of one behaviour. The
+			enemy pool is kept grouped by behaviour, so
+			this walks one contiguous run of enemies, and
+			the update function is called directly rather
+			than through each enemy's function pointer.
 
-		if ( UtilityAabbCheck( &(enemy->collision), &(proj->collision) ) )
-		{
-			enemy->hp -= proj->damage;
-			proj->alive = false;
-		}
-	}
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Behaviour - the behaviour being updated
+				dt - Delta time
+
+	Return:	Nil
+*/
+
+template< bool (*Update)(Game*, Enemy*, EnemyCold*, Uint32) >
+static void 	EnemyUpdateBatch( Game* game, EnemyBehaviour behaviour, Uint32 dt )
+{
+	Sint32 start = ( behaviour == 0 ? 0 : game->enemy_behaviour_end[behaviour-1] );
 
-	// Check for no more health
-	if (enemy->hp <= 0)
+	// The end moves in when an enemy of this behaviour dies
+	for( Sint32 i = start; i < game->enemy_behaviour_end[behaviour]; i++ )
 	{
-		GameSpawnParticle( game, enemy->pos, PART_EXPLOSION_01 );
-		enemy->alive = false;
-		GameScoreAdd( game, enemy->score_value );
+		if ( !Update( game, &(game->enemies[i]), &(game->enemies_cold[i]), dt ) )
+		{
+			GameKillEnemy( game, &(game->enemies[i]) );
+			--i;
+		}
 	}
+}
 
-	// Check for Shootinig
-	if (SDL_GetTicks() > enemy->data.straight_data.cooldown)
-	{
-		// Set Cooldown
-		enemy->data.straight_data.cooldown = SDL_GetTicks() + 600;
+/*
+	Enemy Update Batched
 
-		// Get Position and Velocity of Projectile
-		Vector2D pos = enemy->pos;
-		Vector2D vel( 0, 15 );
-		pos.y += 32;
+	Purpose: Updates all enemies, one behaviour at a
+			time.
 
-		// Spawn Projectile
-		Projectile* proj = GameSpawnProjectile( enemy->runner, false, pos, vel );
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				dt - Delta time
 
-		// Additional Properties
-		if (proj != nullptr)
-		{
-			proj->ani.image_count = 2;
-			proj->ani.image_speed = 0;
-			proj->ani.image_index = 1;
-			proj->ani.y_offset = 32*7;
-			proj->damage = 5;
-		}
-	}
+	Return:	Nil
+*/
 
-	return enemy->alive;
+void 			EnemyUpdateBatched( Game* game, Uint32 dt )
+{
+	EnemyUpdateBatch< EnemyUpdateSimple >( game, ENEMY_BEHAVIOUR_SIMPLE, dt );
+	EnemyUpdateBatch< EnemyUpdateSimple >( game, ENEMY_BEHAVIOUR_STRAIGHTSHOOT, dt );
+	EnemyUpdateBatch< EnemyUpdateStrafeShoot >( game, ENEMY_BEHAVIOUR_STRAFESHOOT, dt );
 }
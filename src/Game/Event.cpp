@@ -0,0 +1,191 @@
+/*************************************/
+/** Event <source file>				**/
+/**									**/
+/** The game event queue. Updates	**/
+/** push events instead of changing	**/
+/** other objects, and the queue is	**/
+/** drained once at end of a tick.	**/
+/*************************************/
+
+#include <stdio.h>
+
+#include "Game.h"
+
+/*
+	Game Event Push
+
+	Purpose: Adds an event to the end of the queue.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Type - the type of event
+				Target - the enemy index, or
+					GAME_EVENT_TARGET_PLAYER plus the
+					player index
+				Value - the damage, score, or particle
+					type, depending on the event
+				X - the x position, for spawns
+				Y - the y position, for spawns
+
+	Return:	True if the event was queued, False if the
+			queue is full
+*/
+
+bool 			GameEventPush( Game* game, GameEventType type, Uint16 target, Sint32 value, float x, float y )
+{
+	GameEventQueue* queue = &(game->events);
+
+	if ( queue->count >= GAME_EVENT_QUEUE_SIZE )
+	{
+		if ( queue->dropped++ == 0 )
+			printf( "Error: Game event queue full!\n" );
+		return false;
+	}
+
+	GameEvent* event = &(queue->events[queue->count++]);
+	event->type 	= type;
+	event->target 	= target;
+	event->value 	= value;
+	event->x 		= x;
+	event->y 		= y;
+
+	return true;
+}
+
+/*
+	Game Event Drain
+
+	Purpose: Applies every event raised this tick. Events
+			can raise more events (damage leads to a
+			kill, which leads to score and a particle),
+			which are handled in the same drain. Nothing
+			is removed from the pools until every event
+			has been handled, so enemy indices stay valid.
+			Then particles are spawned together, dead
+			enemies removed, and the score updated once.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			GameEventDrain( Game* game )
+{
+	GameEventQueue* queue = &(game->events);
+
+	if ( queue->count == 0 )
+		return;
+
+	Sint32 score_delta = 0;
+	bool killed = false;
+	bool spawns = false;
+
+	// The queue can grow while we walk it
+	for( Uint16 i = 0; i < queue->count; i++ )
+	{
+		GameEvent event = queue->events[i];
+
+		switch( event.type )
+		{
+			case GAME_EVENT_DAMAGE:
+			{
+				if ( event.target >= GAME_EVENT_TARGET_PLAYER )
+				{
+					Player* player = &(game->players[event.target - GAME_EVENT_TARGET_PLAYER]);
+					if ( !player->alive || player->hp <= 0 )
+						break;
+
+					player->hp -= event.value;
+					if ( player->hp <= 0 )
+						GameEventPush( game, GAME_EVENT_PLAYER_DEATH, event.target, 0 );
+				}
+				else
+				{
+					Enemy* enemy = &(game->enemies[event.target]);
+					if ( enemy->hp <= 0 )
+						break;
+
+					enemy->hp -= event.value;
+					if ( enemy->hp <= 0 )
+						GameEventPush( game, GAME_EVENT_KILL, event.target, 1 );
+				}
+			}
+			break;
+
+			case GAME_EVENT_KILL:
+			{
+				Enemy* enemy = &(game->enemies[event.target]);
+				if ( !enemy->alive )
+					break;
+
+				enemy->alive = false;
+				killed = true;
+
+				GameEventPush( game, GAME_EVENT_SPAWN_PARTICLE, event.target, PART_EXPLOSION_01, enemy->pos.x, enemy->pos.y );
+				if ( event.value != 0 )
+					GameEventPush( game, GAME_EVENT_SCORE, event.target, game->enemies_cold[event.target].score_value );
+			}
+			break;
+
+			case GAME_EVENT_SPAWN_PARTICLE:
+				spawns = true;
+			break;
+
+			case GAME_EVENT_SCORE:
+				score_delta += event.value;
+			break;
+
+			case GAME_EVENT_PLAYER_DEATH:
+			{
+				Player* player = &(game->players[event.target - GAME_EVENT_TARGET_PLAYER]);
+
+				player->alive = false;
+				GameEventPush( game, GAME_EVENT_SPAWN_PARTICLE, event.target, PART_EXPLOSION_01, player->pos.x, player->pos.y );
+
+				// The game is over once nobody is left
+				bool survivors = false;
+				for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+					survivors |= game->players[p].alive;
+
+				if ( !survivors )
+					TimerSchedule( &(game->timers), TIMER_MS_TO_TICKS(2000), GameResetTimer, 0 );
+			}
+			break;
+
+			default:
+			break;
+		}
+	}
+
+	// Spawn Particles together
+	if ( spawns )
+	{
+		for( Uint16 i = 0; i < queue->count; i++ )
+		{
+			GameEvent* event = &(queue->events[i]);
+
+			if ( event->type == GAME_EVENT_SPAWN_PARTICLE )
+				GameSpawnParticle( game, Vector2D( event->x, event->y ), (PartType)event->value );
+		}
+	}
+
+	// Remove Killed Enemies
+	if ( killed )
+	{
+		for( Sint32 i = 0; i < game->enemy_count; i++ )
+		{
+			if ( !game->enemies[i].alive )
+			{
+				GameKillEnemy( game, &(game->enemies[i]) );
+				--i;
+			}
+		}
+	}
+
+	// One Score change for the whole tick
+	if ( score_delta != 0 )
+		GameScoreAdd( game, score_delta );
+
+	queue->count = 0;
+}
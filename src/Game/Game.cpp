@@ -32,8 +32,8 @@ bool 			GameInit( Game* game )
 {
 	printf("--- Game Init ---\n");
 
-	// Set Random Seed
-	srand( time(0) );
+	// Set Random Seed (Xorshift can't start from 0)
+	game->random_state = (Uint32)time(0) | 1;
 
 	// Start SDL
 	if ( SDL_Init(SDL_INIT_EVERYTHING) < 0 )
@@ -60,6 +60,19 @@ bool 			GameInit( Game* game )
 		return false;
 	}
 
+	// Create the Per-Frame Scratch Memory
+	if ( !ArenaInit( &(game->frame_arena), FRAME_ARENA_SIZE ) )
+	{
+		TTF_Quit();
+		IMG_Quit();
+		SDL_Quit();
+		return false;
+	}
+
+	// Only a played game is scrubbed back, so only it keeps the ring
+	// (Not being able to rewind isn't an error)
+	RewindInit( &(game->rewind), REWIND_MEMORY );
+
 	// Set Running State to True, so we can enter the main loop
 	game->running = true;
 
@@ -88,11 +101,13 @@ bool 			GameInit( Game* game )
 
 	Parameters: Game - a pointer to the Game object
 					running the game.
+				Particle Capacity - the most particles
+					the game can show at once
 
 	Return:	Nil
 */
 
-void 			GameSetup( Game* game )
+void 			GameSetup( Game* game, Uint32 particle_capacity )
 {
 	// Set Playing to Off
 	game->playing = false;
@@ -107,26 +122,33 @@ void 			GameSetup( Game* game )
 	GameScoreSet( game, 0 );
 	GameHighScoreSet( game, 0 );
 
-	// Set Up Player Object
-	game->player.runner = game;
-	PlayerSetup( &(game->player) );
+	// Build the Animation table
+	AnimationsInit( game );
+
+	// Set Up Player Objects, Player 0 is always in the game
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+		PlayerSetup( game, &(game->players[p]), p );
 
-	if ( game->player.sprite_texture == nullptr )
+	game->players[0].joined = true;
+	PlayerSpawn( game, &(game->players[0]) );
+
+	if ( game->players[0].sprite_texture == nullptr )
 		printf( "Error: Player Texture was not correctly Assigned\n" );
 
+	// Start the Timers
+	TimerWheelInit( &(game->timers) );
+
+	// Build the Enemy Types
+	EnemyArchetypesInit( game );
+
 	// Set Up Enemies
 	for( Uint16 i = 0; i < POOLSIZE_ENEMY; i++ )
 	{
-        game->enemies[i].runner = game;
-        EnemyInit( &(game->enemies[i]) );
+        EnemyInit( game, &(game->enemies[i]), &(game->enemies_cold[i]) );
 	}
 
-	// Setup Particles
-	for( Uint16 i = 0; i < POOLSIZE_PARTICLE; i++ )
-	{
-		game->particles[i].runner = game;
-		ParticleInit( &(game->particles[i]) );
-	}
+	// Setup Particles (Not having particles isn't an error)
+	ParticleSystemInit( game, &(game->particles), particle_capacity );
 
 	// Setup Projectiles
 	for( Uint16 i = 0;
@@ -136,25 +158,55 @@ void 			GameSetup( Game* game )
 		// Friendly Projectiles
 		if ( i < POOLSIZE_FRIENDLY_PROJ )
 		{
-			game->projectiles_friendly[i].runner = game;
-			ProjectileInit( &(game->projectiles_friendly[i]) );
+			ProjectileInit( game, &(game->projectiles_friendly[i]), &(game->projectiles_friendly_cold[i]) );
 		}
 
 		// Enemy Projectiles
 		if ( i < POOLSIZE_ENEMY_PROJ )
 		{
-			game->projectiles_enemy[i].runner = game;
-			ProjectileInit( &(game->projectiles_enemy[i]) );
+			ProjectileInit( game, &(game->projectiles_enemy[i]), &(game->projectiles_enemy_cold[i]) );
 		}
 	}
 }
 
+/*
+	Game Setup Headless
+
+	Purpose: Sets up a game without a window, renderer
+			or loaded assets, for the server, gym and
+			benchmarks. The assets objects look for are
+			only named, and nothing is drawn.
+
+	Parameters: Game - a pointer to the Game object
+					to set up.
+				Particle Capacity - the most particles
+					the game can hold at once
+
+	Return:	True if its frame memory was allocated
+*/
+
+bool 			GameSetupHeadless( Game* game, Uint32 particle_capacity )
+{
+	// Named assets, so objects can find their textures
+	TextureInit( &(game->texture_assets[0]), "Primary" );
+	TextureInit( &(game->texture_assets[1]), "Background" );
+	game->texture_assets[1].width = 32;
+	game->texture_assets[1].height = 32;
+
+	if ( !ArenaInit( &(game->frame_arena), FRAME_ARENA_SIZE ) )
+		return false;
+
+	GameSetup( game, particle_capacity );
+	return true;
+}
+
 /*
 	Game Reset
 
 	Purpose: Used to reset the state of the game to
 			it's initial state. Used when after the
-			player is killed.
+			last player is killed. Players that have
+			joined stay in the game.
 
 	Parameters: Game - a pointer to the Game object
 					running the game.
@@ -169,7 +221,10 @@ void 			GameReset( Game* game )
 
 	// Switch off needing a reset
 	game->needs_reset 					= false;
-	game->next_reset					= 0;
+
+	// Drop all Scheduled Timers and Events
+	TimerWheelClear( &(game->timers) );
+	game->events.count = 0;
 
 	// Set High Score
 	if (game->score > game->high_score)
@@ -178,23 +233,22 @@ void 			GameReset( Game* game )
 	// Reset Score
 	GameScoreSet( game, 0 );
 
-	// Reset Player to Default State
-    game->player.pos 					= Vector2D( SCREEN_WIDTH*0.5, SCREEN_HEIGHT*0.5 );
-    game->player.vel.zero();
-
-	game->player.alive 					= true;
-	game->player.hp 					= 100;
-	game->player.hp_max 				= 100;
+	// Reset Players to Default State
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+		PlayerSpawn( game, &(game->players[p]) );
 
 	// Reset all enemies
 	game->enemy_count = 0;
+	for( Uint16 i = 0; i < enemy_behaviour_count; i++ )
+		game->enemy_behaviour_end[i] = 0;
 	for( Uint16 i = 0; i < POOLSIZE_ENEMY; i++ )
+	{
 		game->enemies[i].alive = false;
+		game->enemies_cold[i].fire_timer = TIMER_NONE;
+	}
 
 	// Reset all particles
-	game->part_count = 0;
-	for( Uint16 i = 0; i < POOLSIZE_PARTICLE; i++ )
-		game->particles[i].alive = false;
+	ParticleSystemClear( &(game->particles) );
 
 	// Reset all Projectiles
 	game->proj_enemy_count = 0;
@@ -213,6 +267,33 @@ void 			GameReset( Game* game )
 	}
 }
 
+/*
+	Game Reset Timer
+
+	Purpose: <Timer Callback>
+			 Scheduled when the last player dies, so the game
+			 resets a short time later. Someone may have
+			 joined since, so only resets if nobody is
+			 still flying.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Target - unused
+
+	Return:	Nil
+*/
+
+void 			GameResetTimer( Game* game, Uint16 target )
+{
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+	{
+		if ( game->players[p].joined && game->players[p].alive )
+			return;
+	}
+
+	game->needs_reset = true;
+}
+
 /*
 	Game Start Play
 
@@ -249,6 +330,27 @@ void 			GameStartPlay( Game* game )
 
 void 			GameQuit( Game* game )
 {
+	// Free Frame Memory
+	ArenaPrintStats( &(game->frame_arena), "Frame Arena" );
+	ArenaFree( &(game->frame_arena) );
+
+	// Free Particles
+	if ( game->particles.dropped > 0 )
+		printf( "Particles: %u dropped over budget\n", game->particles.dropped );
+	ParticleSystemFree( &(game->particles) );
+
+	// Free Rewind Memory
+	RewindPrintStats( &(game->rewind) );
+	RewindFree( &(game->rewind) );
+
+	// Close Game Controllers
+	for( Uint16 c = 0; c < CONTROLLER_COUNT; c++ )
+	{
+		if ( game->controllers[c] != nullptr )
+			SDL_GameControllerClose( game->controllers[c] );
+		game->controllers[c] = nullptr;
+	}
+
 	// Unload SDL and Extensions
 	TTF_Quit();
 	IMG_Quit();
@@ -270,7 +372,7 @@ void 			GameQuit( Game* game )
 bool 			GameLoadAssets( Game* game )
 {
 	// Load Game Font
-	game->game_font = TTF_OpenFont( "Data/Fonts/kenvector_future_thin.ttf", 16 );
+	game->game_font = TTF_OpenFont( GAME_FONT_FILE, GAME_FONT_SIZE );
 	if ( game->game_font == 0 || game->game_font == nullptr )
 		return false;
 
@@ -282,24 +384,25 @@ bool 			GameLoadAssets( Game* game )
 							  "Press Enter to Start", game->game_font, text_color ))
 		return false;
 
-	// Load Score Text Textures
-	if ( !TextureInit( &(game->score_text_font), "Score Text" ) )
-		return false;
-	if ( !TextureInit( &(game->highscore_text_font), "H-Score Text" ) )
+	// Load Score Digit Textures
+	if ( !GameLoadDigits( game ) )
 		return false;
 
 	// Primary Texture
 	if ( !TextureInit( &(game->texture_assets[0]), "Primary" ) )
 		return false;
-	if ( !TextureLoadFile( &(game->texture_assets[0]), game->render, "Data/Images/Primary.png" ) )
+	if ( !TextureLoadFile( &(game->texture_assets[0]), game->render, TEXTURE_PRIMARY_FILE ) )
 		return false;
 
 	// Background Texture
 	if ( !TextureInit( &(game->texture_assets[1]), "Background" ) )
 		return false;
-	if ( !TextureLoadFile( &(game->texture_assets[1]), game->render, "Data/Images/Background.png" ) )
+	if ( !TextureLoadFile( &(game->texture_assets[1]), game->render, TEXTURE_BACKGROUND_FILE ) )
 		return false;
 
+	// Watch for Changed Assets (Not having a watcher isn't an error)
+	HotReloadStart( game );
+
 	//Return Success
 	return true;
 }
@@ -317,8 +420,13 @@ bool 			GameLoadAssets( Game* game )
 
 void 			GameFreeAssets( Game* game )
 {
+	// Stop Watching for Changes
+	HotReloadStop( game );
+
 	// Unload Font and Text Textures
 	TextureFree( &game->game_start_text );
+	for( Uint16 i = 0; i < 10; i++ )
+		TextureFree( &(game->digit_textures[i]) );
 	TTF_CloseFont(game->game_font);
 
 	// Free Textures
@@ -329,6 +437,43 @@ void 			GameFreeAssets( Game* game )
 	}
 }
 
+/*
+	Game Load Digits
+
+	Purpose: Renders a texture for each digit with the
+			game font. Numbers are drawn from these, so
+			changing the score never has to create a
+			new texture mid-game.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Whether or not loading was successful.
+			<Boolean>
+*/
+
+bool 			GameLoadDigits( Game* game )
+{
+	SDL_Color text_color = {255,255,255,255};
+	char digit[2] = "0";
+
+	for( Uint16 i = 0; i < 10; i++ )
+	{
+		if ( game->digit_textures[i].name == nullptr )
+		{
+			if ( !TextureInit( &(game->digit_textures[i]), "Digit" ) )
+				return false;
+		}
+
+		digit[0] = '0' + i;
+		if ( !TextureLoadFromText( &(game->digit_textures[i]), game->render,
+								   digit, game->game_font, text_color ) )
+			return false;
+	}
+
+	return true;
+}
+
 /*
 	Game Find Texture
 
@@ -412,6 +557,55 @@ void 			GameBackgroundRender( Game* game )
 
 }
 
+/*
+	Game Swap Enemies
+
+	Purpose: Swaps two enemies in the pool, and points
+			their timers at their new slots.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				A - the first slot
+				B - the second slot
+
+	Return:	Nil
+*/
+
+static void 	GameSwapEnemies( Game* game, Uint16 a, Uint16 b )
+{
+	EnemySwap( &(game->enemies[a]), &(game->enemies_cold[a]),
+			   &(game->enemies[b]), &(game->enemies_cold[b]) );
+
+	TimerRetarget( &(game->timers), game->enemies_cold[a].fire_timer, a );
+	TimerRetarget( &(game->timers), game->enemies_cold[b].fire_timer, b );
+}
+
+/*
+	Game Random
+
+	Purpose: The game's random number generator. The
+			state is kept in the Game, rather than using
+			rand(), so it can be saved and restored with
+			the rest of the game.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	A random value
+*/
+
+Uint32 			GameRandom( Game* game )
+{
+	// Xorshift
+	Uint32 x = game->random_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	game->random_state = x;
+
+	return x;
+}
+
 /*
 	Game Input
 
@@ -434,17 +628,33 @@ void 			GameSpawnRandomEnemy( Game* game )
 
 	// Do Random Chance Check
 	Uint32 chance = ENEMY_SPAWN_CHANCE + ENEMY_SPAWN_CHANCE*0.1;
-	if ( rand()%chance != 0 )
+	if ( GameRandom(game)%chance != 0 )
 		return;
 
 	// Choose Random Type
-	EnemyType type = (EnemyType)(rand()%enemy_type_count);
+	EnemyType type = (EnemyType)(GameRandom(game)%game->enemy_archetype_count);
 
-	// Spawn Random Enemy
-    EnemySetup( &(game->enemies[game->enemy_count]), type );
+	// Spawn Random Enemy at the end of the pool
+	Uint16 slot = game->enemy_count;
+    if ( !EnemySetup( game, &(game->enemies[slot]), &(game->enemies_cold[slot]), type ) )
+		return;
 
     // Increment Enemy Count
     ++game->enemy_count;
+
+	// Move it down into its behaviour's group. Each later group
+	// gives its first enemy to the free slot at its end, and moves
+	// up by one.
+	EnemyBehaviour behaviour = game->enemies[slot].behaviour;
+	for( Uint16 b = enemy_behaviour_count-1; b > behaviour; b-- )
+	{
+		Uint16 first = game->enemy_behaviour_end[b-1];
+		GameSwapEnemies( game, first, slot );
+
+		++game->enemy_behaviour_end[b];
+		slot = first;
+	}
+	++game->enemy_behaviour_end[behaviour];
 }
 
 /*
@@ -464,11 +674,24 @@ void 			GameSpawnRandomEnemy( Game* game )
 
 void 			GameKillEnemy( Game* game, Enemy* enemy )
 {
-	// Set Enemy to Dead
+	Uint16 slot = enemy - game->enemies;
+
+	// Set Enemy to Dead, and stop its shots
 	enemy->alive = false;
 
-	// Swap with the last enemy we have alive
-	EnemySwap( enemy, &(game->enemies[game->enemy_count-1]) );
+	TimerCancel( &(game->timers), game->enemies_cold[slot].fire_timer );
+	game->enemies_cold[slot].fire_timer = TIMER_NONE;
+
+	// Swap with the last enemy of its behaviour, then pass the
+	// dead slot along each later group, to the end of the pool
+	for( Uint16 b = enemy->behaviour; b < enemy_behaviour_count; b++ )
+	{
+		Uint16 last = game->enemy_behaviour_end[b]-1;
+		GameSwapEnemies( game, slot, last );
+
+		--game->enemy_behaviour_end[b];
+		slot = last;
+	}
 
 	// Decrement the Enenmy Count
 	--(game->enemy_count);
@@ -477,8 +700,8 @@ void 			GameKillEnemy( Game* game, Enemy* enemy )
 /*
 	Game Spawn Particle
 
-	Purpose: Spawns a new particle from the particle
-			pool.
+	Purpose: Spawns a burst of particles from the
+			particle system.
 
 	Parameters: Game - a pointer to the Game object
 					running the game.
@@ -490,37 +713,7 @@ void 			GameKillEnemy( Game* game, Enemy* enemy )
 
 void 			GameSpawnParticle( Game* game, const Vector2D& pos, PartType type )
 {
-	// Check we haven't reached the limit
-    if (game->part_count >= POOLSIZE_PARTICLE)
-		return;
-
-	// Spawn Particle
-	ParticleSpawn( &(game->particles[game->part_count++]), pos, type );
-}
-
-/*
-	Game Kill Particle
-
-	Purpose: Kills a specified particle in the memory
-			pool.
-
-	Parameters: Game - a pointer to the Game object
-					running the game.
-				Part - a pointer to the dead particle
-
-	Return:	Nil
-*/
-
-void 			GameKillParticle( Game* game, Particle* part )
-{
-	// Set Particle to Dead
-    part->alive = false;
-
-    // Swap with last particle we have alive
-    ParticleSwap( part, &(game->particles[game->part_count-1]) );
-
-    // Decrement Particle Count
-    --(game->part_count);
+	ParticleEmit( &(game->particles), pos, type );
 }
 
 /*
@@ -557,6 +750,10 @@ Projectile*		GameSpawnProjectile( Game* game, bool friendly, const Vector2D& pos
 	proj->friendly = friendly;
 	ProjectileSpawn( proj, pos, vel );
 
+	// Enemy Projectiles follow a path, straight by default
+	if ( !friendly )
+		BulletPathStart( game, (Uint16)(proj - proj_array), pos, vel, 0 );
+
 	// Return new projectile
 	return proj;
 }
@@ -578,13 +775,20 @@ void 			GameKillProjectile( Game* game, Projectile* proj )
 {
 	// Find where we are storing the projectile
 	Projectile*		proj_array = ( proj->friendly ? game->projectiles_friendly : game->projectiles_enemy );
+	ProjectileCold*	cold_array = ( proj->friendly ? game->projectiles_friendly_cold : game->projectiles_enemy_cold );
 	Uint16&			proj_count = ( proj->friendly ? game->proj_friendly_count : game->proj_enemy_count );
 
+	Uint16 index = proj - proj_array;
+	Uint16 last = proj_count-1;
+
 	// Set Projectile to Dead
     proj->alive = false;
 
     // Swap with last projectile we have alive
-    ProjectileSwap( proj, &(proj_array[proj_count-1]) );
+    ProjectileSwap( proj, &(cold_array[index]), &(proj_array[last]), &(cold_array[last]) );
+
+	if ( !proj->friendly )
+		BulletPathCopy( &(game->bullet_paths), index, last );
 
     // Decrement Projectile Count
     --proj_count;
@@ -593,8 +797,10 @@ void 			GameKillProjectile( Game* game, Projectile* proj )
 /*
 	Game Score Set
 
-	Purpose: Sets the value of the current score, and
-			refreshes the text texture drawing the score.
+	Purpose: Sets the value of the current score.
+			The HUD draws the score from the digit
+			textures each frame, so nothing needs to
+			be refreshed here.
 
 	Parameters: Game - a pointer to the Game object
 					running the game.
@@ -605,25 +811,13 @@ void 			GameKillProjectile( Game* game, Projectile* proj )
 
 void 			GameScoreSet( Game* game, Uint32 value )
 {
-	if (game->score == value)
-		return;
-
 	game->score = value;
-
-	// Convert Score to String
-	sprintf( game->score_text, "%d", game->score );
-
-	// Refresh Score Text Texture
-	SDL_Color text_color = {255,255,255,255};
-	TextureLoadFromText( &(game->score_text_font), game->render,
-						 game->score_text, game->game_font, text_color );
 }
 
 /*
 	Game Score Add
 
-	Purpose: Adds the value to the current score, and
-			refreshes the text texture drawing the score.
+	Purpose: Adds the value to the current score.
 
 	Parameters: Game - a pointer to the Game object
 					running the game.
@@ -634,23 +828,13 @@ void 			GameScoreSet( Game* game, Uint32 value )
 
 void 			GameScoreAdd( Game* game, Uint32 value )
 {
-	// Set Score
 	game->score += value;
-
-	// Convert Score to String
-	sprintf( game->score_text, "%d", game->score );
-
-	// Refresh Score Text Texture
-	SDL_Color text_color = {255,255,255,255};
-	TextureLoadFromText( &(game->score_text_font), game->render,
-						 game->score_text, game->game_font, text_color );
 }
 
 /*
 	Game High Score Set
 
-	Purpose: Sets the value of the high score, and
-			refreshes the text texture drawing the score.
+	Purpose: Sets the value of the high score.
 
 	Parameters: Game - a pointer to the Game object
 					running the game.
@@ -662,14 +846,35 @@ void 			GameScoreAdd( Game* game, Uint32 value )
 void 			GameHighScoreSet( Game* game, Uint32 value )
 {
 	game->high_score = value;
+}
+
+/*
+	Game Render Number
 
-	// Convert Score to String
-	sprintf( game->highscore_text, "%d", game->high_score );
+	Purpose: Draws a number using the digit textures.
+			The text is formatted into the frame arena,
+			so drawing it never touches the heap.
 
-	// Refresh Score Text Texture
-	SDL_Color text_color = {255,255,255,255};
-	TextureLoadFromText( &(game->highscore_text_font), game->render,
-						 game->highscore_text, game->game_font, text_color );
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Value - the number to draw
+				X - the x position of the first digit
+				Y - the y position of the digits
+
+	Return:	Nil
+*/
+
+void 			GameRenderNumber( Game* game, Uint32 value, int x, int y )
+{
+	const char* text = ArenaPrintf( &(game->frame_arena), "%u", value );
+
+	for( const char* c = text; *c != '\0'; c++ )
+	{
+		AssetTexture* digit = &(game->digit_textures[*c - '0']);
+
+		TextureRender( digit, game->render, x, y );
+		x += digit->width;
+	}
 }
 
 /*
@@ -690,18 +895,21 @@ void 			GameRenderHud( Game* game )
 	// HUD While Playing
 	if (game->playing == true)
 	{
-		// Render Player Health Bar
-		if (game->player.hp > 0)
+		// Render Player Health Bars, one under another
+		for( Uint16 p = 0; p < PLAYER_MAX; p++ )
 		{
-			float bar_length = (float)game->player.hp / (float)game->player.hp_max * 150.0f;
-			SDL_Rect bar = { 32, 32, (int)bar_length, 4 };
+			Player* player = &(game->players[p]);
+			if ( !player->joined || player->hp <= 0 )
+				continue;
+
+			float bar_length = (float)player->hp / (float)player->hp_max * 150.0f;
+			SDL_Rect bar = { 32, 32 + p*8, (int)bar_length, 4 };
 			SDL_SetRenderDrawColor( game->render, 0xFF, 0x00, 0x00, 0xFF );
 			SDL_RenderFillRect( game->render, &bar );
 		}
 
 		// Render Current Score
-		TextureRender( &(game->score_text_font), game->render,
-						32, SCREEN_HEIGHT-64 );
+		GameRenderNumber( game, game->score, 32, SCREEN_HEIGHT-64 );
 	}
 	else
 	// HUD While Waiting
@@ -712,9 +920,12 @@ void 			GameRenderHud( Game* game )
 						   SCREEN_HEIGHT/2+64 );
 
 		// Render High Score
-		TextureRender( &(game->highscore_text_font), game->render,
-						32, SCREEN_HEIGHT-64 );
+		GameRenderNumber( game, game->high_score, 32, SCREEN_HEIGHT-64 );
 	}
+
+	// Render how many Ticks back we are, while Rewinding
+	if (game->rewind.active == true)
+		GameRenderNumber( game, game->rewind.head - game->rewind.cursor, SCREEN_WIDTH-128, 32 );
 }
 
 /*
@@ -739,6 +950,12 @@ void 			GameLoop( Game* game )
 	// Using a semi-fixed timestep
 	while(game->running)
 	{
+		// Release last frame's scratch memory
+		ArenaReset( &(game->frame_arena) );
+
+		// Swap in any changed assets between frames
+		HotReloadApply(game);
+
 		Uint32 new_time = SDL_GetTicks();
 		Uint32 diff_time = new_time - frame_time;
 
@@ -747,30 +964,135 @@ void 			GameLoop( Game* game )
 
 		while( acc > time_per_frame )
 		{
-			// Check for Reset Game
-			if (game->needs_reset && new_time >= game->next_reset)
-				GameReset(game);
-
 			// Process Events
+			AllocTrackPhase( ALLOC_PHASE_INPUT );
 			GameInput(game);
 
-			// Update Game
-			GameUpdate(game, time_per_frame);
+			// Update Game, over the Network, or unless we are scrubbing back through it
+			AllocTrackPhase( ALLOC_PHASE_UPDATE );
+			if ( game->rollback.socket >= 0 )
+				RollbackAdvance( game, game->inputs[0], SDL_GetTicks() );
+			else if ( !RewindInput(game) )
+			{
+				RewindRecord( game, game->inputs );
+				GameTick( game, game->inputs, time_per_frame );
+				ReplayRecordTick( game, game->inputs );
+			}
+			AllocTrackPhase( ALLOC_PHASE_NONE );
+
+			// The next frame captured stands for this step
+			CaptureTick(game);
 
 			// Fix Timestep
 			acc -= time_per_frame;
 		}
 
 		// Render Game
+		AllocTrackPhase( ALLOC_PHASE_RENDER );
 		GameRender(game);
+		AllocTrackPhase( ALLOC_PHASE_NONE );
 	}
+
+	// Print where the heap was used (Instrumented Builds Only)
+	AllocTrackReport();
+}
+
+/*
+	Game Controller Open
+
+	Purpose: Opens a game controller that has been
+			plugged in, into the first free slot. The
+			slot is the player it flies. Controllers
+			past CONTROLLER_COUNT are ignored.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Device - the SDL joystick device index
+
+	Return:	Nil
+*/
+
+void 			GameControllerOpen( Game* game, int device )
+{
+	if ( !SDL_IsGameController( device ) )
+		return;
+
+	for( Uint16 c = 0; c < CONTROLLER_COUNT; c++ )
+	{
+		if ( game->controllers[c] != nullptr )
+			continue;
+
+		game->controllers[c] = SDL_GameControllerOpen( device );
+		if ( game->controllers[c] == nullptr )
+			printf( "Error: Unable to open controller %d. SDL Error: %s\n", device, SDL_GetError() );
+		else
+			printf( "Controller %s flies player %u\n", SDL_GameControllerName( game->controllers[c] ), c );
+		return;
+	}
+}
+
+/*
+	Game Controller Close
+
+	Purpose: Closes a game controller that has been
+			unplugged, freeing its slot.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				ID - the SDL joystick instance id
+
+	Return:	Nil
+*/
+
+void 			GameControllerClose( Game* game, SDL_JoystickID id )
+{
+	for( Uint16 c = 0; c < CONTROLLER_COUNT; c++ )
+	{
+		SDL_GameController* pad = game->controllers[c];
+		if ( pad == nullptr || SDL_JoystickInstanceID( SDL_GameControllerGetJoystick( pad ) ) != id )
+			continue;
+
+		SDL_GameControllerClose( pad );
+		game->controllers[c] = nullptr;
+	}
+}
+
+/*
+	Game Controller Buttons
+
+	Purpose: Reads the InputButtons held on a game
+			controller. The d-pad and left stick move,
+			A shoots and Start starts.
+
+	Parameters: Pad - the controller
+
+	Return:	The InputButtons held
+*/
+
+static Uint8 	GameControllerButtons( SDL_GameController* pad )
+{
+	Uint8 input = 0;
+
+	Sint16 axis_x = SDL_GameControllerGetAxis( pad, SDL_CONTROLLER_AXIS_LEFTX );
+	Sint16 axis_y = SDL_GameControllerGetAxis( pad, SDL_CONTROLLER_AXIS_LEFTY );
+
+	if ( SDL_GameControllerGetButton( pad, SDL_CONTROLLER_BUTTON_DPAD_UP ) || axis_y < -CONTROLLER_DEAD_ZONE )		input |= INPUT_UP;
+	if ( SDL_GameControllerGetButton( pad, SDL_CONTROLLER_BUTTON_DPAD_DOWN ) || axis_y > CONTROLLER_DEAD_ZONE )		input |= INPUT_DOWN;
+	if ( SDL_GameControllerGetButton( pad, SDL_CONTROLLER_BUTTON_DPAD_LEFT ) || axis_x < -CONTROLLER_DEAD_ZONE )	input |= INPUT_LEFT;
+	if ( SDL_GameControllerGetButton( pad, SDL_CONTROLLER_BUTTON_DPAD_RIGHT ) || axis_x > CONTROLLER_DEAD_ZONE )	input |= INPUT_RIGHT;
+	if ( SDL_GameControllerGetButton( pad, SDL_CONTROLLER_BUTTON_A ) )		input |= INPUT_SHOOT;
+	if ( SDL_GameControllerGetButton( pad, SDL_CONTROLLER_BUTTON_START ) )	input |= INPUT_START;
+
+	return input;
 }
 
 /*
 	Game Input
 
 	Purpose: Updates input devices and processes
-			incoming events
+			incoming events. The keyboard flies player
+			0, and each game controller the player in
+			its slot.
 
 	Parameters: Game - a pointer to the Game object
 					running the game.
@@ -785,6 +1107,10 @@ void 			GameInput( Game* game )
 	{
 		if (game->event.type == SDL_QUIT)
 			game->running = false;				// Exit Program
+		else if (game->event.type == SDL_CONTROLLERDEVICEADDED)
+			GameControllerOpen( game, game->event.cdevice.which );
+		else if (game->event.type == SDL_CONTROLLERDEVICEREMOVED)
+			GameControllerClose( game, game->event.cdevice.which );
 	}
 
 	game->key_states = SDL_GetKeyboardState(0);
@@ -793,15 +1119,74 @@ void 			GameInput( Game* game )
 	if (game->key_states[SDL_SCANCODE_ESCAPE] > 0)
 		game->running = false;
 
+	// Gather the Buttons for the next tick
+	Uint8 input = 0;
+
+	if (game->key_states[SDL_SCANCODE_UP] > 0)		input |= INPUT_UP;
+	if (game->key_states[SDL_SCANCODE_DOWN] > 0)	input |= INPUT_DOWN;
+	if (game->key_states[SDL_SCANCODE_LEFT] > 0)	input |= INPUT_LEFT;
+	if (game->key_states[SDL_SCANCODE_RIGHT] > 0)	input |= INPUT_RIGHT;
+	if (game->key_states[SDL_SCANCODE_SPACE] > 0)	input |= INPUT_SHOOT;
+	if (game->key_states[SDL_SCANCODE_RETURN] > 0)	input |= INPUT_START;
+
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+		game->inputs[p] = ( p == 0 ? input : 0 );
+
+	for( Uint16 c = 0; c < CONTROLLER_COUNT; c++ )
+	{
+		if ( game->controllers[c] != nullptr )
+			game->inputs[c % PLAYER_MAX] |= GameControllerButtons( game->controllers[c] );
+	}
+}
+
+/*
+	Game Tick
+
+	Purpose: Runs one sim tick with the buttons given.
+			Everything a tick does depends only on the
+			game state and these buttons, so a tick can
+			be run again from a snapshot. Any player
+			pressing start begins the game, and a player
+			that isn't in it yet joins.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Inputs - the InputButtons held down,
+					PLAYER_MAX of them, by player
+				dt - Delta time, the time that has
+					passed since the last update.
+
+	Return:	Nil
+*/
+
+void 			GameTick( Game* game, const Uint8* inputs, Uint32 dt )
+{
+	// Check for Reset Game
+	if (game->needs_reset)
+		GameReset(game);
+
+	Uint8 held = 0;
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+		held |= inputs[p];
+
 	// Check for Begin Play if we haven't already started
-	if ( !game->playing && game->key_states[SDL_SCANCODE_RETURN] > 0 )
+	if ( !game->playing && (held & INPUT_START) )
 		GameStartPlay(game);
 
-	game->key_up 	= (game->key_states[SDL_SCANCODE_UP] > 0);
-	game->key_down 	= (game->key_states[SDL_SCANCODE_DOWN] > 0);
-	game->key_left 	= (game->key_states[SDL_SCANCODE_LEFT] > 0);
-	game->key_right	= (game->key_states[SDL_SCANCODE_RIGHT] > 0);
-	game->key_shoot	= (game->key_states[SDL_SCANCODE_SPACE] > 0);
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+	{
+		Player* player = &(game->players[p]);
+		player->buttons = inputs[p];
+
+		// Join a game in progress
+		if ( game->playing && !player->joined && (inputs[p] & INPUT_START) )
+		{
+			player->joined = true;
+			PlayerSpawn( game, player );
+		}
+	}
+
+	GameUpdate( game, dt );
 }
 
 /*
@@ -826,18 +1211,25 @@ void 			GameUpdate( Game* game, Uint32 dt )
 	if (game->playing == false)
 		return;
 
+	// Fire any Timers due this tick
+	TimerWheelAdvance( game );
+
 	// Randomly Spawn Enemies
 	if ( game->enemy_count < POOLSIZE_ENEMY )
 		GameSpawnRandomEnemy(game);
 
-	// Update Player
-	PlayerUpdate( &(game->player), dt );
+	// Update Players
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+		PlayerUpdate( game, &(game->players[p]), dt );
 
 	// Update Enemies
+	if ( game->batch_enemy_updates )
+		EnemyUpdateBatched( game, dt );
+	else
 	for( Sint32 i = 0; i < game->enemy_count; i++ )
 	{
 		// Check if the enemy is dead after it's update
-		if ( !game->enemies[i].update( &(game->enemies[i]), dt ) )
+		if ( !game->enemies[i].update( game, &(game->enemies[i]), &(game->enemies_cold[i]), dt ) )
 		{
 			GameKillEnemy( game, &(game->enemies[i]) );
 			--i;
@@ -845,15 +1237,7 @@ void 			GameUpdate( Game* game, Uint32 dt )
 	}
 
 	// Update Particles
-	for( Sint32 i = 0; i < game->part_count; i++ )
-	{
-		// Check if the particle is dead after it's update
-		if ( !ParticleUpdate(&(game->particles[i]), dt) )
-		{
-			GameKillParticle( game, &(game->particles[i]) );
-			--i;
-		}
-	}
+	ParticleSystemUpdate( &(game->particles) );
 
 	// Friendly Projectiles
 	for( Uint16 i = 0; i < game->proj_friendly_count; i++ )
@@ -865,15 +1249,17 @@ void 			GameUpdate( Game* game, Uint32 dt )
 		}
 	}
 
-	// Enemy Projectiles
-	for( Uint16 i = 0; i < game->proj_enemy_count; i++ )
-	{
-		if ( !ProjectileUpdate( &(game->projectiles_enemy[i]), dt ) )
-		{
-			GameKillProjectile( game, &(game->projectiles_enemy[i]) );
-			--i;
-		}
-	}
+	// Enemy Projectiles, placed along their paths
+	BulletPathsUpdate( game );
+
+	// Step every Animation once, so rendering only reads them
+	AnimationStepAll( game );
+
+	// Now everything has moved, check for collisions
+	GameCollide( game );
+
+	// Apply this tick's kills, spawns and score
+	GameEventDrain( game );
 }
 
 /*
@@ -899,27 +1285,30 @@ void 			GameRender( Game* game )
 		GameBackgroundRender(game);
 
 		// Draw Particles
-		for( Uint16 i = 0; i < game->part_count; i++ )
-			ParticleRender( &(game->particles[i]) );
+		ParticleSystemRender( game, &(game->particles) );
 
 		// Freindly Projectiles
 		for( Uint16 i = 0; i < game->proj_friendly_count; i++ )
-			ProjectileRender( &(game->projectiles_friendly[i]) );
+			ProjectileRender( game, &(game->projectiles_friendly[i]), &(game->projectiles_friendly_cold[i]) );
 
 		// Enemy Projectiles
 		for( Uint16 i = 0; i < game->proj_enemy_count; i++ )
-			ProjectileRender( &(game->projectiles_enemy[i]) );
+			ProjectileRender( game, &(game->projectiles_enemy[i]), &(game->projectiles_enemy_cold[i]) );
 
 		// Draw Enemies
 		for( Uint16 i = 0; i < game->enemy_count; i++ )
-			EnemyRender( &(game->enemies[i]) );
+			EnemyRender( game, &(game->enemies[i]), &(game->enemies_cold[i]) );
 
-		// Draw Player
-		PlayerRender( &(game->player) );
+		// Draw Players
+		for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+			PlayerRender( game, &(game->players[p]) );
 
 		// Draw Heads-Up Display
 		GameRenderHud(game);
 
+	// Grab the Frame, while Capturing
+	CaptureFrame(game);
+
 	// Draw to the Screen
     SDL_RenderPresent( game->render );
 }
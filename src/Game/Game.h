@@ -5,6 +5,8 @@
 // Inlcudes											//
 //////////////////////////////////////////////////////
 
+#include <stdio.h>
+
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_ttf.h>
@@ -20,15 +22,120 @@
 #define SCREEN_HEIGHT 480
 
 #define TEXTURE_COUNT 2
+#define TEXTURE_PRIMARY_FILE "Data/Images/Primary.png"
+#define TEXTURE_BACKGROUND_FILE "Data/Images/Background.png"
 
 #define POOLSIZE_ENEMY 20
-#define POOLSIZE_PARTICLE 20
 #define POOLSIZE_FRIENDLY_PROJ 10
-#define POOLSIZE_ENEMY_PROJ 40
+#define POOLSIZE_ENEMY_PROJ 2048
+
+#define PARTICLE_CAPACITY (64*1024)
+#define PARTICLE_BUDGET (64*1024)
 
 #define ENEMY_SPAWN_CHANCE 60
 
-#define CONTROLLER_COUNT 1
+#define ENEMY_ARCHETYPE_MAX 64
+#define ENEMY_ARCHETYPE_FILE "Data/Enemies.txt"
+
+// Players that can be in a game at once. Game controller N
+// flies player N, and the keyboard flies player 0 as well
+#define PLAYER_MAX 4
+#define CONTROLLER_COUNT PLAYER_MAX
+#define CONTROLLER_DEAD_ZONE 8000
+
+#define GAME_FONT_FILE "Data/Fonts/kenvector_future_thin.ttf"
+#define GAME_FONT_SIZE 16
+
+#define FRAME_ARENA_SIZE (128*1024)
+
+// Words of hit bits needed for a batch of boxes
+#define AABB_HIT_WORDS(count) (((count)+31)/32)
+
+#define GAME_EVENT_QUEUE_SIZE 512
+// Event targets from here up are players, by index
+#define GAME_EVENT_TARGET_PLAYER 0xFF00
+
+#define TIMER_CAPACITY 64
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_NONE 0xFFFF
+
+// Converts milliseconds to whole sim ticks, rounding up
+#define TIMER_MS_TO_TICKS(ms) (((ms) * FPS + 999) / 1000)
+
+// Longest a bullet can live, for ones that never leave the screen
+#define BULLET_LIFE_MAX (60*FPS)
+
+#define ANIMATION_MAX 96
+#define ANIMATION_FRAME_MAX 256
+
+// Animation positions are 16.16 fixed point frames
+#define ANIMATION_ONE (1 << 16)
+
+// "JFSN", and the layout version. Bump the version whenever
+// the snapshot layout changes
+#define GAME_SNAPSHOT_MAGIC 0x4E53464A
+#define GAME_SNAPSHOT_VERSION 3
+
+// Rewind keeps the last REWIND_SECONDS of play, as a snapshot
+// every REWIND_KEYFRAME_TICKS and the input of every tick, in
+// REWIND_MEMORY bytes set aside at startup
+#define REWIND_SECONDS 10
+#define REWIND_TICKS (REWIND_SECONDS*FPS)
+#define REWIND_KEYFRAME_TICKS (FPS/2)
+#define REWIND_KEYFRAME_MAX (REWIND_TICKS/REWIND_KEYFRAME_TICKS + 1)
+#define REWIND_MEMORY (8*1024*1024)
+
+// Rollback networking. Remote input is guessed for up to
+// ROLLBACK_MAX_FRAMES ticks, then corrected when it arrives
+#define ROLLBACK_PLAYERS 2
+#define ROLLBACK_MAX_FRAMES 8
+#define ROLLBACK_HISTORY 64
+#define ROLLBACK_SNAPSHOTS (ROLLBACK_MAX_FRAMES + 2)
+#define ROLLBACK_SNAPSHOT_MAX (512*1024)
+#define ROLLBACK_PACKET_INPUTS 32
+#define ROLLBACK_PACKET_MAX 96
+#define ROLLBACK_DELAY_QUEUE 256
+#define ROLLBACK_FRAME_NONE 0xFFFFFFFF
+
+// "JN", marks rollback packets
+#define ROLLBACK_PACKET_MAGIC 0x4E4A
+
+// Net states quantize positions to 1/NET_POS_SCALE of a pixel,
+// from NET_POS_OFFSET off screen, and velocities to
+// 1/NET_VEL_SCALE of a pixel per tick
+#define NET_POS_BITS 14
+#define NET_POS_SCALE 8
+#define NET_POS_OFFSET 512
+#define NET_VEL_BITS 12
+#define NET_VEL_SCALE 64
+
+// Changes that fit NET_DELTA_BITS (zigzagged) are sent as the
+// change, others as the whole value
+#define NET_DELTA_BITS 6
+
+#define NET_STATE_HISTORY 16
+#define NET_STATE_BYTES_MAX (16*1024)
+#define NET_ENTITY_MAX (PLAYER_MAX + POOLSIZE_ENEMY + POOLSIZE_FRIENDLY_PROJ + POOLSIZE_ENEMY_PROJ)
+#define NET_TICK_NONE 0xFFFFFFFF
+
+// "JFRP", and the replay file version
+#define GAME_REPLAY_MAGIC 0x5052464A
+#define GAME_REPLAY_VERSION 2
+
+// The software renderer draws a band of rows at a time, each
+// band fitting in SOFT_RENDER_BAND_BYTES of the frame arena.
+// Every animation frame and sprite particle frame is a tile
+#define SOFT_RENDER_BAND_BYTES (64*1024)
+#define SOFT_RENDER_TILE_MAX (ANIMATION_FRAME_MAX + 64)
+
+// Frame capture keeps up to CAPTURE_BUFFERS frames waiting for
+// the writer. Frames that come while all are waiting are dropped
+#define CAPTURE_BUFFERS 8
+
+#define HOTRELOAD_QUEUE_SIZE 8
+#define HOTRELOAD_PATH_LENGTH 256
 
 //////////////////////////////////////////////////////
 // Forward Declares									//
@@ -40,13 +147,17 @@ struct Animation;
 struct Game;
 struct Player;
 struct Enemy;
+struct EnemyCold;
 struct Projectile;
-struct Particle;
+struct ProjectileCold;
+struct ParticleSystem;
 
 //////////////////////////////////////////////////////
 // Enumerations										//
 //////////////////////////////////////////////////////
 
+// Built in enemy types. Types loaded from ENEMY_ARCHETYPE_FILE
+// follow on from these, up to ENEMY_ARCHETYPE_MAX
 enum EnemyType : Uint16
 {
 	ENEMY_SIMPLE = 0,
@@ -57,14 +168,164 @@ enum EnemyType : Uint16
 	enemy_type_count
 };
 
+enum EnemyBehaviour : Uint16
+{
+	ENEMY_BEHAVIOUR_SIMPLE = 0,
+	ENEMY_BEHAVIOUR_STRAIGHTSHOOT,
+	ENEMY_BEHAVIOUR_STRAFESHOOT,
+
+	enemy_behaviour_count
+};
+
 enum PartType : Uint16
 {
 	PART_EXPLOSION_01 = 0,
+	PART_SPARK,
 	// Add more as needed
 
 	part_type_count
 };
 
+// Buttons held down on a tick. The sim only reads input
+// through these, so ticks can be played again
+enum InputButton : Uint8
+{
+	INPUT_UP 		= 1 << 0,
+	INPUT_DOWN 		= 1 << 1,
+	INPUT_LEFT 		= 1 << 2,
+	INPUT_RIGHT 	= 1 << 3,
+	INPUT_SHOOT 	= 1 << 4,
+	INPUT_START 	= 1 << 5,
+};
+
+// Parts of the sim state hashed apart, so a desync can be
+// traced to one of them
+enum ChecksumField : Uint16
+{
+	CHECKSUM_PLAYERS = 0,
+	CHECKSUM_ENEMIES,
+	CHECKSUM_PROJECTILES_FRIENDLY,
+	CHECKSUM_PROJECTILES_ENEMY,
+	CHECKSUM_SCORE,
+	CHECKSUM_RANDOM,
+
+	checksum_field_count
+};
+
+// Quantized fields of a net state entity. Each pool only
+// sends the fields it uses
+enum NetField : Uint16
+{
+	NET_FIELD_X = 0,
+	NET_FIELD_Y,
+	NET_FIELD_VEL_X,
+	NET_FIELD_VEL_Y,
+	NET_FIELD_HP,
+	NET_FIELD_LOOK, 				// type or animation << 8, then frame
+
+	net_field_count
+};
+
+enum NetPool : Uint16
+{
+	NET_POOL_PLAYERS = 0,
+	NET_POOL_ENEMIES,
+	NET_POOL_PROJECTILES_FRIENDLY,
+	NET_POOL_PROJECTILES_ENEMY,
+
+	net_pool_count
+};
+
+enum ContactType : Uint16
+{
+	CONTACT_PLAYER_ENEMY = 0, 		// a = enemy, b = player
+	CONTACT_ENEMY_PROJECTILE, 		// a = enemy, b = friendly projectile
+	CONTACT_PLAYER_PROJECTILE, 		// a = player, b = enemy projectile
+
+	contact_type_count
+};
+
+enum GameEventType : Uint16
+{
+	GAME_EVENT_KILL = 0, 			// target = enemy, value = 1 if it scores
+	GAME_EVENT_DAMAGE, 				// target = enemy or player, value = damage
+	GAME_EVENT_SPAWN_PARTICLE, 		// value = PartType, at x/y
+	GAME_EVENT_SCORE, 				// value = score to add
+	GAME_EVENT_PLAYER_DEATH, 		// target = player
+
+	game_event_type_count
+};
+
+enum AabbKernel : Uint16
+{
+	AABB_KERNEL_AUTO = 0, 			// best the CPU supports
+	AABB_KERNEL_SCALAR,
+	AABB_KERNEL_SSE2,
+	AABB_KERNEL_AVX2,
+
+	aabb_kernel_count
+};
+
+enum BulletPattern : Uint16
+{
+	BULLET_PATTERN_SINGLE = 0, 		// one shot straight down
+	BULLET_PATTERN_RADIAL, 			// a ring, all at once
+	BULLET_PATTERN_SPIRAL, 			// a ring that turns each tick
+	BULLET_PATTERN_FAN, 			// a spread aimed at the nearest player
+
+	bullet_pattern_count
+};
+
+// Pixel layouts the software renderer writes
+enum SoftRenderFormat : Uint8
+{
+	SOFT_RENDER_GRAY = 0, 			// 1 byte a pixel
+	SOFT_RENDER_RGB, 				// 3 bytes a pixel, red first
+	SOFT_RENDER_RGBA, 				// 4 bytes a pixel, red first
+
+	soft_render_format_count
+};
+
+// How captured frames are written
+enum CaptureFormat : Uint8
+{
+	CAPTURE_RAW_RGB = 0, 			// packed RGB24 frames, nothing else
+	CAPTURE_Y4M, 					// YUV4MPEG2, 4:4:4, with a header
+
+	capture_format_count
+};
+
+// Where captured frames come from
+enum CaptureSource : Uint8
+{
+	CAPTURE_SOURCE_RENDERER = 0, 	// read back from the SDL renderer
+	CAPTURE_SOURCE_SOFT, 			// drawn by the software renderer
+
+	capture_source_count
+};
+
+// Built in animations. Animations made with AnimationDefine
+// follow on from these, up to ANIMATION_MAX
+enum AnimationId : Uint16
+{
+	ANIMATION_PLAYER = 0,
+	ANIMATION_SHOT_FRIENDLY,
+	ANIMATION_SHOT_ENEMY,
+	// Add more as needed
+
+	animation_builtin_count
+};
+
+enum AllocPhase : Uint16
+{
+	ALLOC_PHASE_NONE = 0,
+	ALLOC_PHASE_INPUT,
+	ALLOC_PHASE_UPDATE,
+	ALLOC_PHASE_RENDER,
+
+	alloc_phase_count
+};
+
 //////////////////////////////////////////////////////
 // Structures										//
 //////////////////////////////////////////////////////
@@ -84,31 +345,35 @@ struct AssetTexture
 	SDL_Texture*			texture = nullptr;
 
 	char*					name = nullptr;
+	char*					path = nullptr; // File loaded from, used for Hot Reloading
 	Uint16 					width = 0;
 	Uint16					height = 0;
 };
 
 /*** Animation ***/
 
-struct Animation
+// Shared by every object playing the animation
+struct AnimationDef
 {
-	float 					image_index = 0;
-	float 					image_speed = 0;
-	Uint16					image_count = 1;
-
+	Uint16					first_frame = 0; // Index into game->animation_frames
+	Uint16					frame_count = 1;
+	Uint32					speed = 0; // Frames per tick, 16.16 fixed point
 	bool					loops = true;
+};
 
-	Uint16 					y_offset = 0; // How far down the sprite sheet we sit
-
-	SDL_Rect				rect = { 0, 0, 32, 32 };
+// Each object's place in an animation
+struct Animation
+{
+	Uint16					def = ANIMATION_PLAYER;
+	Uint32					position = 0; // Frame, 16.16 fixed point
 };
 
 /*** Player ***/
 
 struct Player
 {
-	Game*					runner = nullptr;
-
+    Uint16 					index = 0; 		// in Game::players
+    bool 					joined = false; 	// playing this game, alive or not
     bool 					alive = true;
     Sint16 					hp = 100;
     Sint16					hp_max = 100;
@@ -118,10 +383,12 @@ struct Player
     float 					move_dead = 0.1;
     float 					move_max = 4;
 
-    Uint32 					next_shot = 0;
+    bool 					reloading = false;
+    Uint8 					buttons = 0; 		// InputButtons held this tick
 
     Vector2D 				pos;
 	Vector2D				vel;
+	Vector2D				moved; 			// how far pos went this tick
 
 	SDL_Rect				collision = { 0, 0, 24, 24 };
 	Point					col_offset;
@@ -130,50 +397,139 @@ struct Player
     AssetTexture*			sprite_texture = nullptr;
 };
 
+/*
+	Pooled entities are split in two. The hot part
+	holds what the update loop reads every tick, and
+	the cold part (kept in a parallel array, at the same
+	index) holds render and config data. Entities don't
+	point back at the Game, it is passed in to every
+	function that needs it.
+*/
+
 /*** Enemy ***/
 
 union EnemyData
 {
 	struct {
-		Uint32 	cooldown;
+		Uint32 			fire_interval;
+		BulletPattern 	pattern;
 	} straight_data;
 };
 
 struct Enemy
 {
-	Game* 					runner = nullptr;
-	EnemyType				type = ENEMY_SIMPLE;
-
 	Vector2D				pos;
 	Vector2D				vel;
+	Vector2D				moved; 			// how far pos went this tick
 
 	bool					alive = true;
 	Sint16					hp = 10;
-	Sint16					hp_max = 10;
-	Uint32					score_value = 10;
+	EnemyBehaviour			behaviour = ENEMY_BEHAVIOUR_SIMPLE;
 
 	SDL_Rect				collision = { 0, 0, 24, 24 };
 	Point					col_offset;
 
-	Animation				ship_ani;
-	AssetTexture*			sprite_texture;
-
 	EnemyData				data;
 
-	bool					(*update)(Enemy*, Uint32);
+	bool					(*update)(Game*, Enemy*, EnemyCold*, Uint32);
+};
+
+struct EnemyCold
+{
+	EnemyType				type = ENEMY_SIMPLE;
+
+	Sint16					hp_max = 10;
+	Uint32					score_value = 10;
+
+	Uint16					fire_timer = TIMER_NONE;
+
+	Animation				ship_ani;
+	AssetTexture*			sprite_texture = nullptr;
 };
 
-/*** Particle ***/
+/*** Enemy Archetype ***/
 
-struct Particle
+// Compact description of an enemy type, as written in
+// the built in table or the archetype file
+struct EnemyArchetypeDef
 {
-	Game*					runner = nullptr;
+	EnemyBehaviour			behaviour;
 
-	Vector2D				pos;
+	float					vel_x;
+	float					vel_y;
+	float					vel_random_x; 	// Up to this much is added at spawn
+	float					vel_random_y;
 
-	bool 					alive = false;
+	Sint16					hp;
+	Uint32					score_value;
 
-	Animation				ani;
+	Uint16					col_w;
+	Uint16					col_h;
+	Sint16					col_x;
+	Sint16					col_y;
+
+	Uint16					sprite_row; 	// Row of 32px cells on the sprite sheet
+
+	Uint32					fire_delay; 	// Time to first shot, in ms
+	Uint32					fire_interval;
+	BulletPattern			pattern;
+
+	Sint16					spawn_x;
+	Sint16					spawn_y;
+	Uint16					spawn_range_x; 	// Random range added to spawn position
+	Uint16					spawn_range_y;
+};
+
+// Ready made enemy, copied whole when spawning
+struct EnemyArchetype
+{
+	Enemy					hot;
+	EnemyCold				cold;
+
+	Vector2D				vel_random;
+	Uint32					fire_delay;
+
+	Point					spawn_min;
+	Point					spawn_range;
+};
+
+/*** Particle System ***/
+
+// How a PartType is spawned and drawn
+struct ParticleEmitterDef
+{
+	Uint16					burst;			// particles per spawn
+	float					speed_min;		// pixels per tick, in a random direction
+	float					speed_max;
+	float					life_min;		// ticks
+	float					life_max;
+	Uint16					frame_count;	// sprite frames over its life, 0 draws a rectangle
+	Uint16					y_offset;		// sprite sheet row
+	Uint8					size;			// rectangle size
+	SDL_Color				color;			// rectangle colour
+	PartType				also;			// type spawned along with it, or part_type_count
+};
+
+// Particles are kept one array per field, alive ones at the front
+struct ParticleSystem
+{
+	float*					pos_x = nullptr;
+	float*					pos_y = nullptr;
+	float*					vel_x = nullptr;
+	float*					vel_y = nullptr;
+	float*					age = nullptr;
+	float*					life = nullptr;
+	float*					frame_scale = nullptr;
+	Sint32*					frame = nullptr;
+	Uint32*					type = nullptr;
+
+	Uint32					count = 0;
+	Uint32					capacity = 0;
+	Uint32					budget = 0;			// most alive at once, up to capacity
+	Uint32					dropped = 0;		// particles not spawned, for lack of room
+
+	Uint32					seed = 0x2545F491;
+	void*					memory = nullptr;
 	AssetTexture*			texture = nullptr;
 };
 
@@ -181,8 +537,6 @@ struct Particle
 
 struct Projectile
 {
-	Game*					runner = nullptr;
-
 	bool 					alive = false;
 	Uint8					damage = 10;
 	bool					friendly = false;
@@ -194,23 +548,397 @@ struct Projectile
 	Point 					col_offset;
 
 	Animation				ani;
-	AssetTexture*			texture;
+};
+
+struct ProjectileCold
+{
+	AssetTexture*			texture = nullptr;
+};
+
+/*** Bullet Patterns ***/
+
+// How a BulletPattern fires. Bullets go out in a straight
+// line from where they were fired, speeding up by Accel
+struct BulletPatternDef
+{
+	Uint16					count; 			// bullets per volley
+	float					spread; 		// radians covered, a full turn for a ring
+	float					speed; 			// pixels per tick
+	float					accel; 			// pixels per tick, per tick
+	float					spin; 			// radians turned per tick, for spirals
+	bool					aimed; 			// centred on the nearest player, or straight down
+	Uint8					damage;
+};
+
+/*
+	Enemy projectiles don't store a position that is
+	moved each tick. Their position is worked out from
+	where and when they were fired, so a whole pool can
+	be placed at once, and the tick they leave the screen
+	is known when they are fired. Kept one array per
+	field, at the same index as projectiles_enemy.
+*/
+struct BulletPaths
+{
+	alignas(16) float		origin_x[POOLSIZE_ENEMY_PROJ];
+	alignas(16) float		origin_y[POOLSIZE_ENEMY_PROJ];
+	alignas(16) float		dir_x[POOLSIZE_ENEMY_PROJ];
+	alignas(16) float		dir_y[POOLSIZE_ENEMY_PROJ];
+	alignas(16) float		speed[POOLSIZE_ENEMY_PROJ];
+	alignas(16) float		accel[POOLSIZE_ENEMY_PROJ];
+	alignas(16) Uint32		spawn_tick[POOLSIZE_ENEMY_PROJ];
+	alignas(16) Uint32		exit_tick[POOLSIZE_ENEMY_PROJ];
+};
+
+/*** Contact ***/
+
+struct Contact
+{
+	ContactType				type;
+	Uint16					a;
+	Uint16					b;
+};
+
+/*** AABB Batch ***/
+
+// Boxes packed into one array per field, so many can be tested at once
+struct AabbBatch
+{
+	Sint32*					x = nullptr;
+	Sint32*					y = nullptr;
+	Sint32*					w = nullptr;
+	Sint32*					h = nullptr;
+	Uint32					count = 0;
+	Uint32					capacity = 0;
+};
+
+/*** Frame Arena ***/
+
+struct FrameArena
+{
+	Uint8*					memory = nullptr;
+	Uint32					capacity = 0;
+	Uint32					used = 0;
+
+	Uint32					high_water = 0;
+	Uint32					failed = 0;
+};
+
+/*** Game Event ***/
+
+// Side effects raised during the update, applied together
+// by Game Event Drain at the end of the tick
+struct GameEvent
+{
+	GameEventType			type;
+	Uint16					target;
+	Sint32					value;
+	float					x;
+	float					y;
+};
+
+struct GameEventQueue
+{
+	GameEvent				events[GAME_EVENT_QUEUE_SIZE];
+	Uint16					count = 0;
+	Uint32					dropped = 0;
+};
+
+/*** Timer Wheel ***/
+
+// Called when a timer fires, with the target it was scheduled for
+typedef void 	(*TimerCallback)( Game* game, Uint16 target );
+
+struct Timer
+{
+	TimerCallback			callback = nullptr;
+	Uint16					target = 0;
+	Uint32					tick = 0;
+
+	// Links in its slot's list, or the free list
+	Uint16					next = TIMER_NONE;
+	Uint16					prev = TIMER_NONE;
+	Uint16					slot = TIMER_NONE;
+};
+
+// Each level's slots span TIMER_WHEEL_SLOTS times the ticks
+// of the level below. Timers move down a level as they get
+// closer, and fire from level 0.
+struct TimerWheel
+{
+	Uint32					tick = 0;
+
+	Timer					timers[TIMER_CAPACITY];
+	Uint16					slots[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+	Uint16					free_list = TIMER_NONE;
+	Uint16					active = 0;
+};
+
+/*** Rewind ***/
+
+struct RewindKeyframe
+{
+	Uint32					tick;
+	Uint32					offset; 		// into the rewind memory
+	Uint32					size;
+};
+
+// Keyframes are packed one after another into Memory, going
+// back to the start when they reach the end, and dropping
+// the oldest ones in the way
+struct RewindBuffer
+{
+	Uint8*					memory = nullptr;
+	Uint32					capacity = 0;
+	Uint32					write = 0;
+
+	RewindKeyframe			keyframes[REWIND_KEYFRAME_MAX];
+	Uint16					keyframe_first = 0;
+	Uint16					keyframe_count = 0;
+
+	Uint8					inputs[REWIND_TICKS][PLAYER_MAX]; // InputButtons, by tick and player
+	Uint32					head = 0; 				// ticks recorded
+	Uint32					cursor = 0; 			// tick shown while rewinding
+
+	bool					active = false;
+	bool					key_held = false;
+	Uint32					dropped = 0; 			// keyframes too big to keep
+};
+
+/*** Checksum ***/
+
+// Hashes of the sim state after a tick, one per ChecksumField
+struct GameChecksum
+{
+	Uint32					fields[checksum_field_count] = {};
+};
+
+/*** Replay ***/
+
+// A replay file holds a snapshot to start from, then the
+// input and checksum of every tick
+struct Replay
+{
+	FILE*					file = nullptr;
+	Uint32					first_tick = 0; 		// rewind tick recording started on
+	Uint32					tick_count = 0;
+	Uint32					snapshot_size = 0;
+};
+
+/*** Net State ***/
+
+struct NetEntity
+{
+	Uint16					fields[net_field_count];
+};
+
+// What clients are sent of a tick, quantized. Every pool's
+// entities are in one array, each pool starting at its
+// offset, live ones at the front as in the game
+struct NetState
+{
+	Uint32					tick = NET_TICK_NONE;
+	Uint32					score = 0;
+	Uint32					high_score = 0;
+	Uint16					flags = 0; 				// playing, needs reset, then alive and reloading by player
+
+	Uint16					counts[net_pool_count] = {};
+	NetEntity				entities[NET_ENTITY_MAX];
+};
+
+// Recent states, by tick, to encode against or decode from
+struct NetStateHistory
+{
+	NetState				states[NET_STATE_HISTORY];
+};
+
+/*** Rollback ***/
+
+// A packet held back to act like a slow network, for testing
+struct RollbackDelayed
+{
+	Uint32					release; 		// ms
+	Uint16					size;
+	Uint8					data[ROLLBACK_PACKET_MAX];
+};
+
+// Each tick is run as soon as the local input is known, with
+// the remote input guessed. Snapshots of the last few ticks
+// are kept, so a wrong guess can be undone and run again
+struct RollbackSession
+{
+	int						socket = -1;
+	Uint32					remote_ip = 0; 			// network byte order
+	Uint16					remote_port = 0; 		// network byte order
+	Uint16					local_player = 0;
+
+	Uint32					frame = 0; 				// next tick to run
+	Uint8					inputs[ROLLBACK_PLAYERS][ROLLBACK_HISTORY];
+	Uint32					confirmed[ROLLBACK_PLAYERS]; // ticks of input known, from the start
+	Uint32					remote_ack = 0; 		// ticks of our input the remote has
+	Uint32					rollback_to = ROLLBACK_FRAME_NONE;
+
+	Uint8*					snapshots = nullptr;
+	Uint32					snapshot_sizes[ROLLBACK_SNAPSHOTS];
+
+	GameChecksum			checksums[ROLLBACK_HISTORY];
+	GameChecksum			remote_checksum;
+	Uint32					remote_checksum_frame = ROLLBACK_FRAME_NONE;
+
+	// Test conditions, applied to packets we send
+	Uint32					latency = 0; 			// ms
+	Uint32					jitter = 0; 			// ms either way
+	Uint32					loss = 0; 				// percent
+	Uint32					random = 0x6C8E9CF5;
+	RollbackDelayed			delayed[ROLLBACK_DELAY_QUEUE];
+	Uint16					delayed_count = 0;
+
+	// Stats
+	Uint32					rollbacks = 0;
+	Uint32					resimulated = 0; 		// ticks run again
+	Uint32					max_depth = 0;
+	Uint64					resimulate_time = 0; 	// performance counter ticks
+	Uint32					stalls = 0; 			// ticks waited for the remote
+	Uint32					desyncs = 0;
+	Uint32					packets_sent = 0;
+	Uint32					packets_lost = 0;
+};
+
+/*** Soft Renderer ***/
+
+// A prescaled sprite, in SoftRenderer::pixels
+struct SoftTile
+{
+	Uint32					offset = 0;
+	Uint16					w = 0;
+	Uint16					h = 0;
+};
+
+/*
+	What Game Render draws, copied to the CPU and scaled
+	to one output size. Pixels are premultiplied RGBA, red
+	first in memory. Nothing changes it once set up, so
+	one can be shared by any number of games and threads.
+*/
+struct SoftRenderer
+{
+	Uint16					width = 0;
+	Uint16					height = 0;
+	SoftRenderFormat		format = SOFT_RENDER_RGB;
+	float					scale_x = 1; 		// output pixels per screen pixel
+	float					scale_y = 1;
+
+	Uint32*					pixels = nullptr;
+	Uint32					pixel_count = 0;
+
+	// Animation frames by index, then sprite particle frames
+	SoftTile				tiles[SOFT_RENDER_TILE_MAX];
+	Uint16					tile_count = 0;
+	Uint16					particle_tiles[part_type_count] = {};
+
+	// The background tiled down a strip one tile taller than
+	// the screen, so any scroll is one run of rows from it
+	Uint32					background_offset = 0;
+	Uint16					background_rows = 0;
+	Uint16					background_period = 0; 	// tile height, in screen pixels
+};
+
+/*** Frame Capture ***/
+
+/*
+	The game fills buffers from a ring, and a writer thread
+	empties them in the same order. Free Slots counts the
+	empty buffers and Full Slots the filled ones, so the
+	game never waits: with no buffer free it drops the frame.
+*/
+struct FrameCapture
+{
+	bool					active = false;
+	CaptureFormat			format = CAPTURE_Y4M;
+	CaptureSource			source = CAPTURE_SOURCE_RENDERER;
+	Uint16					width = 0;
+	Uint16					height = 0;
+	Uint32					frame_size = 0; 	// bytes of RGB24
+
+	FILE*					file = nullptr;
+	bool					close_file = false; // not for stdout
+
+	Uint8*					memory = nullptr;
+	Uint8*					frames[CAPTURE_BUFFERS] = {};
+	Uint8*					planes = nullptr; 	// Y4M conversion, the writer's own
+
+	SoftRenderer*			soft = nullptr;
+
+	SDL_Thread*				thread = nullptr;
+	SDL_sem*				free_slots = nullptr;
+	SDL_sem*				full_slots = nullptr;
+	Uint32					head = 0; 			// next buffer the game fills
+	Uint32					ticks = 0; 			// time steps since a frame was grabbed
+	Uint32					repeats[CAPTURE_BUFFERS] = {}; // time steps each frame stands for
+	SDL_atomic_t			published; 			// frames handed to the writer
+	SDL_atomic_t			failed; 			// the output couldn't be written
+
+	// Stats
+	Uint32					captured = 0; 		// time steps
+	Uint32					dropped = 0; 		// grabs with no free buffer
+	SDL_atomic_t			written; 			// frames, repeats included
+	Uint64					grab_time = 0; 		// performance counter ticks
+};
+
+/*** Asset Watcher ***/
+
+struct AssetReload
+{
+	char					path[HOTRELOAD_PATH_LENGTH];
+	SDL_Surface*			surface = nullptr; // Decoded off the main thread, null for fonts
+};
+
+struct AssetWatcher
+{
+	SDL_Thread*				thread = nullptr;
+	SDL_mutex*				lock = nullptr;
+	SDL_atomic_t			quit;
+
+	int						notify_fd = -1;
+	int						watch_images = -1;
+	int						watch_fonts = -1;
+
+	AssetReload				pending[HOTRELOAD_QUEUE_SIZE];
+	Uint16					pending_count = 0; 	// only touched under the lock
+	SDL_atomic_t			waiting; 			// set while anything is pending, checked without the lock
 };
 
 /*** Game ***/
 
 struct Game
 {
-	Player					player;
+	Player					players[PLAYER_MAX];
 
 	Enemy					enemies[POOLSIZE_ENEMY];
+	EnemyCold				enemies_cold[POOLSIZE_ENEMY];
 	Uint16					enemy_count = 0;
 
-	Particle				particles[POOLSIZE_PARTICLE];
-	Uint16					part_count = 0;
+	// Enemies are kept grouped by behaviour. Behaviour B
+	// runs up to (not including) enemy_behaviour_end[B]
+	Uint16					enemy_behaviour_end[enemy_behaviour_count] = {};
+	bool					batch_enemy_updates = true;
+
+	EnemyArchetype			enemy_archetypes[ENEMY_ARCHETYPE_MAX];
+	Uint16					enemy_archetype_count = 0;
+
+	ParticleSystem			particles;
+	RewindBuffer			rewind;
+	BulletPaths				bullet_paths;
+
+	AnimationDef			animation_defs[ANIMATION_MAX];
+	Uint16					animation_count = 0;
+	SDL_Rect				animation_frames[ANIMATION_FRAME_MAX];
+	Uint16					animation_frame_count = 0;
 
 	Projectile				projectiles_friendly[POOLSIZE_FRIENDLY_PROJ];
 	Projectile				projectiles_enemy[POOLSIZE_ENEMY_PROJ];
+	ProjectileCold			projectiles_friendly_cold[POOLSIZE_FRIENDLY_PROJ];
+	ProjectileCold			projectiles_enemy_cold[POOLSIZE_ENEMY_PROJ];
 	Uint16					proj_friendly_count = 0;
 	Uint16					proj_enemy_count = 0;
 
@@ -221,13 +949,19 @@ struct Game
 	SDL_Event				event;
 
 	bool					needs_reset = false;
-	Uint32					next_reset = 0;
+
+	Uint32					random_state = 0x9E3779B9;
+
+	TimerWheel				timers;
+	GameEventQueue			events;
 
 	SDL_Color				screen_color;
 
 	TTF_Font*				game_font;
 	AssetTexture			game_start_text;
 
+	AssetWatcher			asset_watcher;
+
 	AssetTexture			texture_assets[TEXTURE_COUNT];
 
 	AssetTexture*			background_texture = nullptr;
@@ -236,16 +970,16 @@ struct Game
 
 	Uint32					score = 0xFFFFFFFF;
 	Uint32					high_score = 0xFFFFFFFF;
-	char					score_text[8] = "0";
-	char					highscore_text[8] = "0";
-	AssetTexture			score_text_font;
-	AssetTexture			highscore_text_font;
+	AssetTexture			digit_textures[10];
+
+	FrameArena				frame_arena;
 
-	bool					key_up = false;
-	bool					key_down = false;
-	bool					key_left = false;
-	bool					key_right = false;
-	bool					key_shoot = false;
+	Uint8					inputs[PLAYER_MAX] = {}; 	// InputButtons for the next tick, by player
+	SDL_GameController*		controllers[CONTROLLER_COUNT] = {};
+
+	Replay					replay;
+	RollbackSession			rollback;
+	FrameCapture			capture;
 
 	const Uint8*			key_states = nullptr;
 };
@@ -258,6 +992,8 @@ struct Game
 
 bool 			TextureInit( AssetTexture* tex, const char* name );
 void			TextureFree( AssetTexture* tex );
+SDL_Surface*	TextureDecodeFile( const char* filename );
+bool			TextureLoadSurface( AssetTexture* tex, SDL_Renderer* render, SDL_Surface* surf );
 bool			TextureLoadFile( AssetTexture* tex, SDL_Renderer* render, const char* filename );
 bool			TextureLoadFromText( AssetTexture* tex, SDL_Renderer* render, const char* text, TTF_Font* font, SDL_Color text_color );
 
@@ -267,19 +1003,138 @@ void 			TextureSetBlend( AssetTexture* tex, SDL_BlendMode blending );
 
 void 			TextureRender( AssetTexture* tex, SDL_Renderer* render, int x, int y, SDL_Rect* clip = nullptr );
 
+/*** Arena Functions ***/
+
+bool 			ArenaInit( FrameArena* arena, Uint32 capacity );
+void 			ArenaFree( FrameArena* arena );
+void 			ArenaReset( FrameArena* arena );
+Uint32 			ArenaMark( FrameArena* arena );
+void 			ArenaRewind( FrameArena* arena, Uint32 mark );
+void* 			ArenaAlloc( FrameArena* arena, Uint32 size, Uint32 align = 8 );
+const char* 	ArenaPrintf( FrameArena* arena, const char* format, ... );
+void 			ArenaPrintStats( FrameArena* arena, const char* name );
+
+/*** Allocation Tracking Functions ***/
+
+#ifdef ALLOC_TRACKING
+void 			AllocTrackBegin();
+void 			AllocTrackPhase( AllocPhase phase );
+Uint32 			AllocTrackTickEnd();
+void 			AllocTrackReport();
+
+bool 			GameAllocTest( Game* game, Uint32 warmup, Uint32 ticks );
+#else
+inline void 	AllocTrackBegin() {}
+inline void 	AllocTrackPhase( AllocPhase phase ) {}
+inline Uint32 	AllocTrackTickEnd() { return 0; }
+inline void 	AllocTrackReport() {}
+#endif // ALLOC_TRACKING
+
+/*** Game Event Functions ***/
+
+bool 			GameEventPush( Game* game, GameEventType type, Uint16 target, Sint32 value, float x = 0, float y = 0 );
+void 			GameEventDrain( Game* game );
+
+/*** Timer Functions ***/
+
+void 			TimerWheelInit( TimerWheel* wheel );
+void 			TimerWheelClear( TimerWheel* wheel );
+Uint16 			TimerSchedule( TimerWheel* wheel, Uint32 delay, TimerCallback callback, Uint16 target );
+void 			TimerCancel( TimerWheel* wheel, Uint16 handle );
+void 			TimerRetarget( TimerWheel* wheel, Uint16 handle, Uint16 target );
+void 			TimerWheelAdvance( Game* game );
+
+/*** Snapshot Functions ***/
+
+Uint32 			GameSnapshotSize( Game* game );
+Uint32 			GameSnapshotSave( Game* game, void* buffer, Uint32 capacity );
+bool 			GameSnapshotRestore( Game* game, const void* buffer, Uint32 size );
+
+/*** Checksum Functions ***/
+
+void 			GameChecksumCompute( Game* game, GameChecksum* checksum );
+bool 			GameChecksumCompare( const GameChecksum* expected, const GameChecksum* actual, Uint32 tick );
+
+/*** Replay Functions ***/
+
+bool 			ReplayRecordStart( Game* game, const char* filename );
+void 			ReplayRecordTick( Game* game, const Uint8* inputs );
+void 			ReplayRecordRewind( Game* game, Uint32 tick );
+void 			ReplayRecordStop( Game* game );
+bool 			ReplayVerify( Game* game, const char* filename );
+
+/*** Net State Functions ***/
+
+void 			NetStateCapture( Game* game, Uint32 tick, NetState* state );
+Uint32 			NetStateEncode( const NetState* state, const NetState* baseline, Uint8* data, Uint32 capacity );
+bool 			NetStatePeek( const Uint8* data, Uint32 size, Uint32* tick, Uint32* baseline_tick );
+NetState* 		NetStateDecode( const Uint8* data, Uint32 size, NetStateHistory* history );
+bool 			NetStateEqual( const NetState* a, const NetState* b );
+NetState* 		NetStateHistoryFind( NetStateHistory* history, Uint32 tick );
+NetState* 		NetStateHistoryAdd( NetStateHistory* history, Uint32 tick );
+float 			NetStatePosition( Uint16 value );
+float 			NetStateVelocity( Uint16 value );
+
+/*** Soft Render Functions ***/
+
+bool 			SoftRenderInit( Game* game, SoftRenderer* soft, Uint16 width, Uint16 height, SoftRenderFormat format );
+void 			SoftRenderFree( SoftRenderer* soft );
+Uint32 			SoftRenderFrameSize( const SoftRenderer* soft );
+bool 			SoftRenderGame( Game* game, const SoftRenderer* soft, void* pixels, Uint32 pitch );
+
+/*** Capture Functions ***/
+
+bool 			CaptureStart( Game* game, const char* path, CaptureFormat format, CaptureSource source );
+void 			CaptureTick( Game* game );
+void 			CaptureFrame( Game* game );
+void 			CaptureStop( Game* game );
+
+/*** Rollback Functions ***/
+
+bool 			RollbackStart( Game* game, Uint16 local_player, Uint16 local_port, const char* remote_ip, Uint16 remote_port );
+void 			RollbackStop( Game* game );
+void 			RollbackSetConditions( Game* game, Uint32 latency, Uint32 jitter, Uint32 loss );
+void 			RollbackAdvance( Game* game, Uint8 input, Uint32 now );
+void 			RollbackPrintStats( Game* game );
+
+/*** Rewind Functions ***/
+
+bool 			RewindInit( RewindBuffer* rewind, Uint32 capacity );
+void 			RewindFree( RewindBuffer* rewind );
+void 			RewindPrintStats( RewindBuffer* rewind );
+void 			RewindRecord( Game* game, const Uint8* inputs );
+bool 			RewindSeek( Game* game, Uint32 tick );
+void 			RewindStart( Game* game );
+void 			RewindStop( Game* game );
+bool 			RewindInput( Game* game );
+
+/*** Hot Reload Functions ***/
+
+bool 			HotReloadStart( Game* game );
+void 			HotReloadStop( Game* game );
+void 			HotReloadApply( Game* game );
+
 /*** Animation Functions ***/
 
-void 			AnimationUpdate( Animation* ani );
+void 			AnimationsInit( Game* game );
+Uint16 			AnimationDefine( Game* game, Uint16 column, Uint16 row, Uint16 frame_count, float speed, bool loops );
+void 			AnimationStart( Animation* ani, Uint16 def );
+void 			AnimationStepBatch( Game* game, Animation* first, Uint32 count, Uint32 stride );
+void 			AnimationStepAll( Game* game );
+SDL_Rect* 		AnimationRect( Game* game, const Animation* ani );
 
 /*** Game Functions ***/
 
 bool 			GameInit( Game* game );
-void 			GameSetup( Game* game );
+void 			GameSetup( Game* game, Uint32 particle_capacity = PARTICLE_CAPACITY );
+bool 			GameSetupHeadless( Game* game, Uint32 particle_capacity );
 void 			GameReset( Game* game );
+void 			GameResetTimer( Game* game, Uint16 target );
 void 			GameStartPlay( Game* game );
 void 			GameQuit( Game* game );
 
 bool 			GameLoadAssets( Game* game );
+bool 			GameLoadDigits( Game* game );
 void 			GameFreeAssets( Game* game );
 
 AssetTexture*	GameFindTexture( Game* game, const char* name );
@@ -287,11 +1142,11 @@ AssetTexture*	GameFindTexture( Game* game, const char* name );
 void 			GameBackgroundUpdate( Game* game, Uint32 dt );
 void 			GameBackgroundRender( Game* game );
 
+Uint32 			GameRandom( Game* game );
 void 			GameSpawnRandomEnemy( Game* game );
 void 			GameKillEnemy( Game* game, Enemy* enemy );
 
 void 			GameSpawnParticle( Game* game, const Vector2D& pos, PartType type );
-void 			GameKillParticle( Game* game, Particle* part );
 
 Projectile*		GameSpawnProjectile( Game* game, bool friendly, const Vector2D& pos, const Vector2D& vel );
 void 			GameKillProjectile( Game* game, Projectile* proj );
@@ -300,50 +1155,88 @@ void 			GameScoreSet( Game* game, Uint32 value );
 void 			GameScoreAdd( Game* game, Uint32 value );
 void 			GameHighScoreSet( Game* game, Uint32 value );
 
+void 			GameRenderNumber( Game* game, Uint32 value, int x, int y );
 void 			GameRenderHud( Game* game );
 
 void 			GameLoop( Game* game );
 void 			GameInput( Game* game );
+void 			GameControllerOpen( Game* game, int device );
+void 			GameControllerClose( Game* game, SDL_JoystickID id );
+void 			GameTick( Game* game, const Uint8* inputs, Uint32 dt );
 void 			GameUpdate( Game* game, Uint32 dt );
 void 			GameRender( Game* game );
 
 /*** Player Functions ***/
 
-void 			PlayerSetup( Player* player );
+void 			PlayerSetup( Game* game, Player* player, Uint16 index );
+void 			PlayerSpawn( Game* game, Player* player );
+Player*			PlayerNearest( Game* game, const Vector2D& pos );
 
-void			PlayerUpdate( Player* player, Uint32 dt );
-void 			PlayerRender( Player* player );
+void			PlayerUpdate( Game* game, Player* player, Uint32 dt );
+void 			PlayerRender( Game* game, Player* player );
+const SDL_Color* 	PlayerTint( Uint16 index );
+void			PlayerReloadTimer( Game* game, Uint16 target );
 
 /*** Enemy Functionality ***/
 
-void 			EnemyInit( Enemy* enemy );
-bool 			EnemySetup( Enemy* enemy, EnemyType type, bool spawn_random = true );
-void 			EnemySwap( Enemy* e1, Enemy* e2 );
-void 			EnemyRender( Enemy* enemy );
+void 			EnemyArchetypeBuild( Game* game, EnemyArchetype* arch, const EnemyArchetypeDef* def );
+void 			EnemyArchetypesInit( Game* game );
+Uint16 			EnemyArchetypesLoad( Game* game, const char* filename );
+
+void 			EnemyInit( Game* game, Enemy* enemy, EnemyCold* cold );
+bool 			EnemySetup( Game* game, Enemy* enemy, EnemyCold* cold, EnemyType type, bool spawn_random = true );
+void 			EnemySwap( Enemy* e1, EnemyCold* c1, Enemy* e2, EnemyCold* c2 );
+void 			EnemyRender( Game* game, Enemy* enemy, EnemyCold* cold );
 
 // Update Functions of Several Different Enemy Types
-bool 			EnemyUpdateSimple( Enemy* enemy, Uint32 dt );
-bool			EnemyUpdateStraightShoot( Enemy* enemy, Uint32 dt );
-bool 			EnemyUpdateStrafeShoot( Enemy* enemy, Uint32 dt );
+bool 			EnemyUpdateSimple( Game* game, Enemy* enemy, EnemyCold* cold, Uint32 dt );
+bool 			EnemyUpdateStrafeShoot( Game* game, Enemy* enemy, EnemyCold* cold, Uint32 dt );
+
+void 			EnemyUpdateBatched( Game* game, Uint32 dt );
+void 			EnemyFireTimer( Game* game, Uint16 target );
 
 /*** Particle Functions ***/
 
-void 			ParticleInit( Particle* part );
-bool 			ParticleSpawn( Particle* part, const Vector2D& pos, PartType type );
-void 			ParticleSwap( Particle* p1, Particle* p2 );
-bool 			ParticleUpdate( Particle* part, Uint32 dt );
-void 			ParticleRender( Particle* part );
+bool 			ParticleSystemInit( Game* game, ParticleSystem* sys, Uint32 capacity );
+void 			ParticleSystemFree( ParticleSystem* sys );
+void 			ParticleSystemClear( ParticleSystem* sys );
+void 			ParticleSystemSetBudget( ParticleSystem* sys, Uint32 budget );
+Uint32 			ParticleEmit( ParticleSystem* sys, const Vector2D& pos, PartType type );
+void 			ParticleSystemUpdate( ParticleSystem* sys );
+void 			ParticleSystemRender( Game* game, ParticleSystem* sys );
+const ParticleEmitterDef* 	ParticleEmitterGet( PartType type );
 
 /*** Projectile Functions ***/
 
-void			ProjectileInit( Projectile* proj );
+void			ProjectileInit( Game* game, Projectile* proj, ProjectileCold* cold );
 bool 			ProjectileSpawn( Projectile* proj, const Vector2D& pos, const Vector2D& vel );
-void 			ProjectileSwap( Projectile* p1, Projectile* p2 );
+void 			ProjectileSwap( Projectile* p1, ProjectileCold* c1, Projectile* p2, ProjectileCold* c2 );
 bool 			ProjectileUpdate( Projectile* proj, Uint32 dt );
-void 			ProjectileRender( Projectile* proj );
+void 			ProjectileRender( Game* game, Projectile* proj, ProjectileCold* cold );
+
+/*** Bullet Functions ***/
+
+void 			BulletPathStart( Game* game, Uint16 index, const Vector2D& origin, const Vector2D& vel, float accel );
+void 			BulletPathCopy( BulletPaths* paths, Uint16 dst, Uint16 src );
+void 			BulletPathsUpdate( Game* game );
+void 			BulletPathsPlace( Game* game );
+Uint16 			BulletPatternFire( Game* game, const Vector2D& origin, BulletPattern pattern );
+BulletPattern 	BulletPatternFind( const char* name );
+
+/*** Collision Functions ***/
+
+Uint32 			GameCollisionFind( Game* game, Contact* contacts, Uint32 max );
+void 			GameCollisionResolve( Game* game, const Contact* contacts, Uint32 count );
+void 			GameCollide( Game* game );
 
 /*** Utility Functions ***/
 
 bool			UtilityAabbCheck( SDL_Rect* r1, SDL_Rect* r2 );
+bool			UtilityAabbSweep( const SDL_Rect* r1, const Vector2D& d1, const SDL_Rect* r2, const Vector2D& d2 );
+void			UtilityAabbSweepBounds( SDL_Rect* bounds, const SDL_Rect* box, const Vector2D& delta );
+bool			UtilityAabbBatchInit( AabbBatch* batch, FrameArena* arena, Uint32 capacity );
+void			UtilityAabbBatchAdd( AabbBatch* batch, const SDL_Rect* rect );
+Uint32			UtilityAabbCheckBatch( const SDL_Rect* r1, const AabbBatch* batch, Uint32* hits, AabbKernel kernel = AABB_KERNEL_AUTO );
+AabbKernel		UtilityAabbKernelBest();
 
 #endif // GAME_H
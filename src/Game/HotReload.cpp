@@ -0,0 +1,369 @@
+/*************************************/
+/** Hot Reload <source file>		**/
+/**									**/
+/** Watches the Data directory for	**/
+/** changed assets, and swaps them	**/
+/** into the running game without	**/
+/** restarting. (Linux only)		**/
+/*************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Game.h"
+
+#ifdef __linux__
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#define HOTRELOAD_IMAGE_DIR "Data/Images/"
+#define HOTRELOAD_FONT_DIR "Data/Fonts/"
+#define HOTRELOAD_POLL_MS 100
+
+/*
+	Hot Reload Has Extension
+
+	Purpose: Checks if a file name ends in the
+			given extension.
+
+	Parameters: Name - the file name to check
+				Ext - the extension, including the dot
+
+	Return:	True if the name ends with the extension
+*/
+
+static bool 	HotReloadHasExtension( const char* name, const char* ext )
+{
+	size_t name_length = strlen(name);
+	size_t ext_length = strlen(ext);
+
+	if ( name_length < ext_length )
+		return false;
+
+	return strcmp( name + name_length - ext_length, ext ) == 0;
+}
+
+/*
+	Hot Reload Queue
+
+	Purpose: Hands a changed asset over to the main
+			thread. If the same file is already waiting
+			(editors often write several times) the old
+			entry is replaced, rather than queued twice.
+
+	Parameters: Watcher - the asset watcher
+				Path - the path of the changed file
+				Surf - the decoded image, or nullptr
+					for assets the main thread has to
+					load itself (fonts)
+
+	Return:	Nil
+*/
+
+static void 	HotReloadQueue( AssetWatcher* watcher, const char* path, SDL_Surface* surf )
+{
+	SDL_LockMutex( watcher->lock );
+
+	// Find an existing entry for this file, or a new slot
+	AssetReload* reload = nullptr;
+	for( Uint16 i = 0; i < watcher->pending_count; i++ )
+	{
+		if ( strcmp( watcher->pending[i].path, path ) == 0 )
+		{
+			reload = &(watcher->pending[i]);
+			if ( reload->surface != nullptr )
+				SDL_FreeSurface( reload->surface );
+			break;
+		}
+	}
+
+	if ( reload == nullptr && watcher->pending_count < HOTRELOAD_QUEUE_SIZE )
+	{
+		reload = &(watcher->pending[watcher->pending_count++]);
+		strncpy( reload->path, path, HOTRELOAD_PATH_LENGTH-1 );
+		reload->path[HOTRELOAD_PATH_LENGTH-1] = '\0';
+	}
+
+	// Queue is full, so drop this change
+	if ( reload == nullptr )
+	{
+		printf( "Hot Reload: Queue full, skipping %s\n", path );
+		if ( surf != nullptr )
+			SDL_FreeSurface( surf );
+	}
+	else
+	{
+		reload->surface = surf;
+		SDL_AtomicSet( &(watcher->waiting), 1 );
+	}
+
+	SDL_UnlockMutex( watcher->lock );
+}
+
+/*
+	Hot Reload Thread
+
+	Purpose: Watcher thread entry point. Blocks on the
+			inotify descriptor, and decodes any image
+			that is written to, so the main thread only
+			has to upload it.
+
+	Parameters: Data - a pointer to the Asset Watcher
+
+	Return:	Thread exit code
+*/
+
+static int 		HotReloadThread( void* data )
+{
+	AssetWatcher* watcher = (AssetWatcher*)data;
+
+	char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	char path[HOTRELOAD_PATH_LENGTH];
+
+	pollfd poll_fd;
+	poll_fd.fd = watcher->notify_fd;
+	poll_fd.events = POLLIN;
+
+	while( SDL_AtomicGet( &(watcher->quit) ) == 0 )
+	{
+		// Wait for changes, waking up now and then to check for quitting
+		if ( poll( &poll_fd, 1, HOTRELOAD_POLL_MS ) <= 0 )
+			continue;
+
+		ssize_t length = read( watcher->notify_fd, buffer, sizeof(buffer) );
+		if ( length <= 0 )
+			continue;
+
+		// Walk all the events we were given
+		for( char* ptr = buffer; ptr < buffer + length; )
+		{
+			const inotify_event* event = (const inotify_event*)ptr;
+			ptr += sizeof(inotify_event) + event->len;
+
+			if ( event->len == 0 )
+				continue;
+
+			// Images are decoded here
+			if ( event->wd == watcher->watch_images && HotReloadHasExtension( event->name, ".png" ) )
+			{
+				snprintf( path, sizeof(path), "%s%s", HOTRELOAD_IMAGE_DIR, event->name );
+
+				SDL_Surface* surf = TextureDecodeFile( path );
+				if ( surf != nullptr )
+					HotReloadQueue( watcher, path, surf );
+			}
+			else
+			// Fonts share FreeType with the main thread, so it opens them
+			if ( event->wd == watcher->watch_fonts && HotReloadHasExtension( event->name, ".ttf" ) )
+			{
+				snprintf( path, sizeof(path), "%s%s", HOTRELOAD_FONT_DIR, event->name );
+				HotReloadQueue( watcher, path, nullptr );
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+	Hot Reload Start
+
+	Purpose: Starts watching the asset directories
+			for changes, on a separate thread.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	True if the watcher is running
+*/
+
+bool 			HotReloadStart( Game* game )
+{
+	AssetWatcher* watcher = &(game->asset_watcher);
+
+	// Create the inotify instance
+	watcher->notify_fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+	if ( watcher->notify_fd < 0 )
+	{
+		printf( "Hot Reload: Unable to start inotify\n" );
+		return false;
+	}
+
+	// Watch for files being written, or moved in (editors that save via rename)
+	const Uint32 mask = IN_CLOSE_WRITE | IN_MOVED_TO;
+	watcher->watch_images = inotify_add_watch( watcher->notify_fd, HOTRELOAD_IMAGE_DIR, mask );
+	watcher->watch_fonts = inotify_add_watch( watcher->notify_fd, HOTRELOAD_FONT_DIR, mask );
+
+	if ( watcher->watch_images < 0 && watcher->watch_fonts < 0 )
+	{
+		printf( "Hot Reload: Unable to watch asset directories\n" );
+		close( watcher->notify_fd );
+		watcher->notify_fd = -1;
+		return false;
+	}
+
+	// Start the Thread
+	watcher->lock = SDL_CreateMutex();
+	watcher->pending_count = 0;
+	SDL_AtomicSet( &(watcher->waiting), 0 );
+	SDL_AtomicSet( &(watcher->quit), 0 );
+
+	watcher->thread = SDL_CreateThread( HotReloadThread, "HotReload", watcher );
+	if ( watcher->thread == nullptr )
+	{
+		printf( "Hot Reload: Unable to create thread! SDL Error: %s\n", SDL_GetError() );
+		SDL_DestroyMutex( watcher->lock );
+		watcher->lock = nullptr;
+		close( watcher->notify_fd );
+		watcher->notify_fd = -1;
+		return false;
+	}
+
+	printf( "Hot Reload: Watching %s and %s\n", HOTRELOAD_IMAGE_DIR, HOTRELOAD_FONT_DIR );
+	return true;
+}
+
+/*
+	Hot Reload Stop
+
+	Purpose: Stops the watcher thread, and frees
+			anything that was still waiting to be
+			applied.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			HotReloadStop( Game* game )
+{
+	AssetWatcher* watcher = &(game->asset_watcher);
+
+	if ( watcher->thread == nullptr )
+		return;
+
+	// Wait for the thread to exit
+	SDL_AtomicSet( &(watcher->quit), 1 );
+	SDL_WaitThread( watcher->thread, nullptr );
+	watcher->thread = nullptr;
+
+	// Free Unapplied Changes
+	for( Uint16 i = 0; i < watcher->pending_count; i++ )
+	{
+		if ( watcher->pending[i].surface != nullptr )
+			SDL_FreeSurface( watcher->pending[i].surface );
+	}
+	watcher->pending_count = 0;
+	SDL_AtomicSet( &(watcher->waiting), 0 );
+
+	SDL_DestroyMutex( watcher->lock );
+	watcher->lock = nullptr;
+
+	close( watcher->notify_fd );
+	watcher->notify_fd = -1;
+}
+
+/*
+	Hot Reload Apply
+
+	Purpose: Applies any changed assets. Must be called
+			from the main thread, between frames. The
+			SDL_Texture inside each Asset Texture is
+			swapped in place, so every object pointing at
+			the asset draws the new image straight away.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			HotReloadApply( Game* game )
+{
+	AssetWatcher* watcher = &(game->asset_watcher);
+
+	// Checked every frame, so the lock is only taken once something is pending
+	if ( watcher->thread == nullptr || SDL_AtomicGet( &(watcher->waiting) ) == 0 )
+		return;
+
+	// Take the pending changes, so the watcher isn't held up by uploading
+	AssetReload reloads[HOTRELOAD_QUEUE_SIZE];
+	Uint16 reload_count;
+
+	SDL_LockMutex( watcher->lock );
+	reload_count = watcher->pending_count;
+	for( Uint16 i = 0; i < reload_count; i++ )
+		reloads[i] = watcher->pending[i];
+	watcher->pending_count = 0;
+	SDL_AtomicSet( &(watcher->waiting), 0 );
+	SDL_UnlockMutex( watcher->lock );
+
+	for( Uint16 i = 0; i < reload_count; i++ )
+	{
+		AssetReload* reload = &(reloads[i]);
+
+		// Image Assets
+		if ( reload->surface != nullptr )
+		{
+			for( Uint16 t = 0; t < TEXTURE_COUNT; t++ )
+			{
+				AssetTexture* tex = &(game->texture_assets[t]);
+
+				if ( tex->path != nullptr && strcmp( tex->path, reload->path ) == 0 )
+				{
+					if ( TextureLoadSurface( tex, game->render, reload->surface ) )
+						printf( "Hot Reload: Reloaded %s\n", reload->path );
+				}
+			}
+
+			SDL_FreeSurface( reload->surface );
+		}
+		else
+		// Game Font
+		if ( strcmp( reload->path, GAME_FONT_FILE ) == 0 )
+		{
+			TTF_Font* font = TTF_OpenFont( GAME_FONT_FILE, GAME_FONT_SIZE );
+			if ( font == nullptr )
+			{
+				printf( "Hot Reload: Unable to reload font %s: %s\n", reload->path, TTF_GetError() );
+				continue;
+			}
+
+			TTF_CloseFont( game->game_font );
+			game->game_font = font;
+
+			// Redraw all text with the new font
+			SDL_Color text_color = {255,255,255,255};
+			TextureLoadFromText( &(game->game_start_text), game->render,
+								 "Press Enter to Start", game->game_font, text_color );
+			GameLoadDigits( game );
+
+			printf( "Hot Reload: Reloaded %s\n", reload->path );
+		}
+	}
+}
+
+#else
+
+/*
+	Hot Reload is only supported on Linux, other platforms
+	get these empty versions, so callers don't need to check.
+*/
+
+bool 			HotReloadStart( Game* game )
+{
+	return false;
+}
+
+void 			HotReloadStop( Game* game )
+{
+}
+
+void 			HotReloadApply( Game* game )
+{
+}
+
+#endif // __linux__
@@ -0,0 +1,681 @@
+/*************************************/
+/** Net State <source file>			**/
+/**									**/
+/** Packs what clients see of a		**/
+/** tick into as few bits as it		**/
+/** can, as changes from a state	**/
+/** they already have.				**/
+/*************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Game.h"
+
+/*
+	An encoded state is bit packed, lowest bit first:
+	tick u32, baseline tick u32 (NET_TICK_NONE for none),
+	score u32, high score u32, flags (NET_FLAG_BITS), then
+	each pool. The flags are playing, needs reset, then
+	alive and reloading for each player.
+
+	A pool is its live count, then each live entity. One
+	that the baseline also has a live entity for starts
+	with a bit for whether it changed, and unchanged ones
+	stop there. The rest give a bit for each field the
+	pool sends, set if the field differs from the baseline
+	entity (or from zero, for entities the baseline doesn't
+	have). Each field that differs is a 0 bit and the
+	change, zigzagged into NET_DELTA_BITS, or a 1 bit and
+	the whole value.
+
+	Pools are packed at the front, so the live count says
+	which entities are present. Removing one moves the last
+	into its place, which is sent as that entity changing.
+	Players keep their slot, so their count is up to the
+	last player that has joined.
+*/
+
+#define NET_FLAG_BITS (2 + 2*PLAYER_MAX)
+
+// Where each pool starts in NetState entities
+static const Uint16 	net_pool_offsets[net_pool_count] =
+{
+	0,
+	PLAYER_MAX,
+	PLAYER_MAX + POOLSIZE_ENEMY,
+	PLAYER_MAX + POOLSIZE_ENEMY + POOLSIZE_FRIENDLY_PROJ,
+};
+
+static const Uint16 	net_pool_capacities[net_pool_count] =
+{
+	PLAYER_MAX,
+	POOLSIZE_ENEMY,
+	POOLSIZE_FRIENDLY_PROJ,
+	POOLSIZE_ENEMY_PROJ,
+};
+
+// Bits to send each live count in
+static const Uint8 		net_pool_count_bits[net_pool_count] = { 3, 5, 4, 12 };
+
+// Fields each pool sends, in order. Enemy projectiles get
+// their velocity from their path, so only send where they are
+static const Uint8 		net_pool_field_counts[net_pool_count] = { 6, 6, 5, 3 };
+
+static const NetField 	net_pool_fields[net_pool_count][net_field_count] =
+{
+	{ NET_FIELD_X, NET_FIELD_Y, NET_FIELD_VEL_X, NET_FIELD_VEL_Y, NET_FIELD_HP, NET_FIELD_LOOK },
+	{ NET_FIELD_X, NET_FIELD_Y, NET_FIELD_VEL_X, NET_FIELD_VEL_Y, NET_FIELD_HP, NET_FIELD_LOOK },
+	{ NET_FIELD_X, NET_FIELD_Y, NET_FIELD_VEL_X, NET_FIELD_VEL_Y, NET_FIELD_LOOK },
+	{ NET_FIELD_X, NET_FIELD_Y, NET_FIELD_LOOK },
+};
+
+static const Uint8 		net_field_bits[net_field_count] =
+{
+	NET_POS_BITS,
+	NET_POS_BITS,
+	NET_VEL_BITS,
+	NET_VEL_BITS,
+	16,
+	16,
+};
+
+static const NetEntity 	net_entity_zero = {};
+
+// Writes bits into a buffer, 32 at a time
+struct NetBitWriter
+{
+	Uint8*					data;
+	Uint32					capacity;
+	Uint32					size;
+	Uint64					scratch;
+	Uint32					scratch_bits;
+	bool					overflow;
+};
+
+// Reads bits out of a buffer, 32 at a time
+struct NetBitReader
+{
+	const Uint8*			data;
+	Uint32					size;
+	Uint32					at;
+	Uint64					scratch;
+	Uint32					scratch_bits;
+	bool					overflow;
+};
+
+/*
+	Net Bits Write
+
+	Purpose: Writes the low bits of a value.
+
+	Parameters: Writer - the bit writer
+				Value - the value
+				Count - how many bits, up to 32
+
+	Return:	Nil
+*/
+
+static inline void 	NetBitsWrite( NetBitWriter* writer, Uint32 value, Uint32 count )
+{
+	writer->scratch |= ( (Uint64)value & ( ( (Uint64)1 << count ) - 1 ) ) << writer->scratch_bits;
+	writer->scratch_bits += count;
+
+	if ( writer->scratch_bits < 32 )
+		return;
+
+	if ( writer->size + 4 > writer->capacity )
+		writer->overflow = true;
+	else
+	{
+		Uint32 word = (Uint32)writer->scratch;
+		memcpy( writer->data + writer->size, &word, 4 );
+		writer->size += 4;
+	}
+
+	writer->scratch >>= 32;
+	writer->scratch_bits -= 32;
+}
+
+/*
+	Net Bits Flush
+
+	Purpose: Writes out the bits still held, padding the
+			last byte with zeros.
+
+	Parameters: Writer - the bit writer
+
+	Return:	The bytes written, or 0 if they didn't fit
+*/
+
+static Uint32 	NetBitsFlush( NetBitWriter* writer )
+{
+	for( ; writer->scratch_bits > 0 && !writer->overflow; writer->scratch >>= 8 )
+	{
+		if ( writer->size >= writer->capacity )
+			writer->overflow = true;
+		else
+			writer->data[writer->size++] = (Uint8)writer->scratch;
+
+		writer->scratch_bits = ( writer->scratch_bits > 8 ? writer->scratch_bits - 8 : 0 );
+	}
+
+	return ( writer->overflow ? 0 : writer->size );
+}
+
+/*
+	Net Bits Read
+
+	Purpose: Reads bits. Reading past the end gives
+			zeros, and marks the reader.
+
+	Parameters: Reader - the bit reader
+				Count - how many bits, up to 32
+
+	Return:	The value
+*/
+
+static inline Uint32 	NetBitsRead( NetBitReader* reader, Uint32 count )
+{
+	if ( reader->scratch_bits < count )
+	{
+		Uint32 word = 0;
+		Uint32 left = reader->size - reader->at;
+
+		if ( left >= 4 )
+			memcpy( &word, reader->data + reader->at, 4 );
+		else if ( left > 0 )
+			memcpy( &word, reader->data + reader->at, left );
+		else
+			reader->overflow = true;
+
+		reader->at += ( left >= 4 ? 4 : left );
+		reader->scratch |= (Uint64)word << reader->scratch_bits;
+		reader->scratch_bits += 32;
+	}
+
+	Uint32 value = (Uint32)( reader->scratch & ( ( (Uint64)1 << count ) - 1 ) );
+	reader->scratch >>= count;
+	reader->scratch_bits -= count;
+
+	return value;
+}
+
+/*
+	Net Quantize Position
+
+	Purpose: Turns a position into fixed point.
+
+	Parameters: Value - the position, in pixels
+
+	Return:	The fixed point position, clamped to
+			NET_POS_BITS
+*/
+
+static inline Uint16 	NetQuantizePosition( float value )
+{
+	Sint32 fixed = (Sint32)floorf( ( value + NET_POS_OFFSET ) * NET_POS_SCALE + 0.5f );
+
+	if ( fixed < 0 )
+		fixed = 0;
+	if ( fixed > (1 << NET_POS_BITS) - 1 )
+		fixed = (1 << NET_POS_BITS) - 1;
+
+	return (Uint16)fixed;
+}
+
+/*
+	Net Quantize Velocity
+
+	Purpose: Turns a velocity into fixed point.
+
+	Parameters: Value - the velocity, in pixels per tick
+
+	Return:	The fixed point velocity, clamped and
+			stored in the low NET_VEL_BITS
+*/
+
+static inline Uint16 	NetQuantizeVelocity( float value )
+{
+	Sint32 fixed = (Sint32)floorf( value * NET_VEL_SCALE + 0.5f );
+
+	if ( fixed < -(1 << (NET_VEL_BITS-1)) )
+		fixed = -(1 << (NET_VEL_BITS-1));
+	if ( fixed > (1 << (NET_VEL_BITS-1)) - 1 )
+		fixed = (1 << (NET_VEL_BITS-1)) - 1;
+
+	return (Uint16)( fixed & ((1 << NET_VEL_BITS) - 1) );
+}
+
+/*
+	Net State Position
+
+	Purpose: Turns a quantized position back into pixels.
+
+	Parameters: Value - the quantized position
+
+	Return:	The position, in pixels
+*/
+
+float 			NetStatePosition( Uint16 value )
+{
+	return (float)value / NET_POS_SCALE - NET_POS_OFFSET;
+}
+
+/*
+	Net State Velocity
+
+	Purpose: Turns a quantized velocity back into pixels
+			per tick.
+
+	Parameters: Value - the quantized velocity
+
+	Return:	The velocity, in pixels per tick
+*/
+
+float 			NetStateVelocity( Uint16 value )
+{
+	Sint32 fixed = value;
+	if ( fixed & (1 << (NET_VEL_BITS-1)) )
+		fixed -= (1 << NET_VEL_BITS);
+
+	return (float)fixed / NET_VEL_SCALE;
+}
+
+/*
+	Net Entity Set
+
+	Purpose: Fills in a quantized entity.
+
+	Parameters: Entity - the entity
+				Pos, Vel - its position and velocity
+				HP - its hit points
+				Look - its type or animation, and frame
+
+	Return:	Nil
+*/
+
+static inline void 	NetEntitySet( NetEntity* entity, const Vector2D& pos, const Vector2D& vel, Sint16 hp, Uint16 look )
+{
+	entity->fields[NET_FIELD_X] 	= NetQuantizePosition( pos.x );
+	entity->fields[NET_FIELD_Y] 	= NetQuantizePosition( pos.y );
+	entity->fields[NET_FIELD_VEL_X] = NetQuantizeVelocity( vel.x );
+	entity->fields[NET_FIELD_VEL_Y] = NetQuantizeVelocity( vel.y );
+	entity->fields[NET_FIELD_HP] 	= (Uint16)hp;
+	entity->fields[NET_FIELD_LOOK] 	= look;
+}
+
+/*
+	Net Look
+
+	Purpose: Packs what an entity looks like: its type or
+			animation, and its frame.
+
+	Parameters: Kind - the type or animation
+				Ani - the animation it is playing
+
+	Return:	The look
+*/
+
+static inline Uint16 	NetLook( Uint16 kind, const Animation* ani )
+{
+	return (Uint16)( ( kind << 8 ) | ( ( ani->position >> 16 ) & 0xFF ) );
+}
+
+/*
+	Net State Capture
+
+	Purpose: Quantizes what clients see of the game as it
+			is now.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Tick - the number to give the state
+				State - where to put it
+
+	Return:	Nil
+*/
+
+void 			NetStateCapture( Game* game, Uint32 tick, NetState* state )
+{
+	const Vector2D still( 0, 0 );
+
+	state->tick 		= tick;
+	state->score 		= game->score;
+	state->high_score 	= game->high_score;
+	state->flags 		= (Uint16)( game->playing | ( game->needs_reset << 1 ) );
+
+	// Players, up to the last one in the game
+	NetEntity* entities = state->entities + net_pool_offsets[NET_POOL_PLAYERS];
+	state->counts[NET_POOL_PLAYERS] = 0;
+
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+	{
+		const Player* player = &(game->players[p]);
+
+		state->flags |= (Uint16)( ( player->alive << (2 + 2*p) ) | ( player->reloading << (3 + 2*p) ) );
+
+		NetEntitySet( &(entities[p]), player->pos, player->vel, player->hp,
+					  NetLook( player->ship_ani.def, &(player->ship_ani) ) );
+
+		if ( player->joined )
+			state->counts[NET_POOL_PLAYERS] = p + 1;
+	}
+
+	// Enemies
+	entities = state->entities + net_pool_offsets[NET_POOL_ENEMIES];
+	state->counts[NET_POOL_ENEMIES] = game->enemy_count;
+
+	for( Uint16 i = 0; i < game->enemy_count; i++ )
+	{
+		const Enemy* enemy = &(game->enemies[i]);
+		const EnemyCold* cold = &(game->enemies_cold[i]);
+
+		NetEntitySet( &(entities[i]), enemy->pos, enemy->vel, enemy->hp, NetLook( cold->type, &(cold->ship_ani) ) );
+	}
+
+	// Friendly Projectiles
+	entities = state->entities + net_pool_offsets[NET_POOL_PROJECTILES_FRIENDLY];
+	state->counts[NET_POOL_PROJECTILES_FRIENDLY] = game->proj_friendly_count;
+
+	for( Uint16 i = 0; i < game->proj_friendly_count; i++ )
+	{
+		const Projectile* proj = &(game->projectiles_friendly[i]);
+		NetEntitySet( &(entities[i]), proj->pos, proj->vel, 0, NetLook( proj->ani.def, &(proj->ani) ) );
+	}
+
+	// Enemy Projectiles, without velocity
+	entities = state->entities + net_pool_offsets[NET_POOL_PROJECTILES_ENEMY];
+	state->counts[NET_POOL_PROJECTILES_ENEMY] = game->proj_enemy_count;
+
+	for( Uint16 i = 0; i < game->proj_enemy_count; i++ )
+	{
+		const Projectile* proj = &(game->projectiles_enemy[i]);
+		NetEntitySet( &(entities[i]), proj->pos, still, 0, NetLook( proj->ani.def, &(proj->ani) ) );
+	}
+}
+
+/*
+	Net State Encode
+
+	Purpose: Packs a state, as changes from a baseline the
+			receiver already has.
+
+	Parameters: State - the state to send
+				Baseline - a state the receiver has, or
+					nullptr to send the whole state
+				Data - where to put the encoded state
+				Capacity - the size of Data
+
+	Return:	The encoded size, or 0 if it didn't fit
+*/
+
+Uint32 			NetStateEncode( const NetState* state, const NetState* baseline, Uint8* data, Uint32 capacity )
+{
+	NetBitWriter writer = { data, capacity, 0, 0, 0, false };
+
+	NetBitsWrite( &writer, state->tick, 32 );
+	NetBitsWrite( &writer, baseline != nullptr ? baseline->tick : NET_TICK_NONE, 32 );
+	NetBitsWrite( &writer, state->score, 32 );
+	NetBitsWrite( &writer, state->high_score, 32 );
+	NetBitsWrite( &writer, state->flags, NET_FLAG_BITS );
+
+	for( Uint16 p = 0; p < net_pool_count; p++ )
+	{
+		const NetEntity* entities = state->entities + net_pool_offsets[p];
+		const NetEntity* base_entities = ( baseline != nullptr ? baseline->entities + net_pool_offsets[p] : nullptr );
+
+		Uint16 count = state->counts[p];
+		Uint16 base_count = ( baseline != nullptr ? baseline->counts[p] : 0 );
+		const NetField* fields = net_pool_fields[p];
+		Uint16 field_count = net_pool_field_counts[p];
+
+		NetBitsWrite( &writer, count, net_pool_count_bits[p] );
+
+		for( Uint16 i = 0; i < count; i++ )
+		{
+			const NetEntity* entity = &(entities[i]);
+			const NetEntity* base = ( i < base_count ? &(base_entities[i]) : &net_entity_zero );
+
+			// Fields that differ, one bit per field the pool sends
+			Uint32 changed = 0;
+			for( Uint16 k = 0; k < field_count; k++ )
+				changed |= (Uint32)( entity->fields[fields[k]] != base->fields[fields[k]] ) << k;
+
+			if ( i < base_count )
+			{
+				NetBitsWrite( &writer, changed != 0, 1 );
+				if ( changed == 0 )
+					continue;
+			}
+
+			NetBitsWrite( &writer, changed, field_count );
+
+			for( Uint16 k = 0; k < field_count; k++ )
+			{
+				if ( !( changed & (1 << k) ) )
+					continue;
+
+				Uint16 f = fields[k];
+				Uint32 bits = net_field_bits[f];
+				Uint32 range = (1u << bits) - 1;
+
+				// Change, wrapped to the field's width
+				Uint32 diff = (Uint32)( entity->fields[f] - base->fields[f] ) & range;
+				Sint32 delta = ( diff & (1u << (bits-1)) ) ? (Sint32)diff - (Sint32)(1u << bits) : (Sint32)diff;
+				Uint32 zigzag = ( (Uint32)delta << 1 ) ^ (Uint32)( delta >> 31 );
+
+				// Picked without a branch, as bullets go either way at random
+				bool small = ( zigzag < (1u << NET_DELTA_BITS) );
+				Uint32 value = ( small ? zigzag << 1 : 1 | ( (Uint32)entity->fields[f] << 1 ) );
+				Uint32 count = ( small ? 1 + NET_DELTA_BITS : 1 + bits );
+
+				NetBitsWrite( &writer, value, count );
+			}
+		}
+	}
+
+	return NetBitsFlush( &writer );
+}
+
+/*
+	Net State Peek
+
+	Purpose: Reads which tick an encoded state is, and
+			which tick it was encoded against.
+
+	Parameters: Data - the encoded state
+				Size - its size
+				Tick - receives the state's tick
+				Baseline Tick - receives the baseline's
+					tick, or NET_TICK_NONE
+
+	Return:	True if Data is big enough to hold them
+*/
+
+bool 			NetStatePeek( const Uint8* data, Uint32 size, Uint32* tick, Uint32* baseline_tick )
+{
+	if ( size < 8 )
+		return false;
+
+	memcpy( tick, data, 4 );
+	memcpy( baseline_tick, data + 4, 4 );
+	return true;
+}
+
+/*
+	Net State Decode
+
+	Purpose: Unpacks an encoded state into the history,
+			against the baseline it was encoded from. If
+			the history doesn't have the baseline any more,
+			the sender needs to send a whole state.
+
+	Parameters: Data - the encoded state
+				Size - its size
+				History - states decoded so far, which
+					the new one is added to
+
+	Return:	The decoded state, or nullptr if it couldn't
+			be decoded
+*/
+
+NetState* 		NetStateDecode( const Uint8* data, Uint32 size, NetStateHistory* history )
+{
+	Uint32 tick, baseline_tick;
+	if ( !NetStatePeek( data, size, &tick, &baseline_tick ) || tick == NET_TICK_NONE )
+		return nullptr;
+
+	const NetState* baseline = nullptr;
+	if ( baseline_tick != NET_TICK_NONE )
+	{
+		baseline = NetStateHistoryFind( history, baseline_tick );
+		if ( baseline == nullptr )
+			return nullptr;
+	}
+
+	Uint16 base_counts[net_pool_count] = {};
+	if ( baseline != nullptr )
+		memcpy( base_counts, baseline->counts, sizeof(base_counts) );
+
+	// The baseline may be in the slot being decoded into, so
+	// each entity reads its baseline before it is written
+	NetState* state = NetStateHistoryAdd( history, tick );
+
+	NetBitReader reader = { data, size, 0, 0, 0, false };
+	NetBitsRead( &reader, 32 );
+	NetBitsRead( &reader, 32 );
+
+	state->score 		= NetBitsRead( &reader, 32 );
+	state->high_score 	= NetBitsRead( &reader, 32 );
+	state->flags 		= (Uint16)NetBitsRead( &reader, NET_FLAG_BITS );
+
+	for( Uint16 p = 0; p < net_pool_count && !reader.overflow; p++ )
+	{
+		NetEntity* entities = state->entities + net_pool_offsets[p];
+		const NetEntity* base_entities = ( baseline != nullptr ? baseline->entities + net_pool_offsets[p] : nullptr );
+		const NetField* fields = net_pool_fields[p];
+		Uint16 field_count = net_pool_field_counts[p];
+
+		Uint16 count = (Uint16)NetBitsRead( &reader, net_pool_count_bits[p] );
+		if ( count > net_pool_capacities[p] )
+		{
+			reader.overflow = true;
+			break;
+		}
+
+		state->counts[p] = count;
+
+		for( Uint16 i = 0; i < count; i++ )
+		{
+			// Fields the pool doesn't send are zero in the baseline too
+			NetEntity base = ( i < base_counts[p] ? base_entities[i] : net_entity_zero );
+			NetEntity* entity = &(entities[i]);
+
+			*entity = base;
+
+			if ( i < base_counts[p] && NetBitsRead( &reader, 1 ) == 0 )
+				continue;
+
+			Uint32 changed = NetBitsRead( &reader, field_count );
+
+			for( Uint16 k = 0; k < field_count; k++ )
+			{
+				if ( !( changed & (1 << k) ) )
+					continue;
+
+				Uint16 f = fields[k];
+				Uint32 bits = net_field_bits[f];
+				Uint32 range = (1u << bits) - 1;
+
+				if ( NetBitsRead( &reader, 1 ) == 0 )
+				{
+					Uint32 zigzag = NetBitsRead( &reader, NET_DELTA_BITS );
+					Sint32 delta = (Sint32)( zigzag >> 1 ) ^ -(Sint32)( zigzag & 1 );
+
+					entity->fields[f] = (Uint16)( ( base.fields[f] + delta ) & range );
+				}
+				else
+					entity->fields[f] = (Uint16)NetBitsRead( &reader, bits );
+			}
+		}
+	}
+
+	if ( reader.overflow )
+	{
+		state->tick = NET_TICK_NONE;
+		return nullptr;
+	}
+
+	return state;
+}
+
+/*
+	Net State Equal
+
+	Purpose: Checks two states hold the same ticks and
+			entities.
+
+	Parameters: A, B - the states
+
+	Return:	True if they match
+*/
+
+bool 			NetStateEqual( const NetState* a, const NetState* b )
+{
+	if ( a->tick != b->tick || a->score != b->score || a->high_score != b->high_score || a->flags != b->flags )
+		return false;
+
+	for( Uint16 p = 0; p < net_pool_count; p++ )
+	{
+		if ( a->counts[p] != b->counts[p] )
+			return false;
+
+		if ( memcmp( a->entities + net_pool_offsets[p], b->entities + net_pool_offsets[p],
+					 a->counts[p] * sizeof(NetEntity) ) != 0 )
+			return false;
+	}
+
+	return true;
+}
+
+/*
+	Net State History Find
+
+	Purpose: Finds a state in the history.
+
+	Parameters: History - the history
+				Tick - the state's tick
+
+	Return:	The state, or nullptr if it isn't kept
+*/
+
+NetState* 		NetStateHistoryFind( NetStateHistory* history, Uint32 tick )
+{
+	if ( tick == NET_TICK_NONE )
+		return nullptr;
+
+	NetState* state = &(history->states[tick % NET_STATE_HISTORY]);
+	return ( state->tick == tick ? state : nullptr );
+}
+
+/*
+	Net State History Add
+
+	Purpose: Makes room for a state in the history, in
+			place of the oldest.
+
+	Parameters: History - the history
+				Tick - the state's tick
+
+	Return:	The state to fill in
+*/
+
+NetState* 		NetStateHistoryAdd( NetStateHistory* history, Uint32 tick )
+{
+	NetState* state = &(history->states[tick % NET_STATE_HISTORY]);
+	state->tick = tick;
+
+	return state;
+}
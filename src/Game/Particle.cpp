@@ -6,146 +6,388 @@
 /** functionality. 					**/
 /*************************************/
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include "Game.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
 /*
-	Particle Init
+	How each PartType is spawned and drawn, indexed by
+	PartType. A spawn is one burst from its emitter.
+*/
+
+static constexpr ParticleEmitterDef particle_emitters[part_type_count] =
+{
+	// Burst	Speed		Life		Frames	Row		Size	Color				Also
+	{ 1,		0, 0,		30, 30,		6,		0,		0,		{ 0, 0, 0, 0 },		PART_SPARK },
+	{ 24,		1, 4,		10, 25,		0,		0,		2,		{ 255, 200, 64, 255 },	part_type_count },
+};
 
-	Purpose: Called once to initialise an particles
-			engine data.
+/*
+	Particle Random
 
-	Parameters: Part - a pointer to the particle to
-					Affect.
+	Purpose: A small random number generator, kept
+			apart from rand() so that particles, which
+			are only for show, don't change the enemy
+			spawns.
 
-	Return:	Nil
+	Parameters: Sys - the particle system
+
+	Return:	A random value from 0 to 1
 */
 
-void 			ParticleInit( Particle* part )
+static inline float 	ParticleRandom( ParticleSystem* sys )
 {
-	part->texture = GameFindTexture( part->runner, "Primary" );
-	part->ani.loops = false;
+	// Xorshift
+	Uint32 x = sys->seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	sys->seed = x;
+
+	return (x >> 8) * (1.0f / 16777216.0f);
 }
 
 /*
-	Particle Spawn
+	Particle System Init
 
-	Purpose: Used to spawn a new instance of a particle,
-			setting it up to be a specific type.
+	Purpose: Allocates the particle arrays. This is the
+			only allocation the particle system makes.
 
-	Parameters: Part - a pointer to the particle to
-					Affect.
-				Pos - the position where the particle
-					should appear.
-				Type - the predefined type we want the
-					particle to be.
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Sys - the particle system
+				Capacity - the most particles that can
+					ever be alive at once
 
-	Return:	True if we spawn the particle successfully,
-			False if we fail
+	Return:	True if the arrays were allocated
 */
 
-bool 			ParticleSpawn( Particle* part, const Vector2D& pos, PartType type )
+bool 			ParticleSystemInit( Game* game, ParticleSystem* sys, Uint32 capacity )
 {
-	// Check that we are not overwritting an already alive particle
-	if (part->alive == true)
-		return false;
+	// Round up, so the update can work in whole blocks
+	capacity = (capacity + 7) & ~7u;
 
-	// Setup Consistent Properties
-	part->alive = true;
-	part->pos = pos;
+	// One block, split into 32 byte aligned arrays
+	const Uint32 array_size = capacity * 4;
+	const Uint32 array_count = 9;
 
-	switch(type)
+	sys->memory = calloc( 1, array_size * array_count + 32 );
+	if ( sys->memory == nullptr )
 	{
-		case PART_EXPLOSION_01:
-		{
-			part->ani.image_index = 0;
-			part->ani.image_speed = 0.2;
-			part->ani.image_count = 6;
-			part->ani.y_offset = 0;
+		printf( "Error: Unable to allocate %u particles\n", capacity );
+		sys->capacity = 0;
+		sys->budget = 0;
+		return false;
+	}
 
-			return true;
-		}
-		break;
+	Uint8* base = (Uint8*)( ((uintptr_t)sys->memory + 31) & ~(uintptr_t)31 );
+
+	sys->pos_x 			= (float*)(base + array_size*0);
+	sys->pos_y 			= (float*)(base + array_size*1);
+	sys->vel_x 			= (float*)(base + array_size*2);
+	sys->vel_y 			= (float*)(base + array_size*3);
+	sys->age 			= (float*)(base + array_size*4);
+	sys->life 			= (float*)(base + array_size*5);
+	sys->frame_scale 	= (float*)(base + array_size*6);
+	sys->frame 			= (Sint32*)(base + array_size*7);
+	sys->type 			= (Uint32*)(base + array_size*8);
+
+	sys->capacity 		= capacity;
+	sys->budget 		= ( PARTICLE_BUDGET < capacity ? PARTICLE_BUDGET : capacity );
+	sys->count 			= 0;
+	sys->dropped 		= 0;
+	sys->texture 		= GameFindTexture( game, "Primary" );
+
+	return true;
+}
 
-		default:
-		{
-			return false;
-		}
-		break;
-	}
+/*
+	Particle System Free
+
+	Purpose: Frees the particle arrays.
+
+	Parameters: Sys - the particle system
+
+	Return:	Nil
+*/
+
+void 			ParticleSystemFree( ParticleSystem* sys )
+{
+	free( sys->memory );
+
+	sys->memory 	= nullptr;
+	sys->capacity 	= 0;
+	sys->budget 	= 0;
+	sys->count 		= 0;
 }
 
 /*
-	Particle Swap
+	Particle System Clear
 
-	Purpose: Used to swap the values of two particle
-			objects.
+	Purpose: Kills every particle.
 
-	Parameters: P1 - the first particle in the swap.
-				P2 - the second particle in the swap.
+	Parameters: Sys - the particle system
 
 	Return:	Nil
 */
 
-void 			ParticleSwap( Particle* p1, Particle* p2 )
+void 			ParticleSystemClear( ParticleSystem* sys )
 {
-	// Check for difference to swap
-	if (p1 == p2)
-		return;
+	sys->count = 0;
+}
+
+/*
+	Particle System Set Budget
+
+	Purpose: Sets how many particles may be alive at
+			once. Lower it to save time on slow machines.
+			It can't go above the capacity the system
+			was made with.
+
+	Parameters: Sys - the particle system
+				Budget - the new budget
+
+	Return:	Nil
+*/
+
+void 			ParticleSystemSetBudget( ParticleSystem* sys, Uint32 budget )
+{
+	sys->budget = ( budget < sys->capacity ? budget : sys->capacity );
+}
+
+/*
+	Particle Emit
+
+	Purpose: Spawns one burst of particles of a type.
+			As the system fills up, bursts get smaller,
+			so the first particle of each burst (the one
+			players notice) keeps getting through. Any
+			particles left out are counted as dropped.
+
+	Parameters: Sys - the particle system
+				Pos - the position of the burst
+				Type - the type of particle
+
+	Return:	The number of particles spawned
+*/
+
+Uint32 			ParticleEmit( ParticleSystem* sys, const Vector2D& pos, PartType type )
+{
+	if ( type >= part_type_count )
+		return 0;
+
+	const ParticleEmitterDef* def = &(particle_emitters[type]);
+
+	Uint32 burst = def->burst;
+	Uint32 room = ( sys->count < sys->budget ? sys->budget - sys->count : 0 );
 
-	// Create Temporary Particle to Go Between
-	Particle temp = *p1;
+	// Past half the budget, scale bursts down with the room left
+	if ( burst > 1 && room < sys->budget / 2 )
+	{
+		Uint32 scaled = (Uint32)( (Uint64)burst * room * 2 / (sys->budget > 0 ? sys->budget : 1) );
+		burst = ( scaled > 0 ? scaled : 1 );
+	}
+
+	if ( burst > room )
+		burst = room;
 
-	// Set P1 to P2
-	*p1 = *p2;
+	sys->dropped += def->burst - burst;
+
+	for( Uint32 n = 0; n < burst; n++ )
+	{
+		Uint32 i = sys->count++;
+
+		float life = def->life_min + (def->life_max - def->life_min) * ParticleRandom( sys );
+		float speed = def->speed_min + (def->speed_max - def->speed_min) * ParticleRandom( sys );
+		float angle = ParticleRandom( sys ) * 6.2831853f;
+
+		sys->pos_x[i] 		= pos.x;
+		sys->pos_y[i] 		= pos.y;
+		sys->vel_x[i] 		= cosf( angle ) * speed;
+		sys->vel_y[i] 		= sinf( angle ) * speed;
+		sys->age[i] 		= 0;
+		sys->life[i] 		= life;
+		sys->frame_scale[i] = def->frame_count / life;
+		sys->frame[i] 		= 0;
+		sys->type[i] 		= type;
+	}
 
-	// Set P2 to Temp (previous P1)
-	*p2 = temp;
+	// Spawn anything that goes with it
+	if ( def->also < part_type_count )
+		burst += ParticleEmit( sys, pos, def->also );
 
+	return burst;
 }
 
 /*
-	Particle Update
+	Particle System Update
 
-	Purpose: Called to update the particle animation
-			and check for particle death.
+	Purpose: Moves and ages every particle, works out
+			its sprite frame, and removes the ones that
+			have run out of life. Particles are worked on
+			four at a time where SSE2 is available.
 
-	Parameters: Part - a pointer to the particle to
-					Affect.
+	Parameters: Sys - the particle system
 
-	Return:	True if the particle ends the update alive
-			False otherwise
+	Return:	Nil
 */
 
-bool 			ParticleUpdate( Particle* part, Uint32 dt )
+void 			ParticleSystemUpdate( ParticleSystem* sys )
 {
-	// Update Animation
-	AnimationUpdate(&(part->ani));
+	// Capacity is a multiple of 8, so whole blocks stay inside the arrays
+	Uint32 blocks = (sys->count + 3) & ~3u;
+	Uint32 i = 0;
+
+	// Set if anything ran out of life
+	bool deaths = false;
+
+	#ifdef __SSE2__
+	const __m128 one = _mm_set1_ps( 1.0f );
+	int dead = 0;
+
+	for( ; i < blocks; i += 4 )
+	{
+		__m128 x = _mm_add_ps( _mm_load_ps( sys->pos_x + i ), _mm_load_ps( sys->vel_x + i ) );
+		__m128 y = _mm_add_ps( _mm_load_ps( sys->pos_y + i ), _mm_load_ps( sys->vel_y + i ) );
+		__m128 age = _mm_add_ps( _mm_load_ps( sys->age + i ), one );
+		__m128i frame = _mm_cvttps_epi32( _mm_mul_ps( age, _mm_load_ps( sys->frame_scale + i ) ) );
+
+		_mm_store_ps( sys->pos_x + i, x );
+		_mm_store_ps( sys->pos_y + i, y );
+		_mm_store_ps( sys->age + i, age );
+		_mm_store_si128( (__m128i*)(sys->frame + i), frame );
+
+		// Lanes past the last particle are padding, whatever their age
+		int lanes = _mm_movemask_ps( _mm_cmpge_ps( age, _mm_load_ps( sys->life + i ) ) );
+		if ( sys->count - i < 4 )
+			lanes &= ( 1 << (sys->count - i) ) - 1;
+
+		dead |= lanes;
+	}
 
-	// Check For Animation Death
-	if (part->ani.image_speed == 0)
-		part->alive = false;
+	deaths = ( dead != 0 );
+	#endif // __SSE2__
 
-	return part->alive;
+	for( ; i < blocks; i++ )
+	{
+		sys->pos_x[i] 	+= sys->vel_x[i];
+		sys->pos_y[i] 	+= sys->vel_y[i];
+		sys->age[i] 	+= 1;
+		sys->frame[i] 	= (Sint32)( sys->age[i] * sys->frame_scale[i] );
+
+		deaths |= ( i < sys->count && sys->age[i] >= sys->life[i] );
+	}
+
+	if ( !deaths )
+		return;
+
+	// Remove Dead Particles, moving the last one into the gap
+	for( Uint32 p = 0; p < sys->count; )
+	{
+		if ( sys->age[p] < sys->life[p] )
+		{
+			++p;
+			continue;
+		}
+
+		Uint32 last = --sys->count;
+
+		sys->pos_x[p] 		= sys->pos_x[last];
+		sys->pos_y[p] 		= sys->pos_y[last];
+		sys->vel_x[p] 		= sys->vel_x[last];
+		sys->vel_y[p] 		= sys->vel_y[last];
+		sys->age[p] 		= sys->age[last];
+		sys->life[p] 		= sys->life[last];
+		sys->frame_scale[p] = sys->frame_scale[last];
+		sys->frame[p] 		= sys->frame[last];
+		sys->type[p] 		= sys->type[last];
+	}
 }
 
 /*
-	Particle Render
+	Particle System Render
 
-	Purpose: Called to draw the particle.
+	Purpose: Draws every particle. Types with sprite
+			frames are drawn from the sprite sheet, and
+			types without are gathered up and drawn as
+			filled rectangles, many per draw call.
 
-	Parameters: Part - a pointer to the particle to
-					Affect.
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Sys - the particle system
 
 	Return:	Nil
 */
 
-void 			ParticleRender( Particle* part )
+void 			ParticleSystemRender( Game* game, ParticleSystem* sys )
 {
-	int pos_x = (int)roundf(part->pos.x-16);
-	int pos_y = (int)roundf(part->pos.y-16);
+	static const Uint32 batch_size = 256;
+
+	SDL_Rect rects[part_type_count][batch_size];
+	Uint32 rect_count[part_type_count] = {};
 
-    TextureRender(	part->texture, part->runner->render,
-					pos_x, pos_y, &(part->ani.rect) );
+	for( Uint32 i = 0; i < sys->count; i++ )
+	{
+		PartType type = (PartType)sys->type[i];
+		const ParticleEmitterDef* def = &(particle_emitters[type]);
+
+		// Sprites
+		if ( def->frame_count > 0 )
+		{
+			SDL_Rect clip = { sys->frame[i] * 32, def->y_offset, 32, 32 };
+
+			TextureRender( sys->texture, game->render,
+						   (int)roundf(sys->pos_x[i]-16), (int)roundf(sys->pos_y[i]-16), &clip );
+			continue;
+		}
+
+		// Rectangles, drawn a batch at a time
+		SDL_Rect* rect = &(rects[type][rect_count[type]++]);
+		rect->x = (int)sys->pos_x[i] - def->size/2;
+		rect->y = (int)sys->pos_y[i] - def->size/2;
+		rect->w = def->size;
+		rect->h = def->size;
+
+		if ( rect_count[type] == batch_size )
+		{
+			SDL_SetRenderDrawColor( game->render, def->color.r, def->color.g, def->color.b, def->color.a );
+			SDL_RenderFillRects( game->render, rects[type], rect_count[type] );
+			rect_count[type] = 0;
+		}
+	}
+
+	// Draw what's left in each batch
+	for( Uint16 t = 0; t < part_type_count; t++ )
+	{
+		if ( rect_count[t] == 0 )
+			continue;
+
+		const ParticleEmitterDef* def = &(particle_emitters[t]);
+		SDL_SetRenderDrawColor( game->render, def->color.r, def->color.g, def->color.b, def->color.a );
+		SDL_RenderFillRects( game->render, rects[t], rect_count[t] );
+	}
+}
+
+/*
+	Particle Emitter Get
+
+	Purpose: Gets how a type of particle is spawned and
+			drawn, for anything drawing particles besides
+			Particle System Render.
+
+	Parameters: Type - the particle type
+
+	Return:	The emitter definition
+*/
+
+const ParticleEmitterDef* 	ParticleEmitterGet( PartType type )
+{
+	return &(particle_emitters[type]);
 }
@@ -11,48 +11,146 @@
 
 #include "Game.h"
 
+// Where each player starts, across the screen
+static const float 	player_spawn_x[PLAYER_MAX] = { 0.5f, 0.25f, 0.75f, 0.125f };
+
+// Colour each player's ship is tinted, so they can tell them apart
+static const SDL_Color 	player_tints[PLAYER_MAX] =
+{
+	{ 0xFF, 0xFF, 0xFF, 0xFF },
+	{ 0x80, 0xFF, 0x80, 0xFF },
+	{ 0xFF, 0xC0, 0x60, 0xFF },
+	{ 0xC0, 0x90, 0xFF, 0xFF },
+};
+
 /*
 	Player Setup
 
 	Purpose: Sets up a player to a default state,
-			just before the game starts
+			just before the game starts. Players sit
+			out until they join.
 
-	Parameters: Player - a pointer pointing to the
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Player - a pointer pointing to the
 					player object.
+				Index - the player's slot in the game
 
 	Return:	Nil
 */
 
-void 			PlayerSetup( Player* player )
+void 			PlayerSetup( Game* game, Player* player, Uint16 index )
 {
-    player->pos 					= Vector2D( SCREEN_WIDTH*0.5, SCREEN_HEIGHT*0.5 );
-    player->vel 					= Vector2D(0,0);
+	player->index 					= index;
+	player->joined 					= false;
+	player->alive 					= false;
+
+	player->sprite_texture 			= GameFindTexture( game, "Primary" );
+
+	player->col_offset.x 			= 4;
+	player->col_offset.y 			= 4;
+
+	AnimationStart( &(player->ship_ani), ANIMATION_PLAYER );
 
-	player->alive 					= true;
+	PlayerSpawn( game, player );
+}
+
+/*
+	Player Spawn
+
+	Purpose: Puts a player back at their start, with
+			full health. Called for every player that
+			has joined when the game resets, and for a
+			player joining a game in progress.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Player - a pointer pointing to the
+					player object.
+
+	Return:	Nil
+*/
+
+void 			PlayerSpawn( Game* game, Player* player )
+{
+    player->pos 					= Vector2D( SCREEN_WIDTH*player_spawn_x[player->index], SCREEN_HEIGHT*0.5 );
+    player->vel.zero();
+    player->moved.zero();
+
+	player->alive 					= player->joined;
 	player->hp 						= 100;
 	player->hp_max 					= 100;
+	player->reloading 				= false;
+}
 
-	player->sprite_texture 			= GameFindTexture( player->runner, "Primary" );
+/*
+	Player Nearest
 
-	player->col_offset.x 			= 4;
-	player->col_offset.y 			= 4;
+	Purpose: Finds the live player closest to a point,
+			for enemies to aim at.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Pos - the point
+
+	Return:	The closest live player, or player 0 if
+			none are alive
+*/
+
+Player*			PlayerNearest( Game* game, const Vector2D& pos )
+{
+	Player* nearest = &(game->players[0]);
+	float nearest_dist = -1;
+
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+	{
+		Player* player = &(game->players[p]);
+		if ( !player->alive )
+			continue;
 
-	player->ship_ani.image_count 	= 1;
-	player->ship_ani.image_speed 	= 0;
-	player->ship_ani.image_index 	= 0;
-	player->ship_ani.y_offset 		= 32;
-	player->ship_ani.rect.w 		= 32;
-	player->ship_ani.rect.h 		= 32;
-	player->ship_ani.loops 			= false;
+		float dx = player->pos.x - pos.x;
+		float dy = player->pos.y - pos.y;
+		float dist = dx*dx + dy*dy;
+
+		if ( nearest_dist < 0 || dist < nearest_dist )
+		{
+			nearest = player;
+			nearest_dist = dist;
+		}
+	}
+
+	return nearest;
+}
+
+/*
+	Player Reload Timer
+
+	Purpose: <Timer Callback>
+			 Lets a player shoot again, once the
+			 cooldown from their last shot is over.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Target - the player's index
+
+	Return:	Nil
+*/
+
+void			PlayerReloadTimer( Game* game, Uint16 target )
+{
+	game->players[target].reloading = false;
 }
 
 /*
 	Player Update
 
 	Purpose: Updates the Player Object, called
-			each update.
+			each update, with the buttons the player
+			is holding this tick.
 
-	Parameters: Player - a pointer pointing to the
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Player - a pointer pointing to the
 					player object.
 				DT - the delta time, time passed
 					between this frame and the
@@ -61,7 +159,7 @@ void 			PlayerSetup( Player* player )
 	Return:	Nil
 */
 
-void			PlayerUpdate( Player* player, Uint32 dt )
+void			PlayerUpdate( Game* game, Player* player, Uint32 dt )
 {
 	if (player->alive == false)
 		return;
@@ -69,18 +167,15 @@ void			PlayerUpdate( Player* player, Uint32 dt )
 	// Slow Velocity
 	player->vel *= player->move_fric;
 
-	// Cache Game for Simplicity
-	Game* game = player->runner;
-
 	// Check for Movement Input
 	Vector2D input;
-		if ( game->key_up )
+		if ( player->buttons & INPUT_UP )
 			input.y -= player->move_speed;
-		if ( game->key_down )
+		if ( player->buttons & INPUT_DOWN )
 			input.y += player->move_speed;
-		if ( game->key_left )
+		if ( player->buttons & INPUT_LEFT )
 			input.x -= player->move_speed;
-		if ( game->key_right )
+		if ( player->buttons & INPUT_RIGHT )
 			input.x += player->move_speed;
 	input.truncate(player->move_speed);
 
@@ -95,6 +190,7 @@ void			PlayerUpdate( Player* player, Uint32 dt )
 		player->vel.y = 0;
 
 	// Add Velocity to Position
+	Vector2D start = player->pos;
 	player->pos += player->vel;
 
 	// Clamp Position to stay inside screen
@@ -103,17 +199,21 @@ void			PlayerUpdate( Player* player, Uint32 dt )
 	if (player->pos.y  < 0)					player->pos.y = 0; else
 	if (player->pos.y > SCREEN_HEIGHT)		player->pos.y = SCREEN_HEIGHT;
 
+	// What the collision sweep covers, clamping included
+	player->moved = player->pos - start;
+
 	// Set Collision Box Position
 	player->collision.x = (int)player->pos.x-16 + player->col_offset.x;
 	player->collision.y = (int)player->pos.y-16 + player->col_offset.y;
 
 	// Check for Shooting
-	if (game->key_shoot)
+	if (player->buttons & INPUT_SHOOT)
 	{
-		if ( player->next_shot < SDL_GetTicks() )
+		if ( !player->reloading )
 		{
 			// Set Cooldown
-			player->next_shot = SDL_GetTicks() + 250;
+			player->reloading = true;
+			TimerSchedule( &(game->timers), TIMER_MS_TO_TICKS(250), PlayerReloadTimer, player->index );
 
 			// Get Position and Velocity of Projectile
 			Vector2D pos = player->pos;
@@ -126,35 +226,26 @@ void			PlayerUpdate( Player* player, Uint32 dt )
 			// Additional Properties
 			if (proj != nullptr)
 			{
-				proj->ani.image_count = 1;
-				proj->ani.y_offset = 32*7;
+				AnimationStart( &(proj->ani), ANIMATION_SHOT_FRIENDLY );
 				proj->damage = 10;
 			}
 		}
 	}
+}
 
-	// Check Projectile Collisions
-	Projectile* proj;	for( Uint16 i = 0; i < game->proj_enemy_count; i++ )
-	{
-		proj = &(game->projectiles_enemy[i]);
+/*
+	Player Tint
 
-		if ( UtilityAabbCheck( &(player->collision), &(proj->collision) ) )
-		{
-			player->hp -= proj->damage;
-			proj->alive = false;
-		}
-	}
+	Purpose: Gets the colour a player's ship is tinted
 
-	// Check for Death
-	if ( player->hp <= 0 )
-	{
-		player->alive = false;
-		GameSpawnParticle( game, player->pos, PART_EXPLOSION_01 );
+	Parameters: Index - the player's slot in the game
 
-		game->needs_reset = true;
-		game->next_reset = SDL_GetTicks() + 2000;
-	}
+	Return:	The tint colour
+*/
 
+const SDL_Color* 	PlayerTint( Uint16 index )
+{
+	return &(player_tints[index % PLAYER_MAX]);
 }
 
 /*
@@ -163,26 +254,35 @@ void			PlayerUpdate( Player* player, Uint32 dt )
 	Purpose: Calls the Player to execute all it's
 			draw functionality.
 
-	Parameters: Player - a pointer pointing to the
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Player - a pointer pointing to the
 					player object.
 
 	Return:	Nil
 */
 
-void 			PlayerRender( Player* player )
+void 			PlayerRender( Game* game, Player* player )
 {
 	if (player->alive == false)
 		return;
 
-	AnimationUpdate( &(player->ship_ani) );
-
 	int pos_x = (int)roundf(player->pos.x-16);
 	int pos_y = (int)roundf(player->pos.y-16);
 
-    TextureRender(	player->sprite_texture, player->runner->render,
-					pos_x, pos_y, &(player->ship_ani.rect) );
+	const SDL_Color* tint = PlayerTint( player->index );
+
+	if ( player->sprite_texture != nullptr && player->sprite_texture->texture != nullptr )
+		SDL_SetTextureColorMod( player->sprite_texture->texture, tint->r, tint->g, tint->b );
+
+    TextureRender(	player->sprite_texture, game->render,
+					pos_x, pos_y, AnimationRect( game, &(player->ship_ani) ) );
+
+	// The sheet is shared with everything else
+	if ( player->sprite_texture != nullptr && player->sprite_texture->texture != nullptr )
+		SDL_SetTextureColorMod( player->sprite_texture->texture, 0xFF, 0xFF, 0xFF );
 
 	// Render Collision Box (For Debugging Only)
-	//SDL_SetRenderDrawColor( player->runner->render, 255, 0, 0, 128 );
-	//SDL_RenderFillRect( player->runner->render, &(player->collision) );
+	//SDL_SetRenderDrawColor( game->render, 255, 0, 0, 128 );
+	//SDL_RenderFillRect( game->render, &(player->collision) );
 }
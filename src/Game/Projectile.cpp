@@ -15,16 +15,19 @@
 	Purpose: Called once to initialise an projectile
 			engine data.
 
-	Parameters: Proj - a pointer to the projectile to
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Proj - a pointer to the projectile to
 					Affect.
+				Cold - the projectile's cold data
 
 	Return:	Nil
 */
 
-void			ProjectileInit( Projectile* proj )
+void			ProjectileInit( Game* game, Projectile* proj, ProjectileCold* cold )
 {
 	proj->alive = false;
-	proj->texture = GameFindTexture( proj->runner, "Primary" );
+	cold->texture = GameFindTexture( game, "Primary" );
 
 	//Set Collision Properties
     proj->col_offset.x = 10;
@@ -52,7 +55,7 @@ bool 			ProjectileSpawn( Projectile* proj, const Vector2D& pos, const Vector2D&
     proj->alive 			= true;
     proj->pos 				= pos;
     proj->vel 				= vel;
-    proj->ani.image_index 	= 0;
+    proj->ani.position 		= 0;
 
 	// Return Success
 	return true;
@@ -64,12 +67,14 @@ bool 			ProjectileSpawn( Projectile* proj, const Vector2D& pos, const Vector2D&
 	Purpose: Swaps the data of two projectiles
 
 	Parameters: P1 - the first projectile to swap
+				C1 - the first projectile's cold data
 				P2 - the second projectile to swap
+				C2 - the second projectile's cold data
 
 	Return:	Nil
 */
 
-void 			ProjectileSwap( Projectile* p1, Projectile* p2 )
+void 			ProjectileSwap( Projectile* p1, ProjectileCold* c1, Projectile* p2, ProjectileCold* c2 )
 {
 	// Check for Self Swapping
 	if (p1 == p2)
@@ -83,6 +88,11 @@ void 			ProjectileSwap( Projectile* p1, Projectile* p2 )
 
 	// Set P2 to temp (previous p1)
 	*p2 = temp;
+
+	// Swap the Cold Data the same way
+	ProjectileCold temp_cold = *c1;
+	*c1 = *c2;
+	*c2 = temp_cold;
 }
 
 /*
@@ -103,9 +113,6 @@ bool 			ProjectileUpdate( Projectile* proj, Uint32 dt )
 	if ( !(proj->alive) )
 		return false;
 
-	// Update Animation
-	AnimationUpdate( &(proj->ani) );
-
     // Update the Position
     proj->pos += proj->vel;
 
@@ -128,17 +135,20 @@ bool 			ProjectileUpdate( Projectile* proj, Uint32 dt )
 
 	Purpose: Renders the projectile.
 
-	Parameters: Proj - a pointer to the projectile to
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Proj - a pointer to the projectile to
 					Affect.
+				Cold - the projectile's cold data
 
 	Return:	Nil
 */
 
-void 			ProjectileRender( Projectile* proj )
+void 			ProjectileRender( Game* game, Projectile* proj, ProjectileCold* cold )
 {
 	int pos_x = (int)roundf(proj->pos.x-16);
 	int pos_y = (int)roundf(proj->pos.y-16);
 
-    TextureRender(	proj->texture, proj->runner->render,
-					pos_x, pos_y, &(proj->ani.rect) );
+    TextureRender(	cold->texture, game->render,
+					pos_x, pos_y, AnimationRect( game, &(proj->ani) ) );
 }
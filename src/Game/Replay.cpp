@@ -0,0 +1,254 @@
+/*************************************/
+/** Replay <source file>			**/
+/**									**/
+/** Records the input and checksum	**/
+/** of every tick to a file, and	**/
+/** plays it back, checking the		**/
+/** game comes out the same.		**/
+/*************************************/
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Game.h"
+
+/*
+	A replay file is a header, the snapshot the recording
+	started from, then one record per tick: the buttons
+	each player held, then the checksum after the tick. Static data,
+	like the enemy archetype file, isn't in the replay, so
+	it must be the same when playing back.
+*/
+
+struct ReplayHeader
+{
+	Uint32					magic;
+	Uint16					version;
+	Uint16					field_count; 		// checksum fields per tick
+	Uint32					snapshot_size;
+	Uint32					tick_count;
+};
+
+static const Uint32 replay_record_size = PLAYER_MAX + checksum_field_count * 4;
+
+/*
+	Replay Record Start
+
+	Purpose: Starts recording a replay, from the state
+			the game is in now.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Filename - the file to record to
+
+	Return:	True if recording started
+*/
+
+bool 			ReplayRecordStart( Game* game, const char* filename )
+{
+	Replay* replay = &(game->replay);
+
+	Uint32 size = GameSnapshotSize( game );
+	Uint8* snapshot = (Uint8*)malloc( size );
+	if ( snapshot == nullptr )
+	{
+		printf( "Error: Unable to allocate %u bytes for a replay snapshot\n", size );
+		return false;
+	}
+
+	size = GameSnapshotSave( game, snapshot, size );
+	if ( size == 0 )
+	{
+		free( snapshot );
+		return false;
+	}
+
+	replay->file = fopen( filename, "wb" );
+	if ( replay->file == nullptr )
+	{
+		printf( "Error: Unable to open replay %s\n", filename );
+		free( snapshot );
+		return false;
+	}
+
+	// Tick count is filled in when recording stops
+	ReplayHeader header = { GAME_REPLAY_MAGIC, GAME_REPLAY_VERSION, checksum_field_count, size, 0 };
+
+	fwrite( &header, sizeof(header), 1, replay->file );
+	fwrite( snapshot, size, 1, replay->file );
+	free( snapshot );
+
+	replay->first_tick 		= game->rewind.head;
+	replay->tick_count 		= 0;
+	replay->snapshot_size 	= size;
+
+	printf( "Recording replay to %s\n", filename );
+	return true;
+}
+
+/*
+	Replay Record Tick
+
+	Purpose: Writes the input of the tick just run, and
+			the checksum it came out with.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Inputs - the InputButtons for the tick,
+					by player
+
+	Return:	Nil
+*/
+
+void 			ReplayRecordTick( Game* game, const Uint8* inputs )
+{
+	Replay* replay = &(game->replay);
+
+	if ( replay->file == nullptr )
+		return;
+
+	GameChecksum checksum;
+	GameChecksumCompute( game, &checksum );
+
+	Uint8 record[replay_record_size];
+	memcpy( record, inputs, PLAYER_MAX );
+	memcpy( record + PLAYER_MAX, checksum.fields, checksum_field_count * 4 );
+
+	fwrite( record, sizeof(record), 1, replay->file );
+	++replay->tick_count;
+}
+
+/*
+	Replay Record Rewind
+
+	Purpose: Drops the ticks recorded after a tick, when
+			play goes back to it from the rewind buffer.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Tick - the rewind tick play goes on from
+
+	Return:	Nil
+*/
+
+void 			ReplayRecordRewind( Game* game, Uint32 tick )
+{
+	Replay* replay = &(game->replay);
+
+	if ( replay->file == nullptr )
+		return;
+
+	Uint32 ticks = ( tick > replay->first_tick ? tick - replay->first_tick : 0 );
+	if ( ticks >= replay->tick_count )
+		return;
+
+	replay->tick_count = ticks;
+	fseek( replay->file, sizeof(ReplayHeader) + replay->snapshot_size + ticks * replay_record_size, SEEK_SET );
+}
+
+/*
+	Replay Record Stop
+
+	Purpose: Finishes the replay file, filling in how many
+			ticks it holds.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			ReplayRecordStop( Game* game )
+{
+	Replay* replay = &(game->replay);
+
+	if ( replay->file == nullptr )
+		return;
+
+	fseek( replay->file, offsetof(ReplayHeader, tick_count), SEEK_SET );
+	fwrite( &(replay->tick_count), sizeof(replay->tick_count), 1, replay->file );
+	fclose( replay->file );
+
+	printf( "Replay: %u ticks recorded\n", replay->tick_count );
+	replay->file = nullptr;
+}
+
+/*
+	Replay Verify
+
+	Purpose: Plays a replay back as fast as it can,
+			without drawing, and checks every tick's
+			checksum against the one recorded. Stops at
+			the first tick that doesn't match.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Filename - the replay file
+
+	Return:	True if every tick matched
+*/
+
+bool 			ReplayVerify( Game* game, const char* filename )
+{
+	FILE* file = fopen( filename, "rb" );
+	if ( file == nullptr )
+	{
+		printf( "Error: Unable to open replay %s\n", filename );
+		return false;
+	}
+
+	ReplayHeader header;
+	if ( fread( &header, sizeof(header), 1, file ) != 1 ||
+		 header.magic != GAME_REPLAY_MAGIC || header.version != GAME_REPLAY_VERSION ||
+		 header.field_count != checksum_field_count )
+	{
+		printf( "Error: %s is not a version %d replay\n", filename, GAME_REPLAY_VERSION );
+		fclose( file );
+		return false;
+	}
+
+	Uint8* snapshot = (Uint8*)malloc( header.snapshot_size );
+	bool loaded = ( snapshot != nullptr && fread( snapshot, header.snapshot_size, 1, file ) == 1 &&
+					GameSnapshotRestore( game, snapshot, header.snapshot_size ) );
+	free( snapshot );
+
+	if ( !loaded )
+	{
+		printf( "Error: Unable to start replay %s\n", filename );
+		fclose( file );
+		return false;
+	}
+
+	const Uint32 time_per_frame = 1000 / FPS;
+	bool same = true;
+	Uint32 tick = 0;
+
+	for( ; tick < header.tick_count && same; tick++ )
+	{
+		Uint8 record[replay_record_size];
+		if ( fread( record, sizeof(record), 1, file ) != 1 )
+		{
+			printf( "Error: Replay %s ends at tick %u\n", filename, tick );
+			same = false;
+			break;
+		}
+
+		GameChecksum expected;
+		memcpy( expected.fields, record + PLAYER_MAX, checksum_field_count * 4 );
+
+		GameChecksum actual;
+		GameTick( game, record, time_per_frame );
+		GameChecksumCompute( game, &actual );
+
+		same = GameChecksumCompare( &expected, &actual, tick );
+	}
+
+	fclose( file );
+
+	if ( same )
+		printf( "Replay: %u ticks match\n", tick );
+
+	return same;
+}
@@ -0,0 +1,381 @@
+/*************************************/
+/** Rewind <source file>			**/
+/**									**/
+/** Keeps the last few seconds of	**/
+/** play, so it can be scrubbed		**/
+/** back and forth while looking	**/
+/** for what went wrong.			**/
+/*************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Game.h"
+
+/*
+	Rewind Keyframe At
+
+	Purpose: Finds a keyframe by its place in the ring,
+			counting from the oldest.
+
+	Parameters: Rewind - the rewind buffer
+				N - 0 for the oldest keyframe
+
+	Return:	The keyframe
+*/
+
+static inline RewindKeyframe* 	RewindKeyframeAt( RewindBuffer* rewind, Uint16 n )
+{
+	return &(rewind->keyframes[(rewind->keyframe_first + n) % REWIND_KEYFRAME_MAX]);
+}
+
+/*
+	Rewind Drop Oldest
+
+	Purpose: Forgets the oldest keyframe.
+
+	Parameters: Rewind - the rewind buffer
+
+	Return:	Nil
+*/
+
+static void 	RewindDropOldest( RewindBuffer* rewind )
+{
+	rewind->keyframe_first = (rewind->keyframe_first + 1) % REWIND_KEYFRAME_MAX;
+	--rewind->keyframe_count;
+}
+
+/*
+	Rewind Overlaps
+
+	Purpose: Checks if any kept keyframe uses part of a
+			range of the rewind memory.
+
+	Parameters: Rewind - the rewind buffer
+				Offset - the start of the range
+				Size - the size of the range
+
+	Return:	True if a keyframe is in the way
+*/
+
+static bool 	RewindOverlaps( RewindBuffer* rewind, Uint32 offset, Uint32 size )
+{
+	for( Uint16 n = 0; n < rewind->keyframe_count; n++ )
+	{
+		RewindKeyframe* key = RewindKeyframeAt( rewind, n );
+
+		if ( key->offset < offset + size && offset < key->offset + key->size )
+			return true;
+	}
+
+	return false;
+}
+
+/*
+	Rewind Init
+
+	Purpose: Allocates the memory keyframes are kept in.
+			This is the only allocation rewinding makes,
+			so its cost is fixed from the start.
+
+	Parameters: Rewind - the rewind buffer
+				Capacity - the bytes to keep keyframes in
+
+	Return:	True if the memory was allocated
+*/
+
+bool 			RewindInit( RewindBuffer* rewind, Uint32 capacity )
+{
+	rewind->memory = (Uint8*)malloc( capacity );
+	if ( rewind->memory == nullptr )
+	{
+		printf( "Error: Unable to allocate %u bytes for rewinding\n", capacity );
+		rewind->capacity = 0;
+		return false;
+	}
+
+	rewind->capacity 		= capacity;
+	rewind->write 			= 0;
+	rewind->keyframe_first 	= 0;
+	rewind->keyframe_count 	= 0;
+	rewind->head 			= 0;
+	rewind->cursor 			= 0;
+	rewind->active 			= false;
+	rewind->dropped 		= 0;
+
+	printf( "Rewind: %u KB for the last %u seconds\n",
+			(Uint32)( (capacity + sizeof(RewindBuffer)) / 1024 ), REWIND_SECONDS );
+
+	return true;
+}
+
+/*
+	Rewind Free
+
+	Purpose: Releases the keyframe memory.
+
+	Parameters: Rewind - the rewind buffer
+
+	Return:	Nil
+*/
+
+void 			RewindFree( RewindBuffer* rewind )
+{
+	free( rewind->memory );
+
+	rewind->memory 			= nullptr;
+	rewind->capacity 		= 0;
+	rewind->keyframe_count 	= 0;
+	rewind->active 			= false;
+}
+
+/*
+	Rewind Print Stats
+
+	Purpose: Prints how much memory rewinding uses, and
+			how far back it can go.
+
+	Parameters: Rewind - the rewind buffer
+
+	Return:	Nil
+*/
+
+void 			RewindPrintStats( RewindBuffer* rewind )
+{
+	Uint32 used = 0;
+	for( Uint16 n = 0; n < rewind->keyframe_count; n++ )
+		used += RewindKeyframeAt( rewind, n )->size;
+
+	Uint32 ticks = 0;
+	if ( rewind->keyframe_count > 0 )
+		ticks = rewind->head - RewindKeyframeAt( rewind, 0 )->tick;
+
+	printf( "Rewind: %u keyframes in %u / %u bytes, %u.%02u seconds back, %u keyframes too big to keep\n",
+			rewind->keyframe_count, used, rewind->capacity,
+			ticks / FPS, (ticks % FPS) * 100 / FPS, rewind->dropped );
+}
+
+/*
+	Rewind Record
+
+	Purpose: Remembers the input for the tick about to
+			run, and takes a keyframe first if it is
+			time for one. Called just before each live
+			tick.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Inputs - the InputButtons for the tick,
+					by player
+
+	Return:	Nil
+*/
+
+void 			RewindRecord( Game* game, const Uint8* inputs )
+{
+	RewindBuffer* rewind = &(game->rewind);
+
+	if ( rewind->memory == nullptr )
+		return;
+
+	// Keyframes need every input after them, and the oldest is about to go
+	while( rewind->keyframe_count > 0 &&
+		   RewindKeyframeAt( rewind, 0 )->tick + REWIND_TICKS <= rewind->head )
+		RewindDropOldest( rewind );
+
+	bool keyframe_due = ( rewind->keyframe_count == 0 ||
+						  rewind->head - RewindKeyframeAt( rewind, rewind->keyframe_count-1 )->tick >= REWIND_KEYFRAME_TICKS );
+
+	if ( keyframe_due )
+	{
+		Uint32 size = GameSnapshotSize( game );
+
+		if ( size > rewind->capacity )
+			++rewind->dropped;
+		else
+		{
+			if ( rewind->write + size > rewind->capacity )
+				rewind->write = 0;
+
+			while( rewind->keyframe_count > 0 &&
+				   ( rewind->keyframe_count == REWIND_KEYFRAME_MAX || RewindOverlaps( rewind, rewind->write, size ) ) )
+				RewindDropOldest( rewind );
+
+			RewindKeyframe* key = RewindKeyframeAt( rewind, rewind->keyframe_count );
+			key->tick 	= rewind->head;
+			key->offset = rewind->write;
+			key->size 	= GameSnapshotSave( game, rewind->memory + rewind->write, size );
+
+			if ( key->size > 0 )
+			{
+				rewind->write += key->size;
+				++rewind->keyframe_count;
+			}
+		}
+	}
+
+	memcpy( rewind->inputs[rewind->head % REWIND_TICKS], inputs, PLAYER_MAX );
+	++rewind->head;
+}
+
+/*
+	Rewind Seek
+
+	Purpose: Puts the game in the state it was in at a
+			tick, by restoring the keyframe before it
+			and running the recorded inputs from there.
+			Ticks outside what is kept are clamped.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Tick - the tick to go to
+
+	Return:	True if the game is now at that tick
+*/
+
+bool 			RewindSeek( Game* game, Uint32 tick )
+{
+	RewindBuffer* rewind = &(game->rewind);
+
+	if ( rewind->keyframe_count == 0 )
+		return false;
+
+	const Uint32 time_per_frame = 1000 / FPS;
+	Uint32 oldest = RewindKeyframeAt( rewind, 0 )->tick;
+
+	if ( tick < oldest )
+		tick = oldest;
+	if ( tick > rewind->head )
+		tick = rewind->head;
+
+	// Newest keyframe at or before the tick
+	Uint16 n = rewind->keyframe_count - 1;
+	while( RewindKeyframeAt( rewind, n )->tick > tick )
+		--n;
+
+	RewindKeyframe* key = RewindKeyframeAt( rewind, n );
+	Uint32 from = key->tick;
+
+	// Going forward from where we are is cheaper, if no keyframe is closer
+	if ( rewind->active && rewind->cursor <= tick && rewind->cursor >= from )
+		from = rewind->cursor;
+	else if ( !GameSnapshotRestore( game, rewind->memory + key->offset, key->size ) )
+		return false;
+
+	for( Uint32 t = from; t < tick; t++ )
+		GameTick( game, rewind->inputs[t % REWIND_TICKS], time_per_frame );
+
+	rewind->cursor = tick;
+	return true;
+}
+
+/*
+	Rewind Start
+
+	Purpose: Pauses live play so it can be scrubbed
+			through, starting from the latest tick.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			RewindStart( Game* game )
+{
+	RewindBuffer* rewind = &(game->rewind);
+
+	if ( rewind->keyframe_count == 0 )
+		return;
+
+	rewind->active = true;
+	rewind->cursor = rewind->head;
+}
+
+/*
+	Rewind Stop
+
+	Purpose: Goes back to live play, from the tick being
+			shown. Anything recorded after it is
+			forgotten.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			RewindStop( Game* game )
+{
+	RewindBuffer* rewind = &(game->rewind);
+
+	if ( !rewind->active )
+		return;
+
+	rewind->active = false;
+	rewind->head = rewind->cursor;
+
+	ReplayRecordRewind( game, rewind->head );
+
+	while( rewind->keyframe_count > 0 &&
+		   RewindKeyframeAt( rewind, rewind->keyframe_count-1 )->tick > rewind->head )
+		--rewind->keyframe_count;
+
+	// Carry on writing after the newest keyframe left
+	if ( rewind->keyframe_count > 0 )
+	{
+		RewindKeyframe* key = RewindKeyframeAt( rewind, rewind->keyframe_count-1 );
+		rewind->write = key->offset + key->size;
+	}
+}
+
+/*
+	Rewind Input
+
+	Purpose: Handles the rewind keys. Backspace starts
+			and stops rewinding, and while rewinding,
+			Left and Right step a tick at a time, or
+			ten with Shift held.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	True while rewinding, when the game
+			shouldn't tick
+*/
+
+bool 			RewindInput( Game* game )
+{
+	RewindBuffer* rewind = &(game->rewind);
+	const Uint8* keys = game->key_states;
+
+	bool toggle = ( keys[SDL_SCANCODE_BACKSPACE] > 0 );
+	if ( toggle && !rewind->key_held )
+	{
+		if ( rewind->active )
+			RewindStop( game );
+		else
+			RewindStart( game );
+	}
+	rewind->key_held = toggle;
+
+	if ( !rewind->active )
+		return false;
+
+	Sint32 step = 0;
+	if ( keys[SDL_SCANCODE_LEFT] > 0 )
+		step -= 1;
+	if ( keys[SDL_SCANCODE_RIGHT] > 0 )
+		step += 1;
+	if ( keys[SDL_SCANCODE_LSHIFT] > 0 || keys[SDL_SCANCODE_RSHIFT] > 0 )
+		step *= 10;
+
+	if ( step < 0 && (Uint32)-step > rewind->cursor )
+		step = -(Sint32)rewind->cursor;
+
+	if ( step != 0 )
+		RewindSeek( game, rewind->cursor + step );
+
+	return true;
+}
@@ -0,0 +1,821 @@
+/*************************************/
+/** Rollback <source file>			**/
+/**									**/
+/** Plays a game between two		**/
+/** machines over UDP. Remote input	**/
+/** is guessed, and ticks are run	**/
+/** again when the guess was wrong.	**/
+/*************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Game.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif // _WIN32
+
+/*
+	Packets are sent every tick, and carry every local
+	input the remote hasn't acknowledged yet, so a lost
+	packet is made up by the next one. Each also carries
+	the checksum of the newest tick both sides have all
+	the input for, to catch a desync.
+
+	Layout: magic u16, first frame u32, ack u32, checksum
+	frame u32, checksum fields u32 x checksum_field_count,
+	input count u8, then the inputs. Both ends are assumed
+	to be little endian.
+*/
+
+static const Uint32 rollback_header_size = 2 + 4 + 4 + 4 + checksum_field_count * 4 + 1;
+
+/*
+	Rollback Random
+
+	Purpose: A random number generator for the test
+			conditions, kept apart from the game's.
+
+	Parameters: Session - the rollback session
+
+	Return:	A random value
+*/
+
+static inline Uint32 	RollbackRandom( RollbackSession* session )
+{
+	// Xorshift
+	Uint32 x = session->random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	session->random = x;
+
+	return x;
+}
+
+/*
+	Rollback Remote
+
+	Purpose: Finds which player is on the other end.
+
+	Parameters: Session - the rollback session
+
+	Return:	The remote player's index
+*/
+
+static inline Uint16 	RollbackRemote( RollbackSession* session )
+{
+	return (Uint16)( 1 - session->local_player );
+}
+
+#if defined(_WIN32) || defined(__linux__)
+
+/*
+	Rollback Socket Shut
+
+	Purpose: Closes a socket. On Windows, the socket held
+			Winsock open, so this lets go of it.
+
+	Parameters: Fd - the socket
+
+	Return:	Nil
+*/
+
+static void 	RollbackSocketShut( int fd )
+{
+	#ifdef _WIN32
+	closesocket( (SOCKET)fd );
+	WSACleanup();
+	#else
+	close( fd );
+	#endif // _WIN32
+}
+
+/*
+	Rollback Socket Open
+
+	Purpose: Opens a non-blocking UDP socket on a port.
+			On Windows, Winsock is started for the
+			socket, as it counts how many times it was
+			started.
+
+	Parameters: Port - the local port
+
+	Return:	The socket, or -1 if it couldn't be opened
+*/
+
+static int 		RollbackSocketOpen( Uint16 port )
+{
+	#ifdef _WIN32
+	WSADATA wsa;
+	if ( WSAStartup( MAKEWORD( 2, 2 ), &wsa ) != 0 )
+		return -1;
+
+	SOCKET handle = socket( AF_INET, SOCK_DGRAM, 0 );
+	if ( handle == INVALID_SOCKET )
+	{
+		WSACleanup();
+		return -1;
+	}
+
+	// Socket handles are small, and fit the int the session keeps
+	int fd = (int)handle;
+	#else
+	int fd = socket( AF_INET, SOCK_DGRAM, 0 );
+	if ( fd < 0 )
+		return -1;
+	#endif // _WIN32
+
+	sockaddr_in addr;
+	memset( &addr, 0, sizeof(addr) );
+	addr.sin_family 		= AF_INET;
+	addr.sin_addr.s_addr 	= htonl( INADDR_ANY );
+	addr.sin_port 			= htons( port );
+
+	#ifdef _WIN32
+	u_long non_blocking = 1;
+	bool opened = ( bind( handle, (sockaddr*)&addr, sizeof(addr) ) == 0 &&
+					ioctlsocket( handle, FIONBIO, &non_blocking ) == 0 );
+	#else
+	bool opened = ( bind( fd, (sockaddr*)&addr, sizeof(addr) ) == 0 &&
+					fcntl( fd, F_SETFL, fcntl( fd, F_GETFL, 0 ) | O_NONBLOCK ) >= 0 );
+	#endif // _WIN32
+
+	if ( !opened )
+	{
+		RollbackSocketShut( fd );
+		return -1;
+	}
+
+	return fd;
+}
+
+/*
+	Rollback Socket Send
+
+	Purpose: Sends a packet to the remote player.
+
+	Parameters: Session - the rollback session
+				Data - the packet
+				Size - the packet's size
+
+	Return:	Nil
+*/
+
+static void 	RollbackSocketSend( RollbackSession* session, const Uint8* data, Uint32 size )
+{
+	sockaddr_in addr;
+	memset( &addr, 0, sizeof(addr) );
+	addr.sin_family 		= AF_INET;
+	addr.sin_addr.s_addr 	= session->remote_ip;
+	addr.sin_port 			= session->remote_port;
+
+	sendto( session->socket, (const char*)data, size, 0, (sockaddr*)&addr, sizeof(addr) );
+}
+
+/*
+	Rollback Socket Receive
+
+	Purpose: Takes the next packet waiting from the
+			remote player, without waiting for one.
+
+	Parameters: Session - the rollback session
+				Data - where to put the packet
+				Capacity - the size of Data
+
+	Return:	The packet's size, or 0 if none are waiting
+*/
+
+static Uint32 	RollbackSocketReceive( RollbackSession* session, Uint8* data, Uint32 capacity )
+{
+	for( ;; )
+	{
+		sockaddr_in from;
+		socklen_t from_size = sizeof(from);
+
+		int size = (int)recvfrom( session->socket, (char*)data, capacity, 0, (sockaddr*)&from, &from_size );
+		if ( size <= 0 )
+			return 0;
+
+		// Ignore anyone else
+		if ( from.sin_addr.s_addr == session->remote_ip && from.sin_port == session->remote_port )
+			return (Uint32)size;
+	}
+}
+
+/*
+	Rollback Socket Close
+
+	Purpose: Closes the session's socket.
+
+	Parameters: Session - the rollback session
+
+	Return:	Nil
+*/
+
+static void 	RollbackSocketClose( RollbackSession* session )
+{
+	RollbackSocketShut( session->socket );
+}
+
+#else
+
+/*
+	UDP is only set up on Linux and Windows for now, other
+	platforms can't open a socket, so sessions never start.
+*/
+
+static int 		RollbackSocketOpen( Uint16 port ) { return -1; }
+static void 	RollbackSocketSend( RollbackSession* session, const Uint8* data, Uint32 size ) {}
+static Uint32 	RollbackSocketReceive( RollbackSession* session, Uint8* data, Uint32 capacity ) { return 0; }
+static void 	RollbackSocketClose( RollbackSession* session ) {}
+
+#endif // _WIN32 || __linux__
+
+/*
+	Rollback Start
+
+	Purpose: Starts a two player session, with both
+			players at tick 0 of the game as it is now.
+			Both machines must start from the same state.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Local Player - 0 or 1, the other machine
+					must use the other
+				Local Port - the UDP port to listen on
+				Remote IP - the other machine's IPv4
+					address
+				Remote Port - the other machine's port
+
+	Return:	True if the session started
+*/
+
+bool 			RollbackStart( Game* game, Uint16 local_player, Uint16 local_port, const char* remote_ip, Uint16 remote_port )
+{
+	RollbackSession* session = &(game->rollback);
+
+	if ( local_player >= ROLLBACK_PLAYERS )
+	{
+		printf( "Error: Rollback player must be 0 or 1\n" );
+		return false;
+	}
+
+	#if defined(_WIN32) || defined(__linux__)
+	in_addr addr;
+
+	// Older mingw has no inet_pton
+	#ifdef _WIN32
+	addr.s_addr = inet_addr( remote_ip );
+	bool parsed = ( addr.s_addr != INADDR_NONE );
+	#else
+	bool parsed = ( inet_pton( AF_INET, remote_ip, &addr ) == 1 );
+	#endif // _WIN32
+
+	if ( !parsed )
+	{
+		printf( "Error: %s is not an IPv4 address\n", remote_ip );
+		return false;
+	}
+
+	session->remote_ip 		= addr.s_addr;
+	session->remote_port 	= htons( remote_port );
+	#endif // _WIN32 || __linux__
+
+	session->socket = RollbackSocketOpen( local_port );
+	if ( session->socket < 0 )
+	{
+		printf( "Error: Unable to open UDP port %u\n", local_port );
+		return false;
+	}
+
+	session->snapshots = (Uint8*)malloc( ROLLBACK_SNAPSHOTS * ROLLBACK_SNAPSHOT_MAX );
+	if ( session->snapshots == nullptr )
+	{
+		printf( "Error: Unable to allocate rollback snapshots\n" );
+		RollbackSocketClose( session );
+		session->socket = -1;
+		return false;
+	}
+
+	// Seeded from the clock at startup, which the machines won't agree on
+	game->random_state = 0x2F6B1A3D;
+
+	session->local_player 			= local_player;
+	session->frame 					= 0;
+	session->remote_ack 			= 0;
+	session->rollback_to 			= ROLLBACK_FRAME_NONE;
+	session->remote_checksum_frame 	= ROLLBACK_FRAME_NONE;
+	session->delayed_count 			= 0;
+
+	memset( session->inputs, 0, sizeof(session->inputs) );
+	memset( session->confirmed, 0, sizeof(session->confirmed) );
+
+	printf( "Rollback: player %u, port %u to %s:%u\n", local_player, local_port, remote_ip, remote_port );
+	return true;
+}
+
+/*
+	Rollback Stop
+
+	Purpose: Ends the session, printing its stats.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			RollbackStop( Game* game )
+{
+	RollbackSession* session = &(game->rollback);
+
+	if ( session->socket < 0 )
+		return;
+
+	RollbackPrintStats( game );
+
+	RollbackSocketClose( session );
+	free( session->snapshots );
+
+	session->socket 	= -1;
+	session->snapshots 	= nullptr;
+}
+
+/*
+	Rollback Set Conditions
+
+	Purpose: Makes packets we send late, uneven and
+			sometimes lost, to test against a bad
+			network on one machine.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Latency - ms added to every packet
+				Jitter - most ms added or taken away,
+					at random
+				Loss - percent of packets dropped
+
+	Return:	Nil
+*/
+
+void 			RollbackSetConditions( Game* game, Uint32 latency, Uint32 jitter, Uint32 loss )
+{
+	RollbackSession* session = &(game->rollback);
+
+	session->latency 	= latency;
+	session->jitter 	= ( jitter < latency ? jitter : latency );
+	session->loss 		= loss;
+}
+
+/*
+	Rollback Send
+
+	Purpose: Sends a packet, or holds it back for later
+			if test conditions are set.
+
+	Parameters: Session - the rollback session
+				Data - the packet
+				Size - the packet's size
+				Now - the time, in ms
+
+	Return:	Nil
+*/
+
+static void 	RollbackSend( RollbackSession* session, const Uint8* data, Uint32 size, Uint32 now )
+{
+	++session->packets_sent;
+
+	if ( session->loss > 0 && RollbackRandom( session ) % 100 < session->loss )
+	{
+		++session->packets_lost;
+		return;
+	}
+
+	if ( session->latency == 0 || session->delayed_count >= ROLLBACK_DELAY_QUEUE )
+	{
+		RollbackSocketSend( session, data, size );
+		return;
+	}
+
+	RollbackDelayed* delayed = &(session->delayed[session->delayed_count++]);
+	delayed->release 	= now + session->latency - session->jitter + RollbackRandom( session ) % (2*session->jitter + 1);
+	delayed->size 		= (Uint16)size;
+	memcpy( delayed->data, data, size );
+}
+
+/*
+	Rollback Send Delayed
+
+	Purpose: Sends the held back packets that are due.
+
+	Parameters: Session - the rollback session
+				Now - the time, in ms
+
+	Return:	Nil
+*/
+
+static void 	RollbackSendDelayed( RollbackSession* session, Uint32 now )
+{
+	for( Uint16 i = 0; i < session->delayed_count; )
+	{
+		RollbackDelayed* delayed = &(session->delayed[i]);
+
+		if ( (Sint32)( now - delayed->release ) < 0 )
+		{
+			++i;
+			continue;
+		}
+
+		RollbackSocketSend( session, delayed->data, delayed->size );
+		*delayed = session->delayed[--session->delayed_count];
+	}
+}
+
+/*
+	Rollback Put
+
+	Purpose: Writes a value into a packet, and moves on
+			past it.
+
+	Parameters: At - the place in the packet
+				Value - the value
+				Size - the size of the value
+
+	Return:	Nil
+*/
+
+static inline void 	RollbackPut( Uint8*& at, const void* value, Uint32 size )
+{
+	memcpy( at, value, size );
+	at += size;
+}
+
+/*
+	Rollback Get
+
+	Purpose: Reads a value out of a packet, and moves on
+			past it.
+
+	Parameters: At - the place in the packet
+				Value - where to put the value
+				Size - the size of the value
+
+	Return:	Nil
+*/
+
+static inline void 	RollbackGet( const Uint8*& at, void* value, Uint32 size )
+{
+	memcpy( value, at, size );
+	at += size;
+}
+
+/*
+	Rollback Send Inputs
+
+	Purpose: Sends every local input the remote hasn't
+			acknowledged, with the newest checksum.
+
+	Parameters: Session - the rollback session
+				Now - the time, in ms
+
+	Return:	Nil
+*/
+
+static void 	RollbackSendInputs( RollbackSession* session, Uint32 now )
+{
+	Uint16 local = session->local_player;
+	Uint16 remote = RollbackRemote( session );
+
+	Uint32 first = session->remote_ack;
+	if ( session->frame - first > ROLLBACK_PACKET_INPUTS )
+		first = session->frame - ROLLBACK_PACKET_INPUTS;
+
+	Uint8 count = (Uint8)( session->frame - first );
+
+	// Newest tick with every input known
+	Uint32 known = ( session->confirmed[remote] < session->frame ? session->confirmed[remote] : session->frame );
+	Uint32 checksum_frame = ( known > 0 ? known - 1 : ROLLBACK_FRAME_NONE );
+
+	GameChecksum checksum;
+	if ( checksum_frame != ROLLBACK_FRAME_NONE )
+		checksum = session->checksums[checksum_frame % ROLLBACK_HISTORY];
+
+	Uint8 packet[ROLLBACK_PACKET_MAX];
+	Uint8* at = packet;
+	Uint16 magic = ROLLBACK_PACKET_MAGIC;
+
+	RollbackPut( at, &magic, 2 );
+	RollbackPut( at, &first, 4 );
+	RollbackPut( at, &(session->confirmed[remote]), 4 );
+	RollbackPut( at, &checksum_frame, 4 );
+	RollbackPut( at, checksum.fields, checksum_field_count * 4 );
+	RollbackPut( at, &count, 1 );
+
+	for( Uint32 f = first; f < session->frame; f++ )
+		*at++ = session->inputs[local][f % ROLLBACK_HISTORY];
+
+	RollbackSend( session, packet, (Uint32)(at - packet), now );
+}
+
+/*
+	Rollback Receive
+
+	Purpose: Takes in every packet from the remote. New
+			inputs are stored, and if one differs from
+			what was guessed for a tick already run, the
+			session is marked to roll back to it.
+
+	Parameters: Session - the rollback session
+
+	Return:	Nil
+*/
+
+static void 	RollbackReceive( RollbackSession* session )
+{
+	Uint16 remote = RollbackRemote( session );
+	Uint8 packet[ROLLBACK_PACKET_MAX];
+
+	for( ;; )
+	{
+		Uint32 size = RollbackSocketReceive( session, packet, sizeof(packet) );
+		if ( size == 0 )
+			break;
+
+		if ( size < rollback_header_size )
+			continue;
+
+		const Uint8* at = packet;
+		Uint16 magic;
+		Uint32 first, ack, checksum_frame;
+		GameChecksum checksum;
+		Uint8 count;
+
+		RollbackGet( at, &magic, 2 );
+		RollbackGet( at, &first, 4 );
+		RollbackGet( at, &ack, 4 );
+		RollbackGet( at, &checksum_frame, 4 );
+		RollbackGet( at, checksum.fields, checksum_field_count * 4 );
+		RollbackGet( at, &count, 1 );
+
+		if ( magic != ROLLBACK_PACKET_MAGIC || size != rollback_header_size + count )
+			continue;
+
+		if ( ack > session->remote_ack && ack <= session->frame )
+			session->remote_ack = ack;
+
+		if ( checksum_frame != ROLLBACK_FRAME_NONE &&
+			 ( session->remote_checksum_frame == ROLLBACK_FRAME_NONE || checksum_frame > session->remote_checksum_frame ) )
+		{
+			session->remote_checksum_frame 	= checksum_frame;
+			session->remote_checksum 		= checksum;
+		}
+
+		// Only take inputs that follow on from the ones we have
+		for( Uint32 i = 0; i < count; i++ )
+		{
+			Uint32 f = first + i;
+			Uint8 input = at[i];
+
+			if ( f < session->confirmed[remote] )
+				continue;
+			if ( f > session->confirmed[remote] || f >= session->frame + ROLLBACK_HISTORY/2 )
+				break;
+
+			Uint8* slot = &(session->inputs[remote][f % ROLLBACK_HISTORY]);
+
+			if ( f < session->frame && *slot != input && f < session->rollback_to )
+				session->rollback_to = f;
+
+			*slot = input;
+			++session->confirmed[remote];
+		}
+	}
+}
+
+/*
+	Rollback Predict
+
+	Purpose: Guesses the remote input for ticks it hasn't
+			arrived for yet, as the last input that did.
+			If a guess for a tick already run changes,
+			the session is marked to roll back to it.
+
+	Parameters: Session - the rollback session
+
+	Return:	Nil
+*/
+
+static void 	RollbackPredict( RollbackSession* session )
+{
+	Uint16 remote = RollbackRemote( session );
+	Uint32 confirmed = session->confirmed[remote];
+
+	Uint8 guess = ( confirmed > 0 ? session->inputs[remote][(confirmed-1) % ROLLBACK_HISTORY] : 0 );
+
+	for( Uint32 f = confirmed; f < session->frame; f++ )
+	{
+		Uint8* slot = &(session->inputs[remote][f % ROLLBACK_HISTORY]);
+
+		if ( *slot != guess )
+		{
+			*slot = guess;
+			if ( f < session->rollback_to )
+				session->rollback_to = f;
+		}
+	}
+
+	// And for the tick about to run
+	if ( confirmed <= session->frame )
+		session->inputs[remote][session->frame % ROLLBACK_HISTORY] = guess;
+}
+
+/*
+	Rollback Tick
+
+	Purpose: Saves a snapshot, then runs one tick with
+			both players' inputs, each flying their own
+			ship.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Frame - the tick to run
+
+	Return:	Nil
+*/
+
+static void 	RollbackTick( Game* game, Uint32 frame )
+{
+	RollbackSession* session = &(game->rollback);
+	Uint32 slot = frame % ROLLBACK_SNAPSHOTS;
+
+	session->snapshot_sizes[slot] = GameSnapshotSave( game, session->snapshots + slot * ROLLBACK_SNAPSHOT_MAX, ROLLBACK_SNAPSHOT_MAX );
+	if ( session->snapshot_sizes[slot] == 0 )
+		printf( "Error: Tick %u is too big to roll back to\n", frame );
+
+	Uint8 inputs[PLAYER_MAX] = {};
+	for( Uint16 p = 0; p < ROLLBACK_PLAYERS; p++ )
+		inputs[p] = session->inputs[p][frame % ROLLBACK_HISTORY];
+
+	GameTick( game, inputs, 1000 / FPS );
+	GameChecksumCompute( game, &(session->checksums[frame % ROLLBACK_HISTORY]) );
+}
+
+/*
+	Rollback Resimulate
+
+	Purpose: Goes back to the earliest tick a guess was
+			wrong for, and runs every tick from there
+			again with the inputs we now have.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+static void 	RollbackResimulate( Game* game )
+{
+	RollbackSession* session = &(game->rollback);
+
+	Uint32 from = session->rollback_to;
+	session->rollback_to = ROLLBACK_FRAME_NONE;
+
+	if ( from >= session->frame )
+		return;
+
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	Uint32 slot = from % ROLLBACK_SNAPSHOTS;
+	if ( !GameSnapshotRestore( game, session->snapshots + slot * ROLLBACK_SNAPSHOT_MAX, session->snapshot_sizes[slot] ) )
+	{
+		printf( "Error: Unable to roll back to tick %u\n", from );
+		return;
+	}
+
+	for( Uint32 f = from; f < session->frame; f++ )
+		RollbackTick( game, f );
+
+	Uint32 depth = session->frame - from;
+
+	++session->rollbacks;
+	session->resimulated += depth;
+	if ( depth > session->max_depth )
+		session->max_depth = depth;
+
+	session->resimulate_time += SDL_GetPerformanceCounter() - start;
+}
+
+/*
+	Rollback Check Desync
+
+	Purpose: Compares the remote's checksum with ours for
+			the same tick, once we have every input for
+			it.
+
+	Parameters: Session - the rollback session
+
+	Return:	Nil
+*/
+
+static void 	RollbackCheckDesync( RollbackSession* session )
+{
+	Uint32 f = session->remote_checksum_frame;
+
+	if ( f == ROLLBACK_FRAME_NONE )
+		return;
+
+	Uint16 remote = RollbackRemote( session );
+	if ( f >= session->frame || f >= session->confirmed[remote] )
+		return;
+
+	// Too old to check against
+	if ( session->frame - f <= ROLLBACK_HISTORY &&
+		 !GameChecksumCompare( &(session->remote_checksum), &(session->checksums[f % ROLLBACK_HISTORY]), f ) )
+		++session->desyncs;
+
+	session->remote_checksum_frame = ROLLBACK_FRAME_NONE;
+}
+
+/*
+	Rollback Advance
+
+	Purpose: Runs the session for one tick of the game
+			loop: takes in remote input, rolls back if a
+			guess was wrong, then runs the next tick with
+			the local input. If the remote has fallen too
+			far behind, waits for it instead.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Input - the local InputButtons
+				Now - the time, in ms
+
+	Return:	Nil
+*/
+
+void 			RollbackAdvance( Game* game, Uint8 input, Uint32 now )
+{
+	RollbackSession* session = &(game->rollback);
+	Uint16 remote = RollbackRemote( session );
+
+	if ( session->socket < 0 )
+		return;
+
+	RollbackSendDelayed( session, now );
+	RollbackReceive( session );
+	RollbackPredict( session );
+
+	if ( session->rollback_to != ROLLBACK_FRAME_NONE )
+		RollbackResimulate( game );
+
+	if ( session->frame - session->confirmed[remote] >= ROLLBACK_MAX_FRAMES )
+		++session->stalls;
+	else
+	{
+		session->inputs[session->local_player][session->frame % ROLLBACK_HISTORY] = input;
+		session->confirmed[session->local_player] = session->frame + 1;
+
+		RollbackTick( game, session->frame );
+		++session->frame;
+	}
+
+	RollbackSendInputs( session, now );
+	RollbackCheckDesync( session );
+}
+
+/*
+	Rollback Print Stats
+
+	Purpose: Prints how often the session rolled back,
+			and what it cost.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			RollbackPrintStats( Game* game )
+{
+	RollbackSession* session = &(game->rollback);
+
+	double resimulate_us = (double)session->resimulate_time * 1e6 / (double)SDL_GetPerformanceFrequency();
+
+	printf( "Rollback: %u ticks, %u rollbacks, %u ticks run again (%.2f deep on average, %u at most)\n",
+			session->frame, session->rollbacks, session->resimulated,
+			session->rollbacks > 0 ? (double)session->resimulated / session->rollbacks : 0.0, session->max_depth );
+	printf( "Rollback: %.2f us per rollback, %.2f us per tick, %u stalled ticks, %u of %u packets lost, %u desyncs\n",
+			session->rollbacks > 0 ? resimulate_us / session->rollbacks : 0.0,
+			session->frame > 0 ? resimulate_us / session->frame : 0.0,
+			session->stalls, session->packets_lost, session->packets_sent, session->desyncs );
+}
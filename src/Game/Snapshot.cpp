@@ -0,0 +1,546 @@
+/*************************************/
+/** Snapshot <source file>			**/
+/**									**/
+/** Saves the live sim state into a	**/
+/** flat buffer, and restores it.	**/
+/** Used for rewinding, rollback	**/
+/** and test fixtures.				**/
+/*************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Game.h"
+
+/*
+	Snapshots hold only what the sim changes: the pools up
+	to their live counts, the players, score, random state,
+	timers and background scroll. SDL handles, textures,
+	fonts and the tables built at setup are left out, and
+	are kept as they are when restoring. Particles are only
+	for show, so they are left out too, and cleared when
+	restoring. Snapshots are
+	taken between ticks, when the event queue is empty.
+
+	Layout, after the header, is written and read by the
+	same function, so the two can't drift apart.
+*/
+
+struct SnapshotHeader
+{
+	Uint32					magic;
+	Uint16					version;
+	Uint16					enemy_count;
+	Uint32					size; 			// bytes, header included
+	Uint16					proj_friendly_count;
+	Uint16					proj_enemy_count;
+};
+
+struct SnapshotCursor
+{
+	Uint8*					data; 			// nullptr when only counting bytes
+	Uint32					used;
+	Uint32					capacity;
+	bool					saving;
+	bool					failed;
+};
+
+// Timer callbacks are saved as an index into this table,
+// so a snapshot holds no function pointers
+static TimerCallback const 	snapshot_timer_callbacks[] =
+{
+	nullptr,
+	EnemyFireTimer,
+	PlayerReloadTimer,
+	GameResetTimer,
+};
+
+static const Uint16 snapshot_timer_callback_count = sizeof(snapshot_timer_callbacks) / sizeof(snapshot_timer_callbacks[0]);
+
+// Copies a value between the game and the snapshot
+#define SNAPSHOT_FIELD(cursor, value) SnapshotField( cursor, &(value), sizeof(value) )
+
+// Copies a value into or out of a reserved block
+#define SNAPSHOT_COPY(at, value, saving) SnapshotCopy( at, &(value), sizeof(value), saving )
+
+// Bytes kept for each projectile, and each enemy projectile,
+// which is placed from its path each tick
+static const Uint32 snapshot_projectile_bytes 		= 3 + 4*4 + sizeof(SDL_Rect) + sizeof(Point) + 2 + 4;
+static const Uint32 snapshot_enemy_projectile_bytes = 1 + 4*2 + 2 + 4;
+
+/*
+	Snapshot Field
+
+	Purpose: Copies bytes into the snapshot when saving,
+			or out of it when restoring. Running past the
+			end of the buffer marks the cursor as failed.
+
+	Parameters: Cursor - the snapshot cursor
+				Value - the bytes in the game
+				Size - the number of bytes
+
+	Return:	Nil
+*/
+
+static inline void 	SnapshotField( SnapshotCursor* cursor, void* value, Uint32 size )
+{
+	if ( cursor->data != nullptr )
+	{
+		if ( cursor->used + size > cursor->capacity )
+		{
+			cursor->failed = true;
+			return;
+		}
+
+		if ( cursor->saving )
+			memcpy( cursor->data + cursor->used, value, size );
+		else
+			memcpy( value, cursor->data + cursor->used, size );
+	}
+
+	cursor->used += size;
+}
+
+/*
+	Snapshot Reserve
+
+	Purpose: Makes room for a block of objects at once,
+			so they can be copied without checking the
+			buffer for each field.
+
+	Parameters: Cursor - the snapshot cursor
+				Bytes - the size of the block
+
+	Return:	The start of the block, or nullptr if only
+			counting bytes, or the buffer is too small
+*/
+
+static Uint8* 	SnapshotReserve( SnapshotCursor* cursor, Uint32 bytes )
+{
+	Uint8* block = nullptr;
+
+	if ( cursor->data != nullptr )
+	{
+		if ( cursor->used + bytes > cursor->capacity )
+		{
+			cursor->failed = true;
+			return nullptr;
+		}
+
+		block = cursor->data + cursor->used;
+	}
+
+	cursor->used += bytes;
+	return block;
+}
+
+/*
+	Snapshot Copy
+
+	Purpose: Copies a value into or out of a reserved
+			block, and moves on past it.
+
+	Parameters: At - the place in the block
+				Value - the bytes in the game
+				Size - the number of bytes
+				Saving - True to copy into the block
+
+	Return:	Nil
+*/
+
+static inline void 	SnapshotCopy( Uint8*& at, void* value, Uint32 size, bool saving )
+{
+	if ( saving )
+		memcpy( at, value, size );
+	else
+		memcpy( value, at, size );
+
+	at += size;
+}
+
+/*
+	Snapshot Animation
+
+	Purpose: Copies an animation, field by field, so no
+			padding ends up in the snapshot.
+
+	Parameters: Cursor - the snapshot cursor
+				Ani - the animation
+
+	Return:	Nil
+*/
+
+static inline void 	SnapshotAnimation( SnapshotCursor* cursor, Animation* ani )
+{
+	SNAPSHOT_FIELD( cursor, ani->def );
+	SNAPSHOT_FIELD( cursor, ani->position );
+}
+
+/*
+	Snapshot Projectiles
+
+	Purpose: Copies the friendly projectile pool, up to
+			its live count.
+
+	Parameters: Cursor - the snapshot cursor
+				Projs - the projectile pool
+				Count - the number of live projectiles
+
+	Return:	Nil
+*/
+
+static void 	SnapshotProjectiles( SnapshotCursor* cursor, Projectile* projs, Uint16 count )
+{
+	Uint8* at = SnapshotReserve( cursor, count * snapshot_projectile_bytes );
+	if ( at == nullptr )
+		return;
+
+	bool saving = cursor->saving;
+
+	for( Uint16 i = 0; i < count; i++ )
+	{
+		Projectile* proj = &(projs[i]);
+
+		SNAPSHOT_COPY( at, proj->alive, saving );
+		SNAPSHOT_COPY( at, proj->damage, saving );
+		SNAPSHOT_COPY( at, proj->friendly, saving );
+		SNAPSHOT_COPY( at, proj->pos.x, saving );
+		SNAPSHOT_COPY( at, proj->pos.y, saving );
+		SNAPSHOT_COPY( at, proj->vel.x, saving );
+		SNAPSHOT_COPY( at, proj->vel.y, saving );
+		SNAPSHOT_COPY( at, proj->collision, saving );
+		SNAPSHOT_COPY( at, proj->col_offset, saving );
+		SNAPSHOT_COPY( at, proj->ani.def, saving );
+		SNAPSHOT_COPY( at, proj->ani.position, saving );
+	}
+}
+
+/*
+	Snapshot Enemy Projectiles
+
+	Purpose: Copies the enemy projectile pool, up to its
+			live count. The rest of where a projectile is
+			comes from its path, on the next tick, so
+			only its position is kept, for drawing.
+
+	Parameters: Cursor - the snapshot cursor
+				Projs - the projectile pool
+				Count - the number of live projectiles
+
+	Return:	Nil
+*/
+
+static void 	SnapshotEnemyProjectiles( SnapshotCursor* cursor, Projectile* projs, Uint16 count )
+{
+	Uint8* at = SnapshotReserve( cursor, count * snapshot_enemy_projectile_bytes );
+	if ( at == nullptr )
+		return;
+
+	bool saving = cursor->saving;
+
+	for( Uint16 i = 0; i < count; i++ )
+	{
+		Projectile* proj = &(projs[i]);
+
+		SNAPSHOT_COPY( at, proj->damage, saving );
+		SNAPSHOT_COPY( at, proj->pos.x, saving );
+		SNAPSHOT_COPY( at, proj->pos.y, saving );
+		SNAPSHOT_COPY( at, proj->ani.def, saving );
+		SNAPSHOT_COPY( at, proj->ani.position, saving );
+
+		proj->alive = true;
+		proj->friendly = false;
+	}
+}
+
+/*
+	Snapshot Timers
+
+	Purpose: Copies the timer wheel, with each callback
+			swapped for its index in the callback table.
+
+	Parameters: Cursor - the snapshot cursor
+				Wheel - the timer wheel
+
+	Return:	Nil
+*/
+
+static void 	SnapshotTimers( SnapshotCursor* cursor, TimerWheel* wheel )
+{
+	SNAPSHOT_FIELD( cursor, wheel->tick );
+	SNAPSHOT_FIELD( cursor, wheel->free_list );
+	SNAPSHOT_FIELD( cursor, wheel->active );
+	SNAPSHOT_FIELD( cursor, wheel->slots );
+
+	for( Uint16 i = 0; i < TIMER_CAPACITY; i++ )
+	{
+		Timer* timer = &(wheel->timers[i]);
+
+		Uint16 callback = 0;
+		if ( cursor->saving )
+		{
+			while( callback < snapshot_timer_callback_count && snapshot_timer_callbacks[callback] != timer->callback )
+				++callback;
+
+			if ( callback == snapshot_timer_callback_count )
+			{
+				printf( "Error: Can't snapshot an unknown timer callback\n" );
+				cursor->failed = true;
+				return;
+			}
+		}
+
+		SNAPSHOT_FIELD( cursor, callback );
+
+		if ( !cursor->saving )
+		{
+			if ( callback >= snapshot_timer_callback_count )
+			{
+				cursor->failed = true;
+				return;
+			}
+
+			timer->callback = snapshot_timer_callbacks[callback];
+		}
+
+		SNAPSHOT_FIELD( cursor, timer->target );
+		SNAPSHOT_FIELD( cursor, timer->tick );
+		SNAPSHOT_FIELD( cursor, timer->next );
+		SNAPSHOT_FIELD( cursor, timer->prev );
+		SNAPSHOT_FIELD( cursor, timer->slot );
+	}
+}
+
+/*
+	Snapshot Transfer
+
+	Purpose: Copies all of the sim state after the
+			header, in either direction. The live counts
+			must already be set in the game.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Cursor - the snapshot cursor
+
+	Return:	Nil
+*/
+
+static void 	SnapshotTransfer( Game* game, SnapshotCursor* cursor )
+{
+	// Game
+	SNAPSHOT_FIELD( cursor, game->playing );
+	SNAPSHOT_FIELD( cursor, game->needs_reset );
+	SNAPSHOT_FIELD( cursor, game->score );
+	SNAPSHOT_FIELD( cursor, game->high_score );
+	SNAPSHOT_FIELD( cursor, game->random_state );
+	SNAPSHOT_FIELD( cursor, game->background_y );
+	SNAPSHOT_FIELD( cursor, game->background_yspeed );
+
+	// Players
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+	{
+		Player* player = &(game->players[p]);
+
+		SNAPSHOT_FIELD( cursor, player->joined );
+		SNAPSHOT_FIELD( cursor, player->alive );
+		SNAPSHOT_FIELD( cursor, player->reloading );
+		SNAPSHOT_FIELD( cursor, player->hp );
+		SNAPSHOT_FIELD( cursor, player->hp_max );
+		SNAPSHOT_FIELD( cursor, player->pos.x );
+		SNAPSHOT_FIELD( cursor, player->pos.y );
+		SNAPSHOT_FIELD( cursor, player->vel.x );
+		SNAPSHOT_FIELD( cursor, player->vel.y );
+		SNAPSHOT_FIELD( cursor, player->collision );
+		SNAPSHOT_FIELD( cursor, player->col_offset );
+		SnapshotAnimation( cursor, &(player->ship_ani) );
+	}
+
+	// Enemies
+	SNAPSHOT_FIELD( cursor, game->enemy_behaviour_end );
+
+	for( Uint16 i = 0; i < game->enemy_count; i++ )
+	{
+		Enemy* enemy = &(game->enemies[i]);
+		EnemyCold* cold = &(game->enemies_cold[i]);
+
+		SNAPSHOT_FIELD( cursor, enemy->alive );
+		SNAPSHOT_FIELD( cursor, enemy->hp );
+		SNAPSHOT_FIELD( cursor, enemy->behaviour );
+		SNAPSHOT_FIELD( cursor, enemy->pos.x );
+		SNAPSHOT_FIELD( cursor, enemy->pos.y );
+		SNAPSHOT_FIELD( cursor, enemy->vel.x );
+		SNAPSHOT_FIELD( cursor, enemy->vel.y );
+		SNAPSHOT_FIELD( cursor, enemy->collision );
+		SNAPSHOT_FIELD( cursor, enemy->col_offset );
+		SNAPSHOT_FIELD( cursor, enemy->data.straight_data.fire_interval );
+		SNAPSHOT_FIELD( cursor, enemy->data.straight_data.pattern );
+
+		SNAPSHOT_FIELD( cursor, cold->type );
+		SNAPSHOT_FIELD( cursor, cold->hp_max );
+		SNAPSHOT_FIELD( cursor, cold->score_value );
+		SNAPSHOT_FIELD( cursor, cold->fire_timer );
+		SnapshotAnimation( cursor, &(cold->ship_ani) );
+	}
+
+	// Projectiles
+	SnapshotProjectiles( cursor, game->projectiles_friendly, game->proj_friendly_count );
+	SnapshotEnemyProjectiles( cursor, game->projectiles_enemy, game->proj_enemy_count );
+
+	BulletPaths* paths = &(game->bullet_paths);
+	Uint32 path_bytes = game->proj_enemy_count * 4;
+
+	SnapshotField( cursor, paths->origin_x, path_bytes );
+	SnapshotField( cursor, paths->origin_y, path_bytes );
+	SnapshotField( cursor, paths->dir_x, path_bytes );
+	SnapshotField( cursor, paths->dir_y, path_bytes );
+	SnapshotField( cursor, paths->speed, path_bytes );
+	SnapshotField( cursor, paths->accel, path_bytes );
+	SnapshotField( cursor, paths->spawn_tick, path_bytes );
+	SnapshotField( cursor, paths->exit_tick, path_bytes );
+
+	// Timers
+	SnapshotTimers( cursor, &(game->timers) );
+}
+
+/*
+	Game Snapshot Size
+
+	Purpose: Finds how many bytes a snapshot of the game
+			would take right now.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	The size of the snapshot, in bytes
+*/
+
+Uint32 			GameSnapshotSize( Game* game )
+{
+	SnapshotCursor cursor = { nullptr, sizeof(SnapshotHeader), 0, true, false };
+	SnapshotTransfer( game, &cursor );
+
+	return cursor.used;
+}
+
+/*
+	Game Snapshot Save
+
+	Purpose: Saves the sim state into a buffer.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Buffer - where to write the snapshot
+				Capacity - the size of the buffer
+
+	Return:	The number of bytes written, or 0 if the
+			buffer is too small
+*/
+
+Uint32 			GameSnapshotSave( Game* game, void* buffer, Uint32 capacity )
+{
+	if ( capacity < sizeof(SnapshotHeader) )
+		return 0;
+
+	SnapshotCursor cursor = { (Uint8*)buffer, sizeof(SnapshotHeader), capacity, true, false };
+	SnapshotTransfer( game, &cursor );
+
+	if ( cursor.failed )
+		return 0;
+
+	// Header last, once the size is known
+	SnapshotHeader header;
+	header.magic 				= GAME_SNAPSHOT_MAGIC;
+	header.version 				= GAME_SNAPSHOT_VERSION;
+	header.enemy_count 			= game->enemy_count;
+	header.size 				= cursor.used;
+	header.proj_friendly_count 	= game->proj_friendly_count;
+	header.proj_enemy_count 	= game->proj_enemy_count;
+
+	memcpy( buffer, &header, sizeof(header) );
+
+	return cursor.used;
+}
+
+/*
+	Game Snapshot Restore
+
+	Purpose: Puts the game back to the state held in a
+			snapshot. The header is checked before
+			anything is changed.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Buffer - the snapshot
+				Size - the size of the snapshot, in bytes
+
+	Return:	True if the game was restored. If the
+			snapshot fails part way through, the game is
+			left part restored, and should be reset.
+*/
+
+bool 			GameSnapshotRestore( Game* game, const void* buffer, Uint32 size )
+{
+	SnapshotHeader header;
+
+	if ( size < sizeof(header) )
+	{
+		printf( "Error: Snapshot too small\n" );
+		return false;
+	}
+
+	memcpy( &header, buffer, sizeof(header) );
+
+	if ( header.magic != GAME_SNAPSHOT_MAGIC || header.version != GAME_SNAPSHOT_VERSION )
+	{
+		printf( "Error: Snapshot is not version %d\n", GAME_SNAPSHOT_VERSION );
+		return false;
+	}
+
+	if ( header.size != size ||
+		 header.enemy_count > POOLSIZE_ENEMY ||
+		 header.proj_friendly_count > POOLSIZE_FRIENDLY_PROJ ||
+		 header.proj_enemy_count > POOLSIZE_ENEMY_PROJ )
+	{
+		printf( "Error: Snapshot doesn't fit this game\n" );
+		return false;
+	}
+
+	game->enemy_count 			= header.enemy_count;
+	game->proj_friendly_count 	= header.proj_friendly_count;
+	game->proj_enemy_count 		= header.proj_enemy_count;
+
+	SnapshotCursor cursor = { (Uint8*)buffer, sizeof(header), size, false, false };
+	SnapshotTransfer( game, &cursor );
+
+	// Update functions come from the enemy's type
+	for( Uint16 i = 0; i < game->enemy_count && !cursor.failed; i++ )
+	{
+		EnemyType type = game->enemies_cold[i].type;
+
+		if ( type >= game->enemy_archetype_count )
+			cursor.failed = true;
+		else
+			game->enemies[i].update = game->enemy_archetypes[type].hot.update;
+	}
+
+	if ( cursor.failed || cursor.used != size )
+	{
+		printf( "Error: Snapshot is damaged\n" );
+		return false;
+	}
+
+	// Slots past the live count hold no timers, as after a kill
+	for( Uint16 i = game->enemy_count; i < POOLSIZE_ENEMY; i++ )
+	{
+		game->enemies[i].alive = false;
+		game->enemies_cold[i].fire_timer = TIMER_NONE;
+	}
+
+	// Snapshots are taken between ticks
+	game->events.count = 0;
+
+	// None saved, so none left over from the game restored over
+	ParticleSystemClear( &(game->particles) );
+
+	return true;
+}
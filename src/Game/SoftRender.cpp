@@ -0,0 +1,800 @@
+/*************************************/
+/** SoftRender <source file>		**/
+/**									**/
+/** Draws the game on the CPU, into	**/
+/** a caller's buffer, at a smaller	**/
+/** size. For agents and headless	**/
+/** runs, which have no GPU.		**/
+/*************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "Game.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
+// Grayscale weights (BT.601), out of 256
+#define SOFT_GRAY_R 77
+#define SOFT_GRAY_G 150
+#define SOFT_GRAY_B 29
+
+// Bytes a pixel, indexed by SoftRenderFormat
+static const Uint32 	soft_format_bytes[soft_render_format_count] = { 1, 3, 4 };
+
+/*
+	Soft Div 255
+
+	Purpose: Divides by 255, rounding to nearest. Exact
+			for anything up to 255*255.
+
+	Parameters: X - the value to divide
+
+	Return:	X / 255
+*/
+
+static inline Uint32 	SoftDiv255( Uint32 x )
+{
+	x += 128;
+	return ( x + (x >> 8) ) >> 8;
+}
+
+/*
+	Soft Render Scale
+
+	Purpose: Moves a screen coordinate to the output
+
+	Parameters: Value - the screen coordinate
+				Scale - output pixels per screen pixel
+
+	Return:	The output coordinate
+*/
+
+static inline int 		SoftRenderScale( int value, float scale )
+{
+	return (int)floorf( value * scale + 0.5f );
+}
+
+/*
+	Soft Render Decode
+
+	Purpose: Decodes an image the same way the textures
+			are, into premultiplied RGBA, with the colour
+			key made see-through.
+
+	Parameters: Filename - the image file to load
+				Width - receives the width
+				Height - receives the height
+
+	Return:	The pixels, which the caller must delete [],
+			or nullptr if decoding failed
+*/
+
+static Uint32* 	SoftRenderDecode( const char* filename, Uint32* width, Uint32* height )
+{
+	SDL_Surface* surf = TextureDecodeFile( filename );
+	if ( !surf )
+		return nullptr;
+
+	Uint32 key = 0;
+	Uint8 key_r = 0, key_g = 0, key_b = 0;
+	bool keyed = SDL_GetColorKey( surf, &key ) == 0;
+
+	if ( keyed )
+		SDL_GetRGB( key, surf->format, &key_r, &key_g, &key_b );
+
+	SDL_Surface* rgba = SDL_ConvertSurfaceFormat( surf, SDL_PIXELFORMAT_RGBA32, 0 );
+	SDL_FreeSurface( surf );
+
+	if ( !rgba )
+	{
+		printf( "Unable to convert image %s! SDL Error: %s\n", filename, SDL_GetError() );
+		return nullptr;
+	}
+
+	*width = rgba->w;
+	*height = rgba->h;
+	Uint32* pixels = new Uint32[rgba->w * rgba->h];
+
+	SDL_LockSurface( rgba );
+
+	for( int y = 0; y < rgba->h; y++ )
+	{
+		const Uint8* src = (const Uint8*)rgba->pixels + y * rgba->pitch;
+		Uint8* dst = (Uint8*)(pixels + y * rgba->w);
+
+		for( int x = 0; x < rgba->w; x++, src += 4, dst += 4 )
+		{
+			Uint32 alpha = src[3];
+			if ( keyed && src[0] == key_r && src[1] == key_g && src[2] == key_b )
+				alpha = 0;
+
+			dst[0] = (Uint8)SoftDiv255( src[0] * alpha );
+			dst[1] = (Uint8)SoftDiv255( src[1] * alpha );
+			dst[2] = (Uint8)SoftDiv255( src[2] * alpha );
+			dst[3] = (Uint8)alpha;
+		}
+	}
+
+	SDL_UnlockSurface( rgba );
+	SDL_FreeSurface( rgba );
+
+	return pixels;
+}
+
+/*
+	Soft Render Resample
+
+	Purpose: Scales an image, each output pixel the
+			average of the area of the source it covers.
+			Only run while setting up, so kept simple.
+
+	Parameters: Src - the source pixels
+				Src Pitch - source pixels a row
+				Src W, Src H - the source area
+				Dst - where to put the scaled pixels,
+					Dst W by Dst H, packed
+
+	Return:	Nil
+*/
+
+static void 	SoftRenderResample( const Uint32* src, Uint32 src_pitch, Uint32 src_w, Uint32 src_h,
+									Uint32* dst, Uint32 dst_w, Uint32 dst_h )
+{
+	float step_x = (float)src_w / dst_w;
+	float step_y = (float)src_h / dst_h;
+
+	for( Uint32 dy = 0; dy < dst_h; dy++ )
+	{
+		float y0 = dy * step_y;
+		float y1 = y0 + step_y;
+
+		for( Uint32 dx = 0; dx < dst_w; dx++ )
+		{
+			float x0 = dx * step_x;
+			float x1 = x0 + step_x;
+
+			float sum[4] = {};
+			float area = 0;
+
+			for( Uint32 sy = (Uint32)y0; sy < src_h && sy < y1; sy++ )
+			{
+				float weight_y = fminf( y1, sy + 1.0f ) - fmaxf( y0, (float)sy );
+				const Uint8* row = (const Uint8*)(src + sy * src_pitch);
+
+				for( Uint32 sx = (Uint32)x0; sx < src_w && sx < x1; sx++ )
+				{
+					float weight = weight_y * ( fminf( x1, sx + 1.0f ) - fmaxf( x0, (float)sx ) );
+
+					for( Uint32 c = 0; c < 4; c++ )
+						sum[c] += row[sx*4 + c] * weight;
+
+					area += weight;
+				}
+			}
+
+			Uint8* out = (Uint8*)(dst + dy * dst_w + dx);
+			for( Uint32 c = 0; c < 4; c++ )
+				out[c] = area > 0 ? (Uint8)( sum[c] / area + 0.5f ) : 0;
+		}
+	}
+}
+
+/*
+	Soft Render Init
+
+	Purpose: Sets up a software renderer for one output
+			size and format. The sprite sheet and the
+			background are decoded from their files, and
+			every frame is scaled once, here, so drawing
+			is only copies and blends. Set it up again if
+			the animations are reloaded.
+
+	Parameters: Game - a pointer to the Game object,
+					for its animation frames.
+				Soft - the renderer to set up
+				Width - output width, up to SCREEN_WIDTH
+				Height - output height, up to SCREEN_HEIGHT
+				Format - the output pixel layout
+
+	Return:	True if it was set up, otherwise false
+			<Boolean>
+*/
+
+bool 			SoftRenderInit( Game* game, SoftRenderer* soft, Uint16 width, Uint16 height, SoftRenderFormat format )
+{
+	if ( width == 0 || height == 0 || width > SCREEN_WIDTH || height > SCREEN_HEIGHT
+		 || format >= soft_render_format_count )
+	{
+		printf( "Unable to set up the software renderer! It can't draw %ux%u in format %u\n",
+				width, height, (Uint32)format );
+		return false;
+	}
+
+	SoftRenderFree( soft );
+
+	Uint32 sheet_w = 0, sheet_h = 0;
+	Uint32* sheet = SoftRenderDecode( TEXTURE_PRIMARY_FILE, &sheet_w, &sheet_h );
+	if ( sheet == nullptr )
+		return false;
+
+	Uint32 back_w = 0, back_h = 0;
+	Uint32* back = SoftRenderDecode( TEXTURE_BACKGROUND_FILE, &back_w, &back_h );
+	if ( back == nullptr )
+	{
+		delete [] sheet;
+		return false;
+	}
+
+	soft->width = width;
+	soft->height = height;
+	soft->format = format;
+	soft->scale_x = (float)width / SCREEN_WIDTH;
+	soft->scale_y = (float)height / SCREEN_HEIGHT;
+
+	// Every animation frame, then each sprite particle's frames
+	SDL_Rect clips[SOFT_RENDER_TILE_MAX];
+	soft->tile_count = 0;
+
+	for( Uint16 f = 0; f < game->animation_frame_count; f++ )
+		clips[soft->tile_count++] = game->animation_frames[f];
+
+	for( Uint16 t = 0; t < part_type_count; t++ )
+	{
+		const ParticleEmitterDef* def = ParticleEmitterGet( (PartType)t );
+		soft->particle_tiles[t] = soft->tile_count;
+
+		for( Uint16 f = 0; f < def->frame_count && soft->tile_count < SOFT_RENDER_TILE_MAX; f++ )
+			clips[soft->tile_count++] = { f*32, def->y_offset, 32, 32 };
+	}
+
+	// Lay the tiles out, then the background after them
+	Uint32 used = 0;
+
+	for( Uint16 i = 0; i < soft->tile_count; i++ )
+	{
+		SoftTile* tile = &(soft->tiles[i]);
+		tile->w = (Uint16)SDL_max( 1, SoftRenderScale( clips[i].w, soft->scale_x ) );
+		tile->h = (Uint16)SDL_max( 1, SoftRenderScale( clips[i].h, soft->scale_y ) );
+		tile->offset = used;
+		used += tile->w * tile->h;
+	}
+
+	Uint32 strip_h = SCREEN_HEIGHT + back_h;
+	soft->background_period = (Uint16)back_h;
+	soft->background_rows = (Uint16)SDL_max( 1, SoftRenderScale( strip_h, soft->scale_y ) );
+	soft->background_offset = used;
+	used += width * soft->background_rows;
+
+	soft->pixels = new Uint32[used];
+	soft->pixel_count = used;
+
+	// Frames hanging off the sheet are left see-through
+	for( Uint16 i = 0; i < soft->tile_count; i++ )
+	{
+		const SDL_Rect* clip = &(clips[i]);
+		SoftTile* tile = &(soft->tiles[i]);
+
+		if ( clip->x < 0 || clip->y < 0 || clip->w <= 0 || clip->h <= 0
+			 || (Uint32)(clip->x + clip->w) > sheet_w || (Uint32)(clip->y + clip->h) > sheet_h )
+		{
+			memset( soft->pixels + tile->offset, 0, tile->w * tile->h * sizeof(Uint32) );
+			continue;
+		}
+
+		SoftRenderResample( sheet + clip->y * sheet_w + clip->x, sheet_w, clip->w, clip->h,
+							soft->pixels + tile->offset, tile->w, tile->h );
+	}
+
+	// Tile the background down the strip, over the clear colour
+	Uint32* strip = new Uint32[SCREEN_WIDTH * strip_h];
+	const Uint8 clear[4] = { game->screen_color.r, game->screen_color.g, game->screen_color.b, 0xFF };
+
+	for( Uint32 y = 0; y < strip_h; y++ )
+	{
+		for( Uint32 x = 0; x < SCREEN_WIDTH; x++ )
+		{
+			const Uint8* src = (const Uint8*)(back + (y % back_h) * back_w + (x % back_w));
+			Uint8* dst = (Uint8*)(strip + y * SCREEN_WIDTH + x);
+
+			for( Uint32 c = 0; c < 4; c++ )
+				dst[c] = (Uint8)( src[c] + SoftDiv255( clear[c] * (255 - src[3]) ) );
+		}
+	}
+
+	SoftRenderResample( strip, SCREEN_WIDTH, SCREEN_WIDTH, strip_h,
+						soft->pixels + soft->background_offset, width, soft->background_rows );
+
+	delete [] strip;
+	delete [] back;
+	delete [] sheet;
+
+	printf( "Software renderer set up at %ux%u, %u tiles in %u KB\n",
+			width, height, soft->tile_count, used * (Uint32)sizeof(Uint32) / 1024 );
+
+	return true;
+}
+
+/*
+	Soft Render Free
+
+	Purpose: Frees a software renderer's pixels
+
+	Parameters: Soft - the renderer
+
+	Return:	Nil
+*/
+
+void 			SoftRenderFree( SoftRenderer* soft )
+{
+	if ( soft->pixels != nullptr )
+		delete [] soft->pixels;
+
+	soft->pixels = nullptr;
+	soft->pixel_count = 0;
+	soft->tile_count = 0;
+}
+
+/*
+	Soft Render Frame Size
+
+	Purpose: Gets the bytes in a frame, packed with no
+			padding between rows
+
+	Parameters: Soft - the renderer
+
+	Return:	The size of a frame, in bytes
+*/
+
+Uint32 			SoftRenderFrameSize( const SoftRenderer* soft )
+{
+	return soft->width * soft->height * soft_format_bytes[soft->format];
+}
+
+/*
+	Soft Render Blend Row
+
+	Purpose: Draws a row of premultiplied pixels over
+			another, tinted like SDL's texture colour mod.
+			The SSE2 and scalar paths give the same
+			results.
+
+	Parameters: Dst - the pixels drawn over
+				Src - the pixels to draw
+				Count - pixels in the row
+				Tint - colour mod, as RGBA bytes. Alpha
+					must be 0xFF.
+
+	Return:	Nil
+*/
+
+static void 	SoftRenderBlendRow( Uint32* dst, const Uint32* src, Uint32 count, Uint32 tint )
+{
+	Uint32 i = 0;
+
+	#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i half = _mm_set1_epi16( 128 );
+	const __m128i full = _mm_set1_epi16( 255 );
+	const __m128i mod = _mm_unpacklo_epi8( _mm_set1_epi32( (int)tint ), zero );
+	const bool tinted = tint != 0xFFFFFFFF;
+
+	// x / 255 on each 16 bit lane, the same as Soft Div 255
+	#define SOFT_DIV255_EPI16(x) _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( (x), half ), \
+												 _mm_srli_epi16( _mm_add_epi16( (x), half ), 8 ) ), 8 )
+
+	for( ; i + 4 <= count; i += 4 )
+	{
+		__m128i s = _mm_loadu_si128( (const __m128i*)(src + i) );
+		__m128i alpha = _mm_srli_epi32( s, 24 );
+
+		// Nothing to draw in these four
+		if ( _mm_movemask_epi8( _mm_cmpeq_epi32( alpha, zero ) ) == 0xFFFF )
+			continue;
+
+		__m128i d = _mm_loadu_si128( (const __m128i*)(dst + i) );
+
+		__m128i s_lo = _mm_unpacklo_epi8( s, zero );
+		__m128i s_hi = _mm_unpackhi_epi8( s, zero );
+
+		if ( tinted )
+		{
+			s_lo = SOFT_DIV255_EPI16( _mm_mullo_epi16( s_lo, mod ) );
+			s_hi = SOFT_DIV255_EPI16( _mm_mullo_epi16( s_hi, mod ) );
+		}
+
+		// 255 - alpha, on all four channels of each pixel
+		alpha = _mm_or_si128( alpha, _mm_slli_epi32( alpha, 16 ) );
+		__m128i inv_lo = _mm_sub_epi16( full, _mm_unpacklo_epi32( alpha, alpha ) );
+		__m128i inv_hi = _mm_sub_epi16( full, _mm_unpackhi_epi32( alpha, alpha ) );
+
+		__m128i d_lo = SOFT_DIV255_EPI16( _mm_mullo_epi16( _mm_unpacklo_epi8( d, zero ), inv_lo ) );
+		__m128i d_hi = SOFT_DIV255_EPI16( _mm_mullo_epi16( _mm_unpackhi_epi8( d, zero ), inv_hi ) );
+
+		_mm_storeu_si128( (__m128i*)(dst + i), _mm_packus_epi16( _mm_add_epi16( s_lo, d_lo ),
+																 _mm_add_epi16( s_hi, d_hi ) ) );
+	}
+
+	#undef SOFT_DIV255_EPI16
+	#endif // __SSE2__
+
+	const Uint8* m = (const Uint8*)&tint;
+
+	for( ; i < count; i++ )
+	{
+		const Uint8* s = (const Uint8*)(src + i);
+		Uint8* d = (Uint8*)(dst + i);
+
+		Uint32 inv = 255 - s[3];
+		if ( inv == 255 )
+			continue;
+
+		for( Uint32 c = 0; c < 4; c++ )
+		{
+			Uint32 value = SoftDiv255( s[c] * m[c] ) + SoftDiv255( d[c] * inv );
+			d[c] = (Uint8)( value > 255 ? 255 : value );
+		}
+	}
+}
+
+/*
+	Soft Render Blit
+
+	Purpose: Draws a tile into a band, clipped to it
+
+	Parameters: Soft - the renderer
+				Rows - the band's pixels
+				Stride - pixels from one row to the next
+				Top, Bottom - the output rows the band
+					holds, bottom not included
+				Tile - the tile to draw
+				Screen X, Screen Y - where Game Render
+					would draw it, in screen pixels
+				Tint - colour mod, or nullptr
+
+	Return:	Nil
+*/
+
+static void 	SoftRenderBlit( const SoftRenderer* soft, Uint32* rows, Uint32 stride, int top, int bottom,
+								const SoftTile* tile, int screen_x, int screen_y, const SDL_Color* tint )
+{
+	int x = SoftRenderScale( screen_x, soft->scale_x );
+	int y = SoftRenderScale( screen_y, soft->scale_y );
+
+	int x0 = SDL_max( x, 0 );
+	int x1 = SDL_min( x + tile->w, (int)soft->width );
+	int y0 = SDL_max( y, top );
+	int y1 = SDL_min( y + tile->h, bottom );
+
+	if ( x0 >= x1 || y0 >= y1 )
+		return;
+
+	Uint32 mod = 0xFFFFFFFF;
+	if ( tint != nullptr )
+	{
+		const Uint8 bytes[4] = { tint->r, tint->g, tint->b, 0xFF };
+		memcpy( &mod, bytes, sizeof(mod) );
+	}
+
+	const Uint32* src = soft->pixels + tile->offset + (y0 - y) * tile->w + (x0 - x);
+	Uint32* dst = rows + (y0 - top) * stride + x0;
+
+	for( int row = y0; row < y1; row++, src += tile->w, dst += stride )
+		SoftRenderBlendRow( dst, src, x1 - x0, mod );
+}
+
+/*
+	Soft Render Fill
+
+	Purpose: Fills a rectangle in a band with a solid
+			colour, like SDL Render Fill Rect. Nothing
+			shrinks to less than a pixel.
+
+	Parameters: Soft - the renderer
+				Rows, Stride, Top, Bottom - the band, as
+					for Soft Render Blit
+				Rect - the rectangle, in screen pixels
+				Color - the colour
+
+	Return:	Nil
+*/
+
+static void 	SoftRenderFill( const SoftRenderer* soft, Uint32* rows, Uint32 stride, int top, int bottom,
+								const SDL_Rect* rect, SDL_Color color )
+{
+	if ( rect->w <= 0 || rect->h <= 0 )
+		return;
+
+	int x = SoftRenderScale( rect->x, soft->scale_x );
+	int y = SoftRenderScale( rect->y, soft->scale_y );
+	int w = SDL_max( 1, SoftRenderScale( rect->x + rect->w, soft->scale_x ) - x );
+	int h = SDL_max( 1, SoftRenderScale( rect->y + rect->h, soft->scale_y ) - y );
+
+	int x0 = SDL_max( x, 0 );
+	int x1 = SDL_min( x + w, (int)soft->width );
+	int y0 = SDL_max( y, top );
+	int y1 = SDL_min( y + h, bottom );
+
+	if ( x0 >= x1 || y0 >= y1 )
+		return;
+
+	Uint32 value = 0;
+	const Uint8 bytes[4] = { color.r, color.g, color.b, 0xFF };
+	memcpy( &value, bytes, sizeof(value) );
+
+	for( int row = y0; row < y1; row++ )
+	{
+		Uint32* dst = rows + (row - top) * stride;
+
+		for( int col = x0; col < x1; col++ )
+			dst[col] = value;
+	}
+}
+
+/*
+	Soft Render Sprite
+
+	Purpose: Draws an animated object the way its
+			Render function would
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Soft, Rows, Stride, Top, Bottom - the
+					band, as for Soft Render Blit
+				Pos - the object's centre
+				Ani - the object's animation
+				Tint - colour mod, or nullptr
+
+	Return:	Nil
+*/
+
+static inline void 	SoftRenderSprite( Game* game, const SoftRenderer* soft, Uint32* rows, Uint32 stride, int top, int bottom,
+									  const Vector2D& pos, const Animation* ani, const SDL_Color* tint )
+{
+	Uint32 frame = (Uint32)( AnimationRect( game, ani ) - game->animation_frames );
+	if ( frame >= soft->tile_count )
+		return;
+
+	SoftRenderBlit( soft, rows, stride, top, bottom, &(soft->tiles[frame]),
+					(int)roundf(pos.x-16), (int)roundf(pos.y-16), tint );
+}
+
+/*
+	Soft Render Band
+
+	Purpose: Draws output rows Top to Bottom of the game,
+			in the same order as Game Render. The HUD's
+			text and numbers are left out, as there is no
+			font to draw them with.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Soft, Rows, Stride, Top, Bottom - the
+					band, as for Soft Render Blit
+
+	Return:	Nil
+*/
+
+static void 	SoftRenderBand( Game* game, const SoftRenderer* soft, Uint32* rows, Uint32 stride, int top, int bottom )
+{
+	// Background, scrolled. Also clears the band. The game wraps
+	// its scroll by the texture it was given, which headless
+	// games only stand in for, so wrap by the real image too
+	const Uint32* back = soft->pixels + soft->background_offset;
+	int back_y = game->background_y % soft->background_period;
+	int scroll = SoftRenderScale( soft->background_period - back_y, soft->scale_y );
+
+	for( int y = top; y < bottom; y++ )
+	{
+		int row = SDL_min( scroll + y, soft->background_rows - 1 );
+		memcpy( rows + (y - top) * stride, back + row * soft->width, soft->width * sizeof(Uint32) );
+	}
+
+	// Particles, sprites then rectangles
+	ParticleSystem* sys = &(game->particles);
+
+	for( Uint32 i = 0; i < sys->count; i++ )
+	{
+		const ParticleEmitterDef* def = ParticleEmitterGet( (PartType)sys->type[i] );
+		if ( def->frame_count == 0 )
+			continue;
+
+		Uint32 frame = (Uint32)sys->frame[i];
+		if ( frame >= def->frame_count || soft->particle_tiles[sys->type[i]] + frame >= soft->tile_count )
+			continue;
+
+		SoftRenderBlit( soft, rows, stride, top, bottom, &(soft->tiles[soft->particle_tiles[sys->type[i]] + frame]),
+						(int)roundf(sys->pos_x[i]-16), (int)roundf(sys->pos_y[i]-16), nullptr );
+	}
+
+	for( Uint32 i = 0; i < sys->count; i++ )
+	{
+		const ParticleEmitterDef* def = ParticleEmitterGet( (PartType)sys->type[i] );
+		if ( def->frame_count > 0 )
+			continue;
+
+		SDL_Rect rect = { (int)sys->pos_x[i] - def->size/2, (int)sys->pos_y[i] - def->size/2, def->size, def->size };
+		SoftRenderFill( soft, rows, stride, top, bottom, &rect, def->color );
+	}
+
+	// Projectiles, then enemies
+	for( Uint16 i = 0; i < game->proj_friendly_count; i++ )
+		SoftRenderSprite( game, soft, rows, stride, top, bottom,
+						  game->projectiles_friendly[i].pos, &(game->projectiles_friendly[i].ani), nullptr );
+
+	for( Uint16 i = 0; i < game->proj_enemy_count; i++ )
+		SoftRenderSprite( game, soft, rows, stride, top, bottom,
+						  game->projectiles_enemy[i].pos, &(game->projectiles_enemy[i].ani), nullptr );
+
+	for( Uint16 i = 0; i < game->enemy_count; i++ )
+		SoftRenderSprite( game, soft, rows, stride, top, bottom,
+						  game->enemies[i].pos, &(game->enemies_cold[i].ship_ani), nullptr );
+
+	// Players, tinted
+	for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+	{
+		Player* player = &(game->players[p]);
+		if ( player->alive == false )
+			continue;
+
+		SoftRenderSprite( game, soft, rows, stride, top, bottom,
+						  player->pos, &(player->ship_ani), PlayerTint( p ) );
+	}
+
+	// Health bars, as Game Render Hud draws them
+	if ( game->playing == true )
+	{
+		const SDL_Color red = { 0xFF, 0x00, 0x00, 0xFF };
+
+		for( Uint16 p = 0; p < PLAYER_MAX; p++ )
+		{
+			Player* player = &(game->players[p]);
+			if ( !player->joined || player->hp <= 0 )
+				continue;
+
+			float bar_length = (float)player->hp / (float)player->hp_max * 150.0f;
+			SDL_Rect bar = { 32, 32 + p*8, (int)bar_length, 4 };
+			SoftRenderFill( soft, rows, stride, top, bottom, &bar, red );
+		}
+	}
+}
+
+/*
+	Soft Render Convert Row
+
+	Purpose: Converts a drawn row to the output format
+
+	Parameters: Soft - the renderer
+				Src - the drawn row
+				Dst - where to write it
+
+	Return:	Nil
+*/
+
+static void 	SoftRenderConvertRow( const SoftRenderer* soft, const Uint32* src, Uint8* dst )
+{
+	Uint32 count = soft->width;
+	Uint32 i = 0;
+
+	if ( soft->format == SOFT_RENDER_RGB )
+	{
+		for( ; i < count; i++, dst += 3 )
+		{
+			const Uint8* s = (const Uint8*)(src + i);
+			dst[0] = s[0];
+			dst[1] = s[1];
+			dst[2] = s[2];
+		}
+		return;
+	}
+
+	#ifdef __SSE2__
+	const __m128i mask = _mm_set1_epi32( 0xFF );
+	const __m128i weight_r = _mm_set1_epi32( SOFT_GRAY_R );
+	const __m128i weight_g = _mm_set1_epi32( SOFT_GRAY_G );
+	const __m128i weight_b = _mm_set1_epi32( SOFT_GRAY_B );
+	const __m128i half = _mm_set1_epi32( 128 );
+
+	// Each product fits the low 16 bits of its 32 bit lane
+	for( ; i + 4 <= count; i += 4 )
+	{
+		__m128i s = _mm_loadu_si128( (const __m128i*)(src + i) );
+
+		__m128i gray = _mm_add_epi32( _mm_mullo_epi16( _mm_and_si128( s, mask ), weight_r ),
+									  _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi32( s, 8 ), mask ), weight_g ) );
+		gray = _mm_add_epi32( gray, _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi32( s, 16 ), mask ), weight_b ) );
+		gray = _mm_srli_epi32( _mm_add_epi32( gray, half ), 8 );
+
+		gray = _mm_packs_epi32( gray, gray );
+		Uint32 bytes = (Uint32)_mm_cvtsi128_si32( _mm_packus_epi16( gray, gray ) );
+		memcpy( dst + i, &bytes, sizeof(bytes) );
+	}
+	#endif // __SSE2__
+
+	for( ; i < count; i++ )
+	{
+		const Uint8* s = (const Uint8*)(src + i);
+		dst[i] = (Uint8)( ( s[0] * SOFT_GRAY_R + s[1] * SOFT_GRAY_G + s[2] * SOFT_GRAY_B + 128 ) >> 8 );
+	}
+}
+
+/*
+	Soft Render Game
+
+	Purpose: Draws the game as it is now into a buffer,
+			as Game Render would, at the renderer's size
+			and format. RGBA is drawn straight into the
+			buffer. Other formats are drawn a band at a
+			time in the frame arena, then converted.
+			Only reads the game, so many games can be
+			drawn at once on different threads.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+				Soft - the renderer, set up
+				Pixels - where to draw. RGBA must be 4
+					byte aligned.
+				Pitch - bytes from one row to the next,
+					or 0 if rows are packed
+
+	Return:	True if the frame was drawn, otherwise
+			false <Boolean>
+*/
+
+bool 			SoftRenderGame( Game* game, const SoftRenderer* soft, void* pixels, Uint32 pitch )
+{
+	if ( soft->pixels == nullptr )
+	{
+		printf( "Unable to draw! The software renderer isn't set up\n" );
+		return false;
+	}
+
+	Uint32 row_bytes = soft->width * soft_format_bytes[soft->format];
+	if ( pitch == 0 )
+		pitch = row_bytes;
+
+	if ( pitch < row_bytes )
+	{
+		printf( "Unable to draw! A pitch of %u is too small for %u pixels\n", pitch, soft->width );
+		return false;
+	}
+
+	if ( soft->format == SOFT_RENDER_RGBA )
+	{
+		if ( pitch % 4 != 0 || (uintptr_t)pixels % 4 != 0 )
+		{
+			printf( "Unable to draw! RGBA pixels must be 4 byte aligned\n" );
+			return false;
+		}
+
+		SoftRenderBand( game, soft, (Uint32*)pixels, pitch / 4, 0, soft->height );
+		return true;
+	}
+
+	Uint32 band_rows = SDL_max( 1u, SOFT_RENDER_BAND_BYTES / (soft->width * (Uint32)sizeof(Uint32)) );
+
+	Uint32 mark = ArenaMark( &(game->frame_arena) );
+	Uint32* band = (Uint32*)ArenaAlloc( &(game->frame_arena), band_rows * soft->width * sizeof(Uint32), 16 );
+
+	if ( band == nullptr )
+	{
+		printf( "Unable to draw! No room in the frame arena for a band\n" );
+		return false;
+	}
+
+	for( Uint32 top = 0; top < soft->height; top += band_rows )
+	{
+		Uint32 bottom = SDL_min( top + band_rows, (Uint32)soft->height );
+		SoftRenderBand( game, soft, band, soft->width, top, bottom );
+
+		for( Uint32 y = top; y < bottom; y++ )
+			SoftRenderConvertRow( soft, band + (y - top) * soft->width, (Uint8*)pixels + y * pitch );
+	}
+
+	ArenaRewind( &(game->frame_arena), mark );
+
+	return true;
+}
@@ -73,6 +73,13 @@ void			TextureFree( AssetTexture* tex )
 		tex->name = nullptr;
 	}
 
+	// Clear Path
+	if ( tex->path != nullptr )
+	{
+		delete [] tex->path;
+		tex->path = nullptr;
+	}
+
 	// Clear Texture
 	if ( tex->texture != nullptr )
 	{
@@ -85,6 +92,81 @@ void			TextureFree( AssetTexture* tex )
 	tex->height = 0;
 }
 
+/*
+	Texture Decode File
+
+	Purpose: Decodes an image file into a colour
+			keyed surface, ready to be uploaded as a
+			texture. Does not touch the renderer, so it
+			is safe to call away from the main thread.
+
+	Parameters: Filename - the name of the image file
+					to load from
+
+	Return:	The decoded surface, which the caller must
+			free, or nullptr if decoding failed
+*/
+
+SDL_Surface*	TextureDecodeFile( const char* filename )
+{
+	// Load the image from the file
+	SDL_Surface* surf = IMG_Load( filename );
+
+	// Check for Image Loading Errors
+	if ( !surf )
+	{
+		printf( "Unable to load image %s! SDL_image Error: %s\n", filename, IMG_GetError() );
+		return nullptr;
+	}
+
+	// Color Image
+	SDL_SetColorKey( surf, SDL_TRUE, SDL_MapRGB( surf->format, 0, 0xFF, 0xFF ) );
+
+	return surf;
+}
+
+/*
+	Texture Load Surface
+
+	Purpose: Replaces the texture data with a texture
+			created from an already decoded surface. The
+			old texture is only destroyed once the new one
+			has been created, so a failed reload leaves the
+			asset drawable.
+
+	Parameters: Tex - a pointer to the texture
+					asset
+				Render - a pointer to the render device
+					to draw the texture to
+				Surf - the decoded surface. It is not
+					freed by this function.
+
+	Return:	True if the texture was successfully
+			created, otherwise false <Boolean>
+*/
+
+bool			TextureLoadSurface( AssetTexture* tex, SDL_Renderer* render, SDL_Surface* surf )
+{
+	// Set Texture from Surface
+	SDL_Texture* temp = SDL_CreateTextureFromSurface( render, surf );
+	if ( !temp )
+	{
+		printf( "Unable to create texture for %s! SDL Error: %s\n", tex->name, SDL_GetError() );
+		return false;
+	}
+
+	// Swap in the new Texture
+	if ( tex->texture != nullptr )
+		SDL_DestroyTexture( tex->texture );
+
+	tex->texture = temp;
+	tex->width = surf->w;
+	tex->height = surf->h;
+
+	// Return Success
+	return true;
+}
+
 /*
 	Texture Load File
 
@@ -115,44 +197,28 @@ bool			TextureLoadFile( AssetTexture* tex, SDL_Renderer* render, const char* fil
 	tex->width = 0;
 	tex->height = 0;
 
-	// Create a temp spot for the new texture
-	SDL_Texture* temp = nullptr;
+	// Remember where we came from, so the file can be watched
+	if ( tex->path != nullptr )
+		delete [] tex->path;
 
-	// Load the image from the file
-	SDL_Surface* surf = IMG_Load( filename );
+	tex->path = new char[strlen(filename)+1];
+	strcpy( tex->path, filename );
 
-	// Check for Image Loading Errors
+	// Load the image from the file
+	SDL_Surface* surf = TextureDecodeFile( filename );
 	if ( !surf )
-	{
-		printf( "Unable to load image %s! SDL_image Error: %s\n", filename, IMG_GetError() );
 		return false;
-	}
 
-	// If successful, create new texture from loaded image
-	else
+	// Create new texture from loaded image
+	if ( !TextureLoadSurface( tex, render, surf ) )
 	{
-		// Color Image
-		SDL_SetColorKey( surf, SDL_TRUE, SDL_MapRGB( surf->format, 0, 0xFF, 0xFF ) );
-
-		// Set Texture from Surface
-		temp = SDL_CreateTextureFromSurface( render, surf );
-		if ( !temp )
-		{
-			printf( "Unable to create texture from %s! SDL Error: %s\n", filename, SDL_GetError() );
-			SDL_FreeSurface(surf);
-			return false;
-		}
-		else
-		{
-			tex->texture = temp;
-			tex->width = surf->w;
-			tex->height = surf->h;
-		}
-
-		// We can now get rid of our surface
 		SDL_FreeSurface(surf);
+		return false;
 	}
 
+	// We can now get rid of our surface
+	SDL_FreeSurface(surf);
+
 	// Print Success Message
 	printf( "Texture successfully loaded from file: %s\n", filename );
 
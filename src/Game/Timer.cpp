@@ -0,0 +1,296 @@
+/*************************************/
+/** Timer <source file>				**/
+/**									**/
+/** A hierarchical timer wheel,		**/
+/** that calls a function at a		**/
+/** chosen sim tick. Scheduling and	**/
+/** cancelling don't search.		**/
+/*************************************/
+
+#include <stdio.h>
+
+#include "Game.h"
+
+/*
+	Timer Wheel Slot
+
+	Purpose: Finds the slot a timer belongs in, based
+			on how far away it is. Near timers go in
+			level 0, one slot per tick. Further timers
+			go in higher levels, where each slot covers
+			a span of ticks.
+
+	Parameters: Wheel - the timer wheel
+				Tick - the tick the timer fires on
+
+	Return:	The index of the slot in wheel->slots
+*/
+
+static Uint16 	TimerWheelSlot( TimerWheel* wheel, Uint32 tick )
+{
+	Uint32 delay = tick - wheel->tick;
+
+	Uint16 level = 0;
+	while( level < TIMER_WHEEL_LEVELS-1 && delay >= (1u << (TIMER_WHEEL_BITS * (level+1))) )
+		++level;
+
+	Uint32 index = ( tick >> (TIMER_WHEEL_BITS * level) ) & (TIMER_WHEEL_SLOTS-1);
+	return (Uint16)( level * TIMER_WHEEL_SLOTS + index );
+}
+
+/*
+	Timer Link
+
+	Purpose: Adds a timer to the front of a slot's list.
+
+	Parameters: Wheel - the timer wheel
+				Handle - the timer to add
+				Slot - the slot to add it to
+
+	Return:	Nil
+*/
+
+static void 	TimerLink( TimerWheel* wheel, Uint16 handle, Uint16 slot )
+{
+	Timer* timer = &(wheel->timers[handle]);
+
+	timer->slot = slot;
+	timer->prev = TIMER_NONE;
+	timer->next = wheel->slots[slot];
+
+	if ( timer->next != TIMER_NONE )
+		wheel->timers[timer->next].prev = handle;
+
+	wheel->slots[slot] = handle;
+}
+
+/*
+	Timer Unlink
+
+	Purpose: Removes a timer from the slot it is in.
+
+	Parameters: Wheel - the timer wheel
+				Handle - the timer to remove
+
+	Return:	Nil
+*/
+
+static void 	TimerUnlink( TimerWheel* wheel, Uint16 handle )
+{
+	Timer* timer = &(wheel->timers[handle]);
+
+	if ( timer->prev != TIMER_NONE )
+		wheel->timers[timer->prev].next = timer->next;
+	else
+		wheel->slots[timer->slot] = timer->next;
+
+	if ( timer->next != TIMER_NONE )
+		wheel->timers[timer->next].prev = timer->prev;
+
+	timer->slot = TIMER_NONE;
+	timer->next = TIMER_NONE;
+	timer->prev = TIMER_NONE;
+}
+
+/*
+	Timer Release
+
+	Purpose: Returns an unlinked timer to the free list.
+
+	Parameters: Wheel - the timer wheel
+				Handle - the timer to free
+
+	Return:	Nil
+*/
+
+static void 	TimerRelease( TimerWheel* wheel, Uint16 handle )
+{
+	Timer* timer = &(wheel->timers[handle]);
+
+	timer->callback = nullptr;
+	timer->next = wheel->free_list;
+	wheel->free_list = handle;
+
+	--wheel->active;
+}
+
+/*
+	Timer Wheel Init
+
+	Purpose: Sets up an empty timer wheel, starting at
+			tick 0.
+
+	Parameters: Wheel - the timer wheel
+
+	Return:	Nil
+*/
+
+void 			TimerWheelInit( TimerWheel* wheel )
+{
+	wheel->tick = 0;
+	TimerWheelClear( wheel );
+}
+
+/*
+	Timer Wheel Clear
+
+	Purpose: Cancels every timer, without firing them.
+			The tick count carries on. Any handles held
+			by objects are no longer valid.
+
+	Parameters: Wheel - the timer wheel
+
+	Return:	Nil
+*/
+
+void 			TimerWheelClear( TimerWheel* wheel )
+{
+	for( Uint16 i = 0; i < TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS; i++ )
+		wheel->slots[i] = TIMER_NONE;
+
+	// Chain every timer into the free list
+	for( Uint16 i = 0; i < TIMER_CAPACITY; i++ )
+	{
+		wheel->timers[i] 		= Timer();
+		wheel->timers[i].next 	= ( i+1 < TIMER_CAPACITY ? i+1 : TIMER_NONE );
+	}
+
+	wheel->free_list = 0;
+	wheel->active = 0;
+}
+
+/*
+	Timer Schedule
+
+	Purpose: Schedules a function to be called after a
+			number of sim ticks.
+
+	Parameters: Wheel - the timer wheel
+				Delay - ticks from now, at least 1
+				Callback - the function to call
+				Target - passed to the callback, such as
+					the index of the object it's for
+
+	Return:	A handle to the timer, for cancelling it, or
+			TIMER_NONE if there are no free timers
+*/
+
+Uint16 			TimerSchedule( TimerWheel* wheel, Uint32 delay, TimerCallback callback, Uint16 target )
+{
+	if ( wheel->free_list == TIMER_NONE )
+	{
+		printf( "Error: Out of timers!\n" );
+		return TIMER_NONE;
+	}
+
+	// Take a free Timer
+	Uint16 handle = wheel->free_list;
+	Timer* timer = &(wheel->timers[handle]);
+	wheel->free_list = timer->next;
+	++wheel->active;
+
+	timer->callback = callback;
+	timer->target 	= target;
+	timer->tick 	= wheel->tick + ( delay > 0 ? delay : 1 );
+
+	TimerLink( wheel, handle, TimerWheelSlot( wheel, timer->tick ) );
+
+	return handle;
+}
+
+/*
+	Timer Cancel
+
+	Purpose: Stops a timer from firing. Does nothing if
+			the handle is TIMER_NONE.
+
+	Parameters: Wheel - the timer wheel
+				Handle - the timer to cancel
+
+	Return:	Nil
+*/
+
+void 			TimerCancel( TimerWheel* wheel, Uint16 handle )
+{
+	if ( handle == TIMER_NONE || wheel->timers[handle].slot == TIMER_NONE )
+		return;
+
+	TimerUnlink( wheel, handle );
+	TimerRelease( wheel, handle );
+}
+
+/*
+	Timer Retarget
+
+	Purpose: Changes the target a timer will be called
+			with, for when the object it's for moves in
+			its pool.
+
+	Parameters: Wheel - the timer wheel
+				Handle - the timer to change
+				Target - the new target
+
+	Return:	Nil
+*/
+
+void 			TimerRetarget( TimerWheel* wheel, Uint16 handle, Uint16 target )
+{
+	if ( handle != TIMER_NONE )
+		wheel->timers[handle].target = target;
+}
+
+/*
+	Timer Wheel Advance
+
+	Purpose: Moves the wheel on by one tick, and calls
+			every timer due on the new tick. When a
+			level's slots wrap around, the next slot up
+			is emptied down into the levels below.
+			Callbacks may schedule and cancel timers.
+
+	Parameters: Game - a pointer to the Game object
+					running the game.
+
+	Return:	Nil
+*/
+
+void 			TimerWheelAdvance( Game* game )
+{
+	TimerWheel* wheel = &(game->timers);
+	Uint32 tick = ++wheel->tick;
+
+	// Find the highest level that has wrapped this tick
+	Uint16 wrapped = 0;
+	while( wrapped < TIMER_WHEEL_LEVELS-1 &&
+		   ( tick & ((1u << (TIMER_WHEEL_BITS * (wrapped+1))) - 1) ) == 0 )
+		++wrapped;
+
+	// Move timers down from the wrapped levels, highest first
+	for( Uint16 level = wrapped; level > 0; level-- )
+	{
+		Uint32 index = ( tick >> (TIMER_WHEEL_BITS * level) ) & (TIMER_WHEEL_SLOTS-1);
+		Uint16 slot = level * TIMER_WHEEL_SLOTS + index;
+
+		while( wheel->slots[slot] != TIMER_NONE )
+		{
+			Uint16 handle = wheel->slots[slot];
+			TimerUnlink( wheel, handle );
+			TimerLink( wheel, handle, TimerWheelSlot( wheel, wheel->timers[handle].tick ) );
+		}
+	}
+
+	// Fire everything due now, one at a time, so callbacks can
+	// cancel other timers in this slot
+	Uint16 slot = tick & (TIMER_WHEEL_SLOTS-1);
+
+	while( wheel->slots[slot] != TIMER_NONE )
+	{
+		Uint16 handle = wheel->slots[slot];
+		Timer timer = wheel->timers[handle];
+
+		TimerUnlink( wheel, handle );
+		TimerRelease( wheel, handle );
+
+		timer.callback( game, timer.target );
+	}
+}
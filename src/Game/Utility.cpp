@@ -7,6 +7,8 @@
 /** all throughout the game.		**/
 /*************************************/
 
+#include <math.h>
+
 #include "Game.h"
 
 /*
@@ -34,3 +36,366 @@ bool			UtilityAabbCheck( SDL_Rect* r1, SDL_Rect* r2 )
 
 	return true;
 }
+
+//////////////////////////////////////////////////////
+// Swept AABB Checks								//
+//////////////////////////////////////////////////////
+
+/*
+	Utility Sweep Axis
+
+	Purpose: Finds when, during a move along one axis,
+			a position is between two edges, and narrows
+			the given time span to match.
+
+	Parameters: Start - the position at the start of the
+					move
+				Delta - the distance moved
+				Low - the low edge
+				High - the high edge
+				Enter - the time the span starts, from
+					0 to 1, raised to fit this axis
+				Exit - the time the span ends, lowered
+					to fit this axis
+
+	Return:	False if the position is never between the
+			edges
+*/
+
+static bool 	UtilitySweepAxis( float start, float delta, float low, float high, float* enter, float* exit )
+{
+	// Not moving, so either always inside or never
+	if ( delta == 0 )
+		return ( start >= low && start < high );
+
+	float t_low = (low - start) / delta;
+	float t_high = (high - start) / delta;
+
+	if ( t_low > t_high )
+	{
+		float temp = t_low;
+		t_low = t_high;
+		t_high = temp;
+	}
+
+	if ( t_low > *enter )	*enter = t_low;
+	if ( t_high < *exit )	*exit = t_high;
+
+	return true;
+}
+
+/*
+	Utility AABB Sweep
+
+	Purpose: Checks if two moving boxes touched at any
+			point during a tick, rather than only where
+			they ended up, so fast objects can't pass
+			through each other between ticks. Boxes are
+			treated as moving in a straight line.
+
+	Parameters: R1 - the first box, where it ended the
+					tick
+				D1 - how far the first box moved this
+					tick
+				R2 - the second box, where it ended the
+					tick
+				D2 - how far the second box moved this
+					tick
+
+	Return:	True if the boxes collided during the tick
+*/
+
+bool			UtilityAabbSweep( const SDL_Rect* r1, const Vector2D& d1, const SDL_Rect* r2, const Vector2D& d2 )
+{
+	// Where they ended up, with the usual edges
+	SDL_Rect end1 = *r1;
+	SDL_Rect end2 = *r2;
+	if ( UtilityAabbCheck( &end1, &end2 ) )
+		return true;
+
+	// Move R2 relative to R1, so R1 stands still
+	float dx = d2.x - d1.x;
+	float dy = d2.y - d1.y;
+	float start_x = r2->x - dx;
+	float start_y = r2->y - dy;
+
+	// R2's corner must stay between these for the boxes to overlap
+	float enter = 0;
+	float exit = 1;
+
+	if ( !UtilitySweepAxis( start_x, dx, r1->x - r2->w, r1->x + r1->w, &enter, &exit ) )
+		return false;
+	if ( !UtilitySweepAxis( start_y, dy, r1->y - r2->h, r1->y + r1->h, &enter, &exit ) )
+		return false;
+
+	return ( enter < exit );
+}
+
+/*
+	Utility AABB Sweep Bounds
+
+	Purpose: Finds the box covering everywhere a box was
+			during a tick, used to quickly rule out pairs
+			before Utility AABB Sweep.
+
+	Parameters: Bounds - receives the covering box
+				Box - the box, where it ended the tick
+				Delta - how far the box moved this tick
+
+	Return:	Nil
+*/
+
+void			UtilityAabbSweepBounds( SDL_Rect* bounds, const SDL_Rect* box, const Vector2D& delta )
+{
+	int move_x = (int)ceilf( fabsf(delta.x) );
+	int move_y = (int)ceilf( fabsf(delta.y) );
+
+	bounds->x = ( delta.x > 0 ? box->x - move_x : box->x );
+	bounds->y = ( delta.y > 0 ? box->y - move_y : box->y );
+	bounds->w = box->w + move_x;
+	bounds->h = box->h + move_y;
+}
+
+//////////////////////////////////////////////////////
+// Batch AABB Checks								//
+//////////////////////////////////////////////////////
+
+/*
+	Utility AABB Batch Init
+
+	Purpose: Allocates the arrays for a batch of boxes
+			from an arena, so they only last the frame.
+
+	Parameters: Batch - a pointer to the batch
+				Arena - the arena to allocate from
+				Capacity - the most boxes the batch
+					will hold
+
+	Return:	True if the arrays were allocated
+*/
+
+bool			UtilityAabbBatchInit( AabbBatch* batch, FrameArena* arena, Uint32 capacity )
+{
+	Uint32 size = (capacity > 0 ? capacity : 1) * sizeof(Sint32);
+
+	batch->x = (Sint32*)ArenaAlloc( arena, size, 32 );
+	batch->y = (Sint32*)ArenaAlloc( arena, size, 32 );
+	batch->w = (Sint32*)ArenaAlloc( arena, size, 32 );
+	batch->h = (Sint32*)ArenaAlloc( arena, size, 32 );
+	batch->count = 0;
+	batch->capacity = capacity;
+
+	return ( batch->x != nullptr && batch->y != nullptr && batch->w != nullptr && batch->h != nullptr );
+}
+
+/*
+	Utility AABB Batch Add
+
+	Purpose: Adds a box to the end of a batch. The box
+			is dropped if the batch is full.
+
+	Parameters: Batch - a pointer to the batch
+				Rect - the box to add
+
+	Return:	Nil
+*/
+
+void			UtilityAabbBatchAdd( AabbBatch* batch, const SDL_Rect* rect )
+{
+	if ( batch->count >= batch->capacity )
+		return;
+
+	batch->x[batch->count] = rect->x;
+	batch->y[batch->count] = rect->y;
+	batch->w[batch->count] = rect->w;
+	batch->h[batch->count] = rect->h;
+	++batch->count;
+}
+
+/*
+	Utility AABB Check Scalar
+
+	Purpose: Checks boxes one at a time, from the given
+			index to the end of the batch. Used on its
+			own, and for the boxes left over after the
+			SIMD kernels.
+
+	Parameters: R1 - the box to check against
+				Batch - the boxes to check
+				Start - the first box to check
+				Hits - the hit bits to set
+
+	Return:	Nil
+*/
+
+static void 	UtilityAabbCheckScalar( const SDL_Rect* r1, const AabbBatch* batch, Uint32 start, Uint32* hits )
+{
+	SDL_Rect query = *r1;
+
+	for( Uint32 i = start; i < batch->count; i++ )
+	{
+		SDL_Rect box = { batch->x[i], batch->y[i], batch->w[i], batch->h[i] };
+
+		if ( UtilityAabbCheck( &query, &box ) )
+			hits[i >> 5] |= 1u << (i & 31);
+	}
+}
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+
+#include <immintrin.h>
+
+/*
+	The SIMD kernels do the same four tests as Utility
+	AABB Check, on 4 (SSE2) or 8 (AVX2) boxes at a time.
+	A box hits when:
+		r1.x <= x+w  and  x < r1.x+r1.w  and
+		r1.y <= y+h  and  y < r1.y+r1.h
+	Only signed greater-than compares exist, so the two
+	"miss" tests are done as r1.x > x+w, and masked out.
+*/
+
+__attribute__ ((target("sse2")))
+static Uint32 	UtilityAabbCheckSse2( const SDL_Rect* r1, const AabbBatch* batch, Uint32* hits )
+{
+	const __m128i left 		= _mm_set1_epi32( r1->x );
+	const __m128i right 	= _mm_set1_epi32( r1->x + r1->w );
+	const __m128i top 		= _mm_set1_epi32( r1->y );
+	const __m128i bottom 	= _mm_set1_epi32( r1->y + r1->h );
+
+	Uint32 i = 0;
+	for( ; i + 4 <= batch->count; i += 4 )
+	{
+		__m128i x = _mm_loadu_si128( (const __m128i*)(batch->x + i) );
+		__m128i y = _mm_loadu_si128( (const __m128i*)(batch->y + i) );
+		__m128i w = _mm_loadu_si128( (const __m128i*)(batch->w + i) );
+		__m128i h = _mm_loadu_si128( (const __m128i*)(batch->h + i) );
+
+		__m128i miss = _mm_or_si128( _mm_cmpgt_epi32( left, _mm_add_epi32( x, w ) ),
+									 _mm_cmpgt_epi32( top, _mm_add_epi32( y, h ) ) );
+		__m128i inside = _mm_and_si128( _mm_cmpgt_epi32( right, x ),
+										_mm_cmpgt_epi32( bottom, y ) );
+
+		Uint32 mask = (Uint32)_mm_movemask_ps( _mm_castsi128_ps( _mm_andnot_si128( miss, inside ) ) );
+		hits[i >> 5] |= mask << (i & 31);
+	}
+
+	return i;
+}
+
+__attribute__ ((target("avx2")))
+static Uint32 	UtilityAabbCheckAvx2( const SDL_Rect* r1, const AabbBatch* batch, Uint32* hits )
+{
+	const __m256i left 		= _mm256_set1_epi32( r1->x );
+	const __m256i right 	= _mm256_set1_epi32( r1->x + r1->w );
+	const __m256i top 		= _mm256_set1_epi32( r1->y );
+	const __m256i bottom 	= _mm256_set1_epi32( r1->y + r1->h );
+
+	Uint32 i = 0;
+	for( ; i + 8 <= batch->count; i += 8 )
+	{
+		__m256i x = _mm256_loadu_si256( (const __m256i*)(batch->x + i) );
+		__m256i y = _mm256_loadu_si256( (const __m256i*)(batch->y + i) );
+		__m256i w = _mm256_loadu_si256( (const __m256i*)(batch->w + i) );
+		__m256i h = _mm256_loadu_si256( (const __m256i*)(batch->h + i) );
+
+		__m256i miss = _mm256_or_si256( _mm256_cmpgt_epi32( left, _mm256_add_epi32( x, w ) ),
+										_mm256_cmpgt_epi32( top, _mm256_add_epi32( y, h ) ) );
+		__m256i inside = _mm256_and_si256( _mm256_cmpgt_epi32( right, x ),
+										   _mm256_cmpgt_epi32( bottom, y ) );
+
+		Uint32 mask = (Uint32)_mm256_movemask_ps( _mm256_castsi256_ps( _mm256_andnot_si256( miss, inside ) ) );
+		hits[i >> 5] |= mask << (i & 31);
+	}
+
+	return i;
+}
+
+#endif // x86
+
+/*
+	Utility AABB Kernel Best
+
+	Purpose: Finds the fastest kernel this CPU can run.
+			Checked once, then remembered. Safe to call
+			from any thread: threads that check at the
+			same time all store the same answer.
+
+	Parameters: Nil
+
+	Return:	The kernel to use
+*/
+
+AabbKernel		UtilityAabbKernelBest()
+{
+	#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+	static SDL_atomic_t cached = { AABB_KERNEL_AUTO };
+
+	AabbKernel best = (AabbKernel)SDL_AtomicGet( &cached );
+	if ( best == AABB_KERNEL_AUTO )
+	{
+		__builtin_cpu_init();
+
+		if ( __builtin_cpu_supports("avx2") )
+			best = AABB_KERNEL_AVX2;
+		else if ( __builtin_cpu_supports("sse2") )
+			best = AABB_KERNEL_SSE2;
+		else
+			best = AABB_KERNEL_SCALAR;
+
+		SDL_AtomicSet( &cached, (int)best );
+	}
+
+	return best;
+	#else
+	return AABB_KERNEL_SCALAR;
+	#endif // x86
+}
+
+/*
+	Utility AABB Check Batch
+
+	Purpose: Checks one box against every box in a
+			batch, with the same edge rules as Utility
+			AABB Check.
+
+	Parameters: R1 - the box to check against
+				Batch - the boxes to check
+				Hits - receives one bit per box in the
+					batch, set if they collide. Must hold
+					AABB_HIT_WORDS(batch->count) words
+				Kernel - the kernel to use, falls back
+					to the best available if the CPU can't
+					run it
+
+	Return:	The number of boxes that collide
+*/
+
+Uint32			UtilityAabbCheckBatch( const SDL_Rect* r1, const AabbBatch* batch, Uint32* hits, AabbKernel kernel )
+{
+	Uint32 words = AABB_HIT_WORDS(batch->count);
+	for( Uint32 i = 0; i < words; i++ )
+		hits[i] = 0;
+
+	AabbKernel best = UtilityAabbKernelBest();
+	if ( kernel == AABB_KERNEL_AUTO || kernel > best )
+		kernel = best;
+
+	Uint32 done = 0;
+
+	#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+	if ( kernel == AABB_KERNEL_AVX2 )
+		done = UtilityAabbCheckAvx2( r1, batch, hits );
+	else if ( kernel == AABB_KERNEL_SSE2 )
+		done = UtilityAabbCheckSse2( r1, batch, hits );
+	#endif // x86
+
+	// Left over boxes
+	UtilityAabbCheckScalar( r1, batch, done, hits );
+
+	Uint32 count = 0;
+	for( Uint32 i = 0; i < words; i++ )
+		count += __builtin_popcount( hits[i] );
+
+	return count;
+}
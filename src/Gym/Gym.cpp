@@ -0,0 +1,669 @@
+/*************************************/
+/** Gym <source file>				**/
+/**									**/
+/** Steps many games at once, for	**/
+/** training agents against. Built	**/
+/** as a shared library by the Gym	**/
+/** target.							**/
+/*************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../Game/Game.h"
+#include "Gym.h"
+
+#define GYM_THREADS_MAX 64
+
+// Particles are only for show, so each game keeps a few
+#define GYM_PARTICLES 1024
+
+// Games a thread takes at a time, while stepping
+#define GYM_CHUNK 4
+
+struct GymEnv
+{
+	Game					game;
+	Uint64					seed = 0; 		// the current episode's
+	Uint32					steps = 0; 		// this episode
+	Uint32					score = 0; 		// at the last step
+	Sint16					hp = 0; 		// at the last step
+};
+
+struct GymWorker
+{
+	Gym*					gym = nullptr;
+	SDL_Thread*				thread = nullptr;
+};
+
+struct Gym
+{
+	GymEnv*					envs = nullptr;
+	Uint32					count = 0;
+	Uint32					frame_skip = GYM_FRAME_SKIP;
+	Uint32					max_steps = GYM_MAX_STEPS;
+
+	// The step or render being run, shared with the workers
+	void					(*job)( Gym*, Uint32 ) = nullptr;
+	const Uint8*			actions = nullptr;
+	float*					observations = nullptr;
+	float*					rewards = nullptr;
+	Uint8*					dones = nullptr;
+	Uint8*					pixels = nullptr;
+	SDL_atomic_t			next; 			// first game not yet taken
+
+	// Draws pixel observations, once Gym Set Pixels is called
+	SoftRenderer			soft;
+
+	// Threads besides the caller's, woken for each step
+	GymWorker				workers[GYM_THREADS_MAX];
+	Uint32					worker_count = 0;
+	SDL_sem*				start = nullptr;
+	SDL_sem*				finished = nullptr;
+	SDL_atomic_t			quit;
+};
+
+/*
+	Gym Seed Next
+
+	Purpose: Moves a seed on to the next in its sequence
+			(SplitMix64), for the next episode.
+
+	Parameters: Seed - the seed
+
+	Return:	The next seed
+*/
+
+static inline Uint64 	GymSeedNext( Uint64 seed )
+{
+	return seed + 0x9E3779B97F4A7C15ull;
+}
+
+/*
+	Gym Seed State
+
+	Purpose: Mixes a seed down to a random state for the
+			game. Xorshift can't start from 0.
+
+	Parameters: Seed - the seed
+
+	Return:	The random state
+*/
+
+static inline Uint32 	GymSeedState( Uint64 seed )
+{
+	Uint64 z = seed + 0x9E3779B97F4A7C15ull;
+	z = ( z ^ (z >> 30) ) * 0xBF58476D1CE4E5B9ull;
+	z = ( z ^ (z >> 27) ) * 0x94D049BB133111EBull;
+	z ^= z >> 31;
+
+	Uint32 state = (Uint32)( z ^ (z >> 32) );
+	return ( state != 0 ? state : 0x9E3779B9 );
+}
+
+/*
+	Gym Env Setup
+
+	Purpose: Sets up a game without a window, renderer
+			or loaded assets, ready to be reset.
+
+	Parameters: Env - the game to set up
+
+	Return:	True if its memory was allocated
+*/
+
+static bool 	GymEnvSetup( GymEnv* env )
+{
+	return GameSetupHeadless( &(env->game), GYM_PARTICLES );
+}
+
+/*
+	Gym Env Reset
+
+	Purpose: Starts a new episode. Everything the game
+			does from here on comes from the seed.
+
+	Parameters: Env - the game
+				Seed - the episode's seed
+
+	Return:	Nil
+*/
+
+static void 	GymEnvReset( GymEnv* env, Uint64 seed )
+{
+	Game* game = &(env->game);
+
+	game->random_state 		= GymSeedState( seed );
+	game->particles.seed 	= GymSeedState( ~seed );
+	TimerWheelInit( &(game->timers) );
+
+	game->playing = false;
+	GameStartPlay( game );
+
+	env->seed 	= seed;
+	env->steps 	= 0;
+	env->score 	= game->score;
+	env->hp 	= game->players[0].hp;
+}
+
+/*
+	Gym Nearest
+
+	Purpose: Writes the objects in a pool nearest to a
+			point into the observation, nearest first,
+			and clears the slots left over.
+
+	Parameters: Obs - where to write them
+				Slots - how many to write
+				Objects - the pool
+				Count - live objects in the pool
+				Centre - the point, the ship
+				Vel - the ship's velocity
+
+	Return:	Nil
+*/
+
+template< typename Object >
+static void 	GymNearest( float* obs, Uint32 slots, const Object* objects, Uint16 count,
+							const Vector2D& centre, const Vector2D& vel )
+{
+	float dists[GYM_OBS_BULLETS];
+	Uint16 nearest[GYM_OBS_BULLETS];
+	Uint32 found = 0;
+
+	// Insertion into a short sorted list, most are rejected by the last
+	for( Uint16 i = 0; i < count; i++ )
+	{
+		float dx = objects[i].pos.x - centre.x;
+		float dy = objects[i].pos.y - centre.y;
+		float dist = dx*dx + dy*dy;
+
+		if ( found == slots && dist >= dists[slots-1] )
+			continue;
+
+		Uint32 at = ( found < slots ? found++ : slots-1 );
+		for( ; at > 0 && dists[at-1] > dist; at-- )
+		{
+			dists[at] = dists[at-1];
+			nearest[at] = nearest[at-1];
+		}
+
+		dists[at] = dist;
+		nearest[at] = i;
+	}
+
+	for( Uint32 s = 0; s < slots; s++, obs += GYM_OBS_OBJECT )
+	{
+		if ( s >= found )
+		{
+			memset( obs, 0, GYM_OBS_OBJECT * sizeof(float) );
+			continue;
+		}
+
+		const Object* object = &(objects[nearest[s]]);
+
+		obs[0] = 1;
+		obs[1] = ( object->pos.x - centre.x ) / SCREEN_WIDTH;
+		obs[2] = ( object->pos.y - centre.y ) / SCREEN_HEIGHT;
+		obs[3] = ( object->vel.x - vel.x ) / SCREEN_WIDTH * FPS;
+		obs[4] = ( object->vel.y - vel.y ) / SCREEN_HEIGHT * FPS;
+	}
+}
+
+/*
+	Gym Observe
+
+	Purpose: Writes what the agent sees of a game, laid
+			out as in Gym.h.
+
+	Parameters: Game - the game
+				Obs - where to write GYM_OBS_SIZE floats
+
+	Return:	Nil
+*/
+
+static void 	GymObserve( Game* game, float* obs )
+{
+	const Player* player = &(game->players[0]);
+
+	obs[0] = player->pos.x / SCREEN_WIDTH;
+	obs[1] = player->pos.y / SCREEN_HEIGHT;
+	obs[2] = player->vel.x / player->move_max;
+	obs[3] = player->vel.y / player->move_max;
+	obs[4] = ( player->hp > 0 ? (float)player->hp / player->hp_max : 0.0f );
+	obs[5] = ( player->reloading ? 1.0f : 0.0f );
+	obs[6] = (float)game->enemy_count / POOLSIZE_ENEMY;
+	obs[7] = (float)game->proj_enemy_count / POOLSIZE_ENEMY_PROJ;
+
+	obs += GYM_OBS_SHIP;
+	GymNearest( obs, GYM_OBS_ENEMIES, game->enemies, game->enemy_count, player->pos, player->vel );
+
+	obs += GYM_OBS_ENEMIES * GYM_OBS_OBJECT;
+	GymNearest( obs, GYM_OBS_BULLETS, game->projectiles_enemy, game->proj_enemy_count, player->pos, player->vel );
+}
+
+/*
+	Gym Env Step
+
+	Purpose: Runs Frame Skip ticks of one game with the
+			action held, and writes the result. The
+			reward is points scored, less health lost.
+			An episode that ends is reset from the next
+			seed.
+
+	Parameters: Gym - the gym
+				Index - which game
+
+	Return:	Nil
+*/
+
+static void 	GymEnvStep( Gym* gym, Uint32 index )
+{
+	GymEnv* env = &(gym->envs[index]);
+	Game* game = &(env->game);
+	Player* player = &(game->players[0]);
+
+	Uint8 inputs[PLAYER_MAX] = { (Uint8)( gym->actions[index] & (GYM_ACTION_COUNT-1) ) };
+
+	for( Uint32 f = 0; f < gym->frame_skip && player->alive; f++ )
+	{
+		ArenaReset( &(game->frame_arena) );
+		GameTick( game, inputs, 1000 / FPS );
+	}
+
+	++env->steps;
+
+	Sint16 hp = ( player->hp > 0 ? player->hp : 0 );
+	gym->rewards[index] = (float)game->score - (float)env->score - (float)( env->hp - hp );
+
+	Uint8 done = 0;
+	if ( !player->alive )
+		done |= GYM_DONE_TERMINATED;
+	else if ( env->steps >= gym->max_steps )
+		done |= GYM_DONE_TRUNCATED;
+
+	gym->dones[index] = done;
+
+	env->score 	= game->score;
+	env->hp 	= hp;
+
+	if ( done != 0 )
+		GymEnvReset( env, GymSeedNext( env->seed ) );
+
+	GymObserve( game, gym->observations + index * GYM_OBS_SIZE );
+}
+
+/*
+	Gym Work
+
+	Purpose: Runs the job on games, a chunk at a time,
+			until every game has been taken. Run by the
+			caller's thread and every worker at once.
+
+	Parameters: Gym - the gym
+
+	Return:	Nil
+*/
+
+static void 	GymWork( Gym* gym )
+{
+	for( ;; )
+	{
+		Uint32 first = (Uint32)SDL_AtomicAdd( &(gym->next), GYM_CHUNK );
+		if ( first >= gym->count )
+			break;
+
+		Uint32 last = ( first + GYM_CHUNK < gym->count ? first + GYM_CHUNK : gym->count );
+		for( Uint32 i = first; i < last; i++ )
+			gym->job( gym, i );
+	}
+}
+
+/*
+	Gym Run
+
+	Purpose: Runs a job on every game, spread across the
+			threads, and returns when all are done.
+
+	Parameters: Gym - the gym
+				Job - what to do to each game
+
+	Return:	Nil
+*/
+
+static void 	GymRun( Gym* gym, void (*job)( Gym*, Uint32 ) )
+{
+	gym->job = job;
+	SDL_AtomicSet( &(gym->next), 0 );
+
+	// The semaphores order the writes before the workers' reads
+	for( Uint32 w = 0; w < gym->worker_count; w++ )
+		SDL_SemPost( gym->start );
+
+	GymWork( gym );
+
+	for( Uint32 w = 0; w < gym->worker_count; w++ )
+		SDL_SemWait( gym->finished );
+}
+
+/*
+	Gym Worker Run
+
+	Purpose: <Thread Function>
+			 Waits for each step, and helps run it.
+
+	Parameters: Data - the GymWorker
+
+	Return:	0
+*/
+
+static int 		GymWorkerRun( void* data )
+{
+	Gym* gym = ((GymWorker*)data)->gym;
+
+	for( ;; )
+	{
+		SDL_SemWait( gym->start );
+		if ( SDL_AtomicGet( &(gym->quit) ) )
+			break;
+
+		GymWork( gym );
+		SDL_SemPost( gym->finished );
+	}
+
+	return 0;
+}
+
+/*
+	Gym Version
+
+	Purpose: Gets the version of the interface the
+			library was built with.
+
+	Parameters: Nil
+
+	Return:	GYM_VERSION
+*/
+
+uint32_t 		GymVersion( void )
+{
+	return GYM_VERSION;
+}
+
+/*
+	Gym Create
+
+	Purpose: Sets up Count games, and the threads to
+			step them with. Everything a step needs is
+			allocated here. The games need GymReset
+			before the first step.
+
+	Parameters: Count - how many games
+				Threads - threads to step them on,
+					including the caller's, 0 for one
+					per core
+				Frame Skip - ticks per step, 0 for
+					GYM_FRAME_SKIP
+				Max Steps - steps before an episode is
+					cut short, 0 for GYM_MAX_STEPS
+
+	Return:	The gym, or null if it couldn't be set up
+*/
+
+Gym* 			GymCreate( uint32_t count, uint32_t threads, uint32_t frame_skip, uint32_t max_steps )
+{
+	if ( count == 0 )
+	{
+		printf( "Error: A gym needs at least one game\n" );
+		return nullptr;
+	}
+
+	Gym* gym = new Gym;
+	gym->count 		= count;
+	gym->frame_skip = ( frame_skip > 0 ? frame_skip : GYM_FRAME_SKIP );
+	gym->max_steps 	= ( max_steps > 0 ? max_steps : GYM_MAX_STEPS );
+	gym->envs 		= new GymEnv[count];
+
+	SDL_AtomicSet( &(gym->next), 0 );
+	SDL_AtomicSet( &(gym->quit), 0 );
+
+	for( Uint32 i = 0; i < count; i++ )
+	{
+		if ( !GymEnvSetup( &(gym->envs[i]) ) )
+		{
+			printf( "Error: Unable to set up game %u of the gym\n", i );
+			GymDestroy( gym );
+			return nullptr;
+		}
+	}
+
+	// Threads
+	if ( threads == 0 )
+		threads = (Uint32)SDL_GetCPUCount();
+	if ( threads > count )
+		threads = count;
+	if ( threads > GYM_THREADS_MAX )
+		threads = GYM_THREADS_MAX;
+
+	gym->start 		= SDL_CreateSemaphore( 0 );
+	gym->finished 	= SDL_CreateSemaphore( 0 );
+
+	if ( gym->start == nullptr || gym->finished == nullptr )
+	{
+		printf( "Error: Unable to create the gym's semaphores. SDL Error: %s\n", SDL_GetError() );
+		GymDestroy( gym );
+		return nullptr;
+	}
+
+	for( Uint32 w = 0; w + 1 < threads; w++ )
+	{
+		GymWorker* worker = &(gym->workers[w]);
+		worker->gym = gym;
+		worker->thread = SDL_CreateThread( GymWorkerRun, "Gym", worker );
+
+		if ( worker->thread == nullptr )
+		{
+			printf( "Error: Unable to start gym thread %u. SDL Error: %s\n", w, SDL_GetError() );
+			break;
+		}
+
+		++gym->worker_count;
+	}
+
+	printf( "Gym: %u games on %u threads, %u ticks a step\n", count, gym->worker_count + 1, gym->frame_skip );
+	return gym;
+}
+
+/*
+	Gym Destroy
+
+	Purpose: Stops the threads, and frees the games.
+
+	Parameters: Gym - the gym, may be null
+
+	Return:	Nil
+*/
+
+void 			GymDestroy( Gym* gym )
+{
+	if ( gym == nullptr )
+		return;
+
+	SDL_AtomicSet( &(gym->quit), 1 );
+
+	for( Uint32 w = 0; w < gym->worker_count; w++ )
+		SDL_SemPost( gym->start );
+
+	for( Uint32 w = 0; w < gym->worker_count; w++ )
+		SDL_WaitThread( gym->workers[w].thread, nullptr );
+
+	if ( gym->start != nullptr )
+		SDL_DestroySemaphore( gym->start );
+	if ( gym->finished != nullptr )
+		SDL_DestroySemaphore( gym->finished );
+
+	for( Uint32 i = 0; i < gym->count; i++ )
+	{
+		Game* game = &(gym->envs[i].game);
+
+		ArenaFree( &(game->frame_arena) );
+		ParticleSystemFree( &(game->particles) );
+		RewindFree( &(game->rewind) );
+
+		for( Uint16 t = 0; t < TEXTURE_COUNT; t++ )
+			TextureFree( &(game->texture_assets[t]) );
+	}
+
+	SoftRenderFree( &(gym->soft) );
+
+	delete [] gym->envs;
+	delete gym;
+}
+
+/*
+	Gym Count
+
+	Purpose: Gets how many games a gym steps.
+
+	Parameters: Gym - the gym
+
+	Return:	The number of games
+*/
+
+uint32_t 		GymCount( const Gym* gym )
+{
+	return ( gym != nullptr ? gym->count : 0 );
+}
+
+/*
+	Gym Reset
+
+	Purpose: Starts a new episode in every game, and
+			writes their first observations.
+
+	Parameters: Gym - the gym
+				Seeds - a seed for each game, or null to
+					seed them 0 to Count-1
+				Observations - Count * GYM_OBS_SIZE floats
+
+	Return:	0, or -1 if a buffer is missing
+*/
+
+int 			GymReset( Gym* gym, const uint64_t* seeds, float* observations )
+{
+	if ( gym == nullptr || observations == nullptr )
+		return -1;
+
+	for( Uint32 i = 0; i < gym->count; i++ )
+	{
+		GymEnvReset( &(gym->envs[i]), ( seeds != nullptr ? seeds[i] : i ) );
+		GymObserve( &(gym->envs[i].game), observations + i * GYM_OBS_SIZE );
+	}
+
+	return 0;
+}
+
+/*
+	Gym Step
+
+	Purpose: Runs one step of every game, spread across
+			the threads, and returns when all are done.
+			Nothing is allocated.
+
+	Parameters: Gym - the gym
+				Actions - Count GYM_ACTION masks
+				Observations - Count * GYM_OBS_SIZE floats
+				Rewards - Count floats
+				Dones - Count GYM_DONE masks, 0 while
+					the episode goes on
+
+	Return:	0, or -1 if a buffer is missing
+*/
+
+int 			GymStep( Gym* gym, const uint8_t* actions, float* observations, float* rewards, uint8_t* dones )
+{
+	if ( gym == nullptr || actions == nullptr || observations == nullptr || rewards == nullptr || dones == nullptr )
+		return -1;
+
+	gym->actions 		= actions;
+	gym->observations 	= observations;
+	gym->rewards 		= rewards;
+	gym->dones 			= dones;
+
+	GymRun( gym, GymEnvStep );
+
+	return 0;
+}
+
+/*
+	Gym Set Pixels
+
+	Purpose: Sets the size and colours Gym Render draws
+			at, and loads the images to draw with.
+
+	Parameters: Gym - the gym
+				Width - up to SCREEN_WIDTH
+				Height - up to SCREEN_HEIGHT
+				Channels - GYM_PIXELS_GRAY or
+					GYM_PIXELS_RGB
+
+	Return:	0, or -1 if it can't draw at that size, or
+			the images couldn't be loaded
+*/
+
+int 			GymSetPixels( Gym* gym, uint32_t width, uint32_t height, uint32_t channels )
+{
+	if ( gym == nullptr || width > 0xFFFF || height > 0xFFFF
+		 || ( channels != GYM_PIXELS_GRAY && channels != GYM_PIXELS_RGB ) )
+		return -1;
+
+	SoftRenderFormat format = ( channels == GYM_PIXELS_GRAY ? SOFT_RENDER_GRAY : SOFT_RENDER_RGB );
+
+	if ( !SoftRenderInit( &(gym->envs[0].game), &(gym->soft), (Uint16)width, (Uint16)height, format ) )
+		return -1;
+
+	return 0;
+}
+
+/*
+	Gym Env Render
+
+	Purpose: Draws one game into its slot of the pixels
+
+	Parameters: Gym - the gym
+				Index - which game
+
+	Return:	Nil
+*/
+
+static void 	GymEnvRender( Gym* gym, Uint32 index )
+{
+	SoftRenderGame( &(gym->envs[index].game), &(gym->soft),
+					gym->pixels + index * SoftRenderFrameSize( &(gym->soft) ), 0 );
+}
+
+/*
+	Gym Render
+
+	Purpose: Draws every game as it is now, spread across
+			the threads. Nothing is allocated.
+
+	Parameters: Gym - the gym
+				Pixels - Count frames of the size set by
+					Gym Set Pixels
+
+	Return:	0, or -1 if the buffer is missing or Gym
+			Set Pixels hasn't been called
+*/
+
+int 			GymRender( Gym* gym, uint8_t* pixels )
+{
+	if ( gym == nullptr || pixels == nullptr || gym->soft.pixels == nullptr )
+		return -1;
+
+	gym->pixels = pixels;
+
+	GymRun( gym, GymEnvRender );
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+#ifndef GYM_H
+#define GYM_H
+
+/*
+	The training library's interface. Plain C, so it can be
+	loaded from anything with a C FFI (ctypes, cffi, Lua,
+	...), and kept stable: calls and layouts are only ever
+	added to, and GYM_VERSION goes up when they are.
+
+	A Gym holds Count games, stepped together. Every buffer
+	is owned by the caller, and holds one entry per game,
+	game after game. Each step runs Frame Skip ticks with
+	the same buttons held.
+
+	Games can also be drawn, as pixels, by the software
+	renderer. Set the size once with Gym Set Pixels, then
+	Gym Render draws every game as it is after the last
+	reset or step.
+
+	An episode ends when the agent's ship is destroyed, or
+	after Max Steps. That game is reset straight away from
+	the next seed in its own sequence, so its observation is
+	the first of the new episode, and its done flag says why
+	the last one ended.
+*/
+
+//////////////////////////////////////////////////////
+// Includes											//
+//////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+//////////////////////////////////////////////////////
+// Defines											//
+//////////////////////////////////////////////////////
+
+#define GYM_VERSION 2
+
+#if defined(_WIN32) && defined(GYM_BUILD)
+#define GYM_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define GYM_API __declspec(dllimport)
+#else
+#define GYM_API __attribute__((visibility("default")))
+#endif
+
+// Observations are GYM_OBS_SIZE floats per game: the ship,
+// then the nearest enemies and enemy bullets, nearest first
+#define GYM_OBS_SHIP 8
+#define GYM_OBS_ENEMIES 8
+#define GYM_OBS_BULLETS 16
+#define GYM_OBS_OBJECT 5
+#define GYM_OBS_SIZE (GYM_OBS_SHIP + (GYM_OBS_ENEMIES + GYM_OBS_BULLETS) * GYM_OBS_OBJECT)
+
+// Actions are any mix of these, so GYM_ACTION_COUNT of them
+#define GYM_ACTION_UP 		0x01
+#define GYM_ACTION_DOWN 	0x02
+#define GYM_ACTION_LEFT 	0x04
+#define GYM_ACTION_RIGHT 	0x08
+#define GYM_ACTION_SHOOT 	0x10
+#define GYM_ACTION_COUNT 	32
+
+// Why an episode ended
+#define GYM_DONE_TERMINATED 0x01 	// the ship was destroyed
+#define GYM_DONE_TRUNCATED 	0x02 	// it ran for Max Steps
+
+// Pixel observations are Width * Height * Channels bytes per
+// game, rows top to bottom, red first for RGB
+#define GYM_PIXELS_GRAY 1
+#define GYM_PIXELS_RGB 	3
+
+#define GYM_FRAME_SKIP 4
+#define GYM_MAX_STEPS (5*60*60/GYM_FRAME_SKIP)
+
+//////////////////////////////////////////////////////
+// Functions										//
+//////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+typedef struct Gym Gym;
+
+/*
+	Observation layout, per game. Positions are fractions
+	of the screen, and relative to the ship for objects.
+
+	Ship:		x, y, velocity x, velocity y, health,
+				reloading, enemies alive, bullets alive
+	Objects:	present, x, y, velocity x, velocity y
+*/
+
+GYM_API uint32_t 	GymVersion( void );
+
+GYM_API Gym* 		GymCreate( uint32_t count, uint32_t threads, uint32_t frame_skip, uint32_t max_steps );
+GYM_API void 		GymDestroy( Gym* gym );
+GYM_API uint32_t 	GymCount( const Gym* gym );
+
+GYM_API int 		GymReset( Gym* gym, const uint64_t* seeds, float* observations );
+GYM_API int 		GymStep( Gym* gym, const uint8_t* actions, float* observations, float* rewards, uint8_t* dones );
+
+GYM_API int 		GymSetPixels( Gym* gym, uint32_t width, uint32_t height, uint32_t channels );
+GYM_API int 		GymRender( Gym* gym, uint8_t* pixels );
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // GYM_H
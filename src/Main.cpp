@@ -1,3 +1,6 @@
+#include <stdlib.h>
+#include <string.h>
+
 #include "Game/Game.h"
 
 int main( int argc, char** argv )
@@ -20,8 +23,54 @@ int main( int argc, char** argv )
 	// Do Initial Setup of game, after resources are loaded
 	GameSetup(&game);
 
-	// Enter Main Game Loop
-	GameLoop(&game);
+	// Count Heap Use from here on (Instrumented Builds Only)
+	AllocTrackBegin();
+
+	int result = 0;
+
+	#ifdef ALLOC_TRACKING
+	// Run the Steady-State Allocation Test instead of playing
+	if ( argc > 1 && strcmp( argv[1], "--alloc-test" ) == 0 )
+	{
+		if ( !GameAllocTest( &game, FPS*2, FPS*10 ) )
+			result = -3;
+	}
+	else
+	#endif // ALLOC_TRACKING
+
+	// Play a Replay back without drawing, checking it comes out the same
+	if ( argc > 2 && strcmp( argv[1], "--verify-replay" ) == 0 )
+	{
+		if ( !ReplayVerify( &game, argv[2] ) )
+			result = -4;
+	}
+	else
+	{
+		// Record a Replay of this session
+		if ( argc > 2 && strcmp( argv[1], "--record-replay" ) == 0 )
+			ReplayRecordStart( &game, argv[2] );
+
+		// Play against another machine: --net <player> <local port> <remote ip> <remote port>
+		if ( argc > 5 && strcmp( argv[1], "--net" ) == 0 )
+			RollbackStart( &game, (Uint16)atoi( argv[2] ), (Uint16)atoi( argv[3] ), argv[4], (Uint16)atoi( argv[5] ) );
+
+		// Capture a frame a time step: --capture <file.y4m, file.rgb or - for stdout> [soft]
+		if ( argc > 2 && strcmp( argv[1], "--capture" ) == 0 )
+		{
+			const char* extension = strrchr( argv[2], '.' );
+			CaptureFormat format = ( extension != nullptr && strcmp( extension, ".rgb" ) == 0 ? CAPTURE_RAW_RGB : CAPTURE_Y4M );
+			CaptureSource source = ( argc > 3 && strcmp( argv[3], "soft" ) == 0 ? CAPTURE_SOURCE_SOFT : CAPTURE_SOURCE_RENDERER );
+
+			CaptureStart( &game, argv[2], format, source );
+		}
+
+		// Enter Main Game Loop
+		GameLoop(&game);
+
+		CaptureStop(&game);
+		RollbackStop(&game);
+		ReplayRecordStop(&game);
+	}
 
 	// Unload Game Assets
 	GameFreeAssets(&game);
@@ -29,6 +78,6 @@ int main( int argc, char** argv )
     // Unload Game Data when Exiting
     GameQuit(&game);
 
-    // Return Success
-    return 0;
+    // Return Success (or Test Result)
+    return result;
 }
@@ -0,0 +1,1300 @@
+/*************************************/
+/** Server <source file>			**/
+/**									**/
+/** Hosts many matches at once,		**/
+/** without a window. Built by the	**/
+/** Server target.					**/
+/*************************************/
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../Game/Game.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif // _WIN32
+
+#define SERVER_MATCHES_MAX 1024
+#define SERVER_WORKERS_MAX 64
+#define SERVER_PLAYERS 2
+#define SERVER_PORT 28000
+#define SERVER_BUDGET_US 250
+#define SERVER_SECONDS 60
+#define SERVER_REPORT_SECONDS 5
+
+// Share of each worker's tick that matches are scheduled into,
+// the rest is left for the network and for matches going over
+#define SERVER_WORKER_LOAD 80
+
+// Ticks a worker may fall behind before it gives up on them
+#define SERVER_CATCHUP_TICKS 4
+
+// Tick latency histogram, four buckets per power of two of us
+#define SERVER_LATENCY_BUCKETS 128
+
+#define SERVER_PACKET_MAX 128
+#define SERVER_CLIENT_HISTORY 64
+
+// "JI" and "JS", mark input and state packets
+#define SERVER_INPUT_MAGIC 0x494A
+#define SERVER_STATE_MAGIC 0x534A
+
+/*
+	Clients send their input every tick, numbered from 0:
+	magic u16, match u16, player u8, frame u32, input u8,
+	then the newest state tick they have u32. A player's
+	seat goes to the last address that sent input for it.
+
+	After every tick the server sends each seated player
+	the state: magic u16, match u16, input frames received
+	from that player u32, then the net state, encoded
+	against the newest state the player has. Both ends are
+	assumed to be little endian.
+*/
+
+static const Uint32 server_input_size = 2 + 2 + 1 + 4 + 1 + 4;
+static const Uint32 server_state_header_size = 2 + 2 + 4;
+
+// Counted by each worker, and published for the report
+struct ServerStats
+{
+	Uint64					match_ticks = 0;
+	Uint64					frames = 0;
+	Uint64					cost_us = 0; 			// spent running match ticks
+	Uint32					cost_max_us = 0;
+	Uint32					over_budget = 0; 		// match ticks that cost more than their budget
+	Uint32					late_frames = 0; 		// ticks skipped to catch up
+	Uint32					packets_in = 0;
+	Uint32					packets_out = 0;
+	Uint64					bytes_out = 0;
+	Uint32					latency[SERVER_LATENCY_BUCKETS] = {};
+	Uint32					latency_max_us = 0;
+};
+
+struct ServerMatch
+{
+	Game					game;
+	Uint16					id = 0;
+	Uint16					port = 0;
+	int						socket = -1;
+	Uint32					budget_us = SERVER_BUDGET_US;
+	Uint16					worker = 0;
+
+	// Seats, network byte order
+	Uint32					client_ip[SERVER_PLAYERS] = {};
+	Uint16					client_port[SERVER_PLAYERS] = {};
+	bool					seated[SERVER_PLAYERS] = {};
+
+	Uint8					inputs[SERVER_PLAYERS] = {};
+	Uint32					input_frames[SERVER_PLAYERS] = {}; // frames received, from the start
+
+	// States sent, and the newest each seat has
+	NetStateHistory*		history = nullptr;
+	Uint32					state_tick = 0;
+	Uint32					state_acked[SERVER_PLAYERS] = { NET_TICK_NONE, NET_TICK_NONE };
+};
+
+struct Server;
+
+struct ServerWorker
+{
+	Server*					server = nullptr;
+	SDL_Thread*				thread = nullptr;
+	Uint16					index = 0;
+	Uint16					core = 0;
+
+	ServerMatch*			matches[SERVER_MATCHES_MAX];
+	Uint16					match_count = 0;
+	Uint32					load_us = 0; 			// sum of its matches' budgets
+
+	ServerStats				stats;
+	ServerStats				published;
+	SDL_SpinLock			published_lock = 0;
+};
+
+struct ServerClients
+{
+	SDL_Thread*				thread = nullptr;
+
+	int						sockets[SERVER_MATCHES_MAX][SERVER_PLAYERS];
+	Uint32					acked[SERVER_MATCHES_MAX][SERVER_PLAYERS];
+	Uint32					state_ticks[SERVER_MATCHES_MAX][SERVER_PLAYERS];
+	Uint64					sent_us[SERVER_MATCHES_MAX][SERVER_CLIENT_HISTORY];
+	Uint32					frame = 0;
+
+	// Stats
+	Uint32					states = 0;
+	Uint64					state_bytes = 0;
+	Uint64					round_trip_us = 0;
+	Uint32					round_trips = 0;
+	Uint32					round_trip_max_us = 0;
+};
+
+struct Server
+{
+	Uint16					match_count = 0;
+	Uint16					worker_count = 0;
+	Uint16					port = SERVER_PORT;
+	Uint32					budget_us = SERVER_BUDGET_US;
+	Uint32					seconds = SERVER_SECONDS;
+
+	ServerMatch*			matches = nullptr;
+	ServerWorker*			workers = nullptr;
+	ServerClients*			clients = nullptr;
+
+	SDL_atomic_t			running;
+};
+
+static volatile sig_atomic_t 	server_interrupted = 0;
+
+/*
+	Server Now
+
+	Purpose: Reads the high resolution timer.
+
+	Parameters: Nil
+
+	Return:	The current time, in us
+*/
+
+static Uint64 	ServerNow()
+{
+	Uint64 counter = SDL_GetPerformanceCounter();
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+
+	return ( counter / frequency ) * 1000000 + ( counter % frequency ) * 1000000 / frequency;
+}
+
+/*
+	Server Wait Until
+
+	Purpose: Sleeps until a time, in steps of a ms, then
+			yields for whatever is left.
+
+	Parameters: Time - the time to wake, in us
+
+	Return:	Nil
+*/
+
+static void 	ServerWaitUntil( Uint64 time )
+{
+	for( Uint64 now = ServerNow(); now < time; now = ServerNow() )
+		SDL_Delay( (Uint32)( ( time - now ) / 1000 ) );
+}
+
+/*
+	Server Signal
+
+	Purpose: Stops the server on Ctrl-C.
+
+	Parameters: Signal - the signal caught
+
+	Return:	Nil
+*/
+
+static void 	ServerSignal( int signal )
+{
+	server_interrupted = 1;
+}
+
+/*
+	Server Latency Bucket
+
+	Purpose: Finds the histogram bucket for a latency.
+			Each power of two is split in four, so the
+			error is a quarter at most.
+
+	Parameters: Us - the latency, in us
+
+	Return:	The bucket
+*/
+
+static inline Uint32 	ServerLatencyBucket( Uint32 us )
+{
+	if ( us < 4 )
+		return us;
+
+	Uint32 bits = 31 - __builtin_clz( us );
+	Uint32 bucket = 4 * (bits - 1) + ( (us >> (bits - 2)) & 3 );
+
+	return ( bucket < SERVER_LATENCY_BUCKETS ? bucket : SERVER_LATENCY_BUCKETS - 1 );
+}
+
+/*
+	Server Latency Percentile
+
+	Purpose: Reads a percentile out of a latency
+			histogram.
+
+	Parameters: Latency - the histogram
+				Percent - the percentile
+
+	Return:	The top of the bucket it falls in, in us
+*/
+
+static Uint32 	ServerLatencyPercentile( const Uint32* latency, Uint32 percent )
+{
+	Uint64 total = 0;
+	for( Uint32 b = 0; b < SERVER_LATENCY_BUCKETS; b++ )
+		total += latency[b];
+
+	Uint64 target = ( total * percent + 99 ) / 100;
+	Uint64 seen = 0;
+
+	for( Uint32 b = 0; b < SERVER_LATENCY_BUCKETS; b++ )
+	{
+		seen += latency[b];
+		if ( seen < target || seen == 0 )
+			continue;
+
+		if ( b < 3 )
+			return b + 1;
+
+		// Start of the next bucket
+		Uint32 bits = (b + 1) / 4 + 1;
+		return ( 4 + (b + 1) % 4 ) << (bits - 2);
+	}
+
+	return 0;
+}
+
+/*
+	Server Put
+
+	Purpose: Writes a value into a packet, and moves on
+			past it.
+
+	Parameters: At - the place in the packet
+				Value - the value
+				Size - the size of the value
+
+	Return:	Nil
+*/
+
+static inline void 	ServerPut( Uint8*& at, const void* value, Uint32 size )
+{
+	memcpy( at, value, size );
+	at += size;
+}
+
+/*
+	Server Get
+
+	Purpose: Reads a value out of a packet, and moves on
+			past it.
+
+	Parameters: At - the place in the packet
+				Value - where to put the value
+				Size - the size of the value
+
+	Return:	Nil
+*/
+
+static inline void 	ServerGet( const Uint8*& at, void* value, Uint32 size )
+{
+	memcpy( value, at, size );
+	at += size;
+}
+
+#if defined(_WIN32) || defined(__linux__)
+
+/*
+	Server Socket Close
+
+	Purpose: Closes a socket. On Windows, each socket
+			holds Winsock open, so this lets go of it.
+
+	Parameters: Socket - the socket
+
+	Return:	Nil
+*/
+
+static void 	ServerSocketClose( int socket )
+{
+	#ifdef _WIN32
+	closesocket( (SOCKET)socket );
+	WSACleanup();
+	#else
+	close( socket );
+	#endif // _WIN32
+}
+
+/*
+	Server Socket Open
+
+	Purpose: Opens a non-blocking UDP socket. On Windows,
+			Winsock is started for each socket, as it
+			counts how many times it was started.
+
+	Parameters: Port - the local port, or 0 for any
+
+	Return:	The socket, or -1 if it couldn't be opened
+*/
+
+static int 		ServerSocketOpen( Uint16 port )
+{
+	#ifdef _WIN32
+	WSADATA wsa;
+	if ( WSAStartup( MAKEWORD( 2, 2 ), &wsa ) != 0 )
+		return -1;
+
+	SOCKET handle = socket( AF_INET, SOCK_DGRAM, 0 );
+	if ( handle == INVALID_SOCKET )
+	{
+		WSACleanup();
+		return -1;
+	}
+
+	// Socket handles are small, and fit the int the matches keep
+	int fd = (int)handle;
+	#else
+	int fd = socket( AF_INET, SOCK_DGRAM, 0 );
+	if ( fd < 0 )
+		return -1;
+	#endif // _WIN32
+
+	sockaddr_in addr;
+	memset( &addr, 0, sizeof(addr) );
+	addr.sin_family 		= AF_INET;
+	addr.sin_addr.s_addr 	= htonl( INADDR_ANY );
+	addr.sin_port 			= htons( port );
+
+	#ifdef _WIN32
+	u_long non_blocking = 1;
+	bool opened = ( bind( handle, (sockaddr*)&addr, sizeof(addr) ) == 0 &&
+					ioctlsocket( handle, FIONBIO, &non_blocking ) == 0 );
+	#else
+	bool opened = ( bind( fd, (sockaddr*)&addr, sizeof(addr) ) == 0 &&
+					fcntl( fd, F_SETFL, fcntl( fd, F_GETFL, 0 ) | O_NONBLOCK ) >= 0 );
+	#endif // _WIN32
+
+	if ( !opened )
+	{
+		ServerSocketClose( fd );
+		return -1;
+	}
+
+	return fd;
+}
+
+/*
+	Server Socket Send
+
+	Purpose: Sends a packet.
+
+	Parameters: Socket - the socket to send from
+				IP - the address, network byte order
+				Port - the port, network byte order
+				Data - the packet
+				Size - the packet's size
+
+	Return:	Nil
+*/
+
+static void 	ServerSocketSend( int socket, Uint32 ip, Uint16 port, const Uint8* data, Uint32 size )
+{
+	sockaddr_in addr;
+	memset( &addr, 0, sizeof(addr) );
+	addr.sin_family 		= AF_INET;
+	addr.sin_addr.s_addr 	= ip;
+	addr.sin_port 			= port;
+
+	sendto( socket, (const char*)data, size, 0, (sockaddr*)&addr, sizeof(addr) );
+}
+
+/*
+	Server Socket Receive
+
+	Purpose: Takes the next packet waiting, without
+			waiting for one.
+
+	Parameters: Socket - the socket
+				Data - where to put the packet
+				Capacity - the size of Data
+				IP - receives the sender's address
+				Port - receives the sender's port
+
+	Return:	The packet's size, or 0 if none are waiting
+*/
+
+static Uint32 	ServerSocketReceive( int socket, Uint8* data, Uint32 capacity, Uint32* ip, Uint16* port )
+{
+	sockaddr_in from;
+	socklen_t from_size = sizeof(from);
+
+	int size = (int)recvfrom( socket, (char*)data, capacity, 0, (sockaddr*)&from, &from_size );
+	if ( size <= 0 )
+		return 0;
+
+	*ip 	= from.sin_addr.s_addr;
+	*port 	= from.sin_port;
+	return (Uint32)size;
+}
+
+/*
+	Server Pin Thread
+
+	Purpose: Keeps the calling thread on one core.
+
+	Parameters: Core - the core
+
+	Return:	Nil
+*/
+
+static void 	ServerPinThread( Uint16 core )
+{
+	#ifdef _WIN32
+	SetThreadAffinityMask( GetCurrentThread(), (DWORD_PTR)1 << core );
+	#else
+	cpu_set_t set;
+	CPU_ZERO( &set );
+	CPU_SET( core, &set );
+
+	pthread_setaffinity_np( pthread_self(), sizeof(set), &set );
+	#endif // _WIN32
+}
+
+/*
+	Server Loopback
+
+	Purpose: Gets the loopback address, for the
+			synthetic clients.
+
+	Parameters: Nil
+
+	Return:	127.0.0.1, network byte order
+*/
+
+static Uint32 	ServerLoopback()
+{
+	return htonl( INADDR_LOOPBACK );
+}
+
+#else
+
+/*
+	UDP is only set up on Linux and Windows for now, like
+	rollback, so on other platforms no match can open its
+	port.
+*/
+
+static int 		ServerSocketOpen( Uint16 port ) { return -1; }
+static void 	ServerSocketSend( int socket, Uint32 ip, Uint16 port, const Uint8* data, Uint32 size ) {}
+static Uint32 	ServerSocketReceive( int socket, Uint8* data, Uint32 capacity, Uint32* ip, Uint16* port ) { return 0; }
+static void 	ServerSocketClose( int socket ) {}
+static void 	ServerPinThread( Uint16 core ) {}
+static Uint32 	ServerLoopback() { return 0; }
+
+#endif // _WIN32 || __linux__
+
+/*
+	Server Port Order
+
+	Purpose: Swaps a port into network byte order.
+
+	Parameters: Port - the port
+
+	Return:	The port, network byte order
+*/
+
+static inline Uint16 	ServerPortOrder( Uint16 port )
+{
+	return SDL_SwapBE16( port );
+}
+
+/*
+	Server Match Setup
+
+	Purpose: Sets up a match's game without a window,
+			renderer or loaded assets, and opens its
+			port.
+
+	Parameters: Match - the match
+				Id - its index
+				Port - its UDP port
+
+	Return:	True if its memory was allocated and the
+			port was opened
+*/
+
+static bool 	ServerMatchSetup( ServerMatch* match, Uint16 id, Uint16 port )
+{
+	Game* game = &(match->game);
+
+	if ( !GameSetupHeadless( game, PARTICLE_CAPACITY ) )
+	{
+		printf( "Error: No frame memory for match %u\n", id );
+		return false;
+	}
+
+	// Seeded from the clock at startup, but clients should agree on it
+	game->random_state = 0x2F6B1A3D + id;
+
+	match->id 		= id;
+	match->port 	= port;
+	match->history 	= new NetStateHistory;
+
+	match->socket = ServerSocketOpen( port );
+	if ( match->socket < 0 )
+	{
+		printf( "Error: Unable to open UDP port %u for match %u\n", port, id );
+		return false;
+	}
+
+	return true;
+}
+
+/*
+	Server Match Free
+
+	Purpose: Closes a match's port and frees its game.
+
+	Parameters: Match - the match
+
+	Return:	Nil
+*/
+
+static void 	ServerMatchFree( ServerMatch* match )
+{
+	if ( match->socket >= 0 )
+		ServerSocketClose( match->socket );
+	match->socket = -1;
+
+	ArenaFree( &(match->game.frame_arena) );
+	ParticleSystemFree( &(match->game.particles) );
+
+	delete match->history;
+	match->history = nullptr;
+}
+
+/*
+	Server Match Receive
+
+	Purpose: Takes in every input waiting for a match.
+			Inputs older than one already had are
+			dropped.
+
+	Parameters: Match - the match
+				Stats - the worker's stats
+
+	Return:	Nil
+*/
+
+static void 	ServerMatchReceive( ServerMatch* match, ServerStats* stats )
+{
+	Uint8 packet[SERVER_PACKET_MAX];
+	Uint32 ip;
+	Uint16 port;
+
+	for( ;; )
+	{
+		Uint32 size = ServerSocketReceive( match->socket, packet, sizeof(packet), &ip, &port );
+		if ( size == 0 )
+			break;
+
+		++stats->packets_in;
+
+		if ( size != server_input_size )
+			continue;
+
+		const Uint8* at = packet;
+		Uint16 magic, id;
+		Uint8 player, input;
+		Uint32 frame, state_tick;
+
+		ServerGet( at, &magic, 2 );
+		ServerGet( at, &id, 2 );
+		ServerGet( at, &player, 1 );
+		ServerGet( at, &frame, 4 );
+		ServerGet( at, &input, 1 );
+		ServerGet( at, &state_tick, 4 );
+
+		if ( magic != SERVER_INPUT_MAGIC || id != match->id || player >= SERVER_PLAYERS )
+			continue;
+
+		match->client_ip[player] 	= ip;
+		match->client_port[player] 	= port;
+		match->seated[player] 		= true;
+
+		if ( state_tick != NET_TICK_NONE &&
+			 ( match->state_acked[player] == NET_TICK_NONE || state_tick > match->state_acked[player] ) )
+			match->state_acked[player] = state_tick;
+
+		if ( frame < match->input_frames[player] )
+			continue;
+
+		match->inputs[player] 		= input;
+		match->input_frames[player] = frame + 1;
+	}
+}
+
+/*
+	Server Match Broadcast
+
+	Purpose: Sends the state after a tick to every
+			seated player, as changes from the newest
+			state they have. Players without a state
+			still kept get the whole state.
+
+	Parameters: Match - the match
+				Stats - the worker's stats
+
+	Return:	Nil
+*/
+
+static void 	ServerMatchBroadcast( ServerMatch* match, ServerStats* stats )
+{
+	Uint32 tick = match->state_tick++;
+
+	NetState* state = NetStateHistoryAdd( match->history, tick );
+	NetStateCapture( &(match->game), tick, state );
+
+	Uint16 magic = SERVER_STATE_MAGIC;
+
+	for( Uint16 p = 0; p < SERVER_PLAYERS; p++ )
+	{
+		if ( !match->seated[p] )
+			continue;
+
+		Uint8 packet[server_state_header_size + NET_STATE_BYTES_MAX];
+		Uint8* at = packet;
+
+		ServerPut( at, &magic, 2 );
+		ServerPut( at, &(match->id), 2 );
+		ServerPut( at, &(match->input_frames[p]), 4 );
+
+		const NetState* baseline = NetStateHistoryFind( match->history, match->state_acked[p] );
+
+		Uint32 size = NetStateEncode( state, baseline, at, NET_STATE_BYTES_MAX );
+		if ( size == 0 )
+			continue;
+
+		ServerSocketSend( match->socket, match->client_ip[p], match->client_port[p], packet, server_state_header_size + size );
+		++stats->packets_out;
+		stats->bytes_out += server_state_header_size + size;
+	}
+}
+
+/*
+	Server Match Tick
+
+	Purpose: Runs one tick of a match: takes in input,
+			ticks the game with every player's latest
+			input, and sends the state back.
+
+	Parameters: Match - the match
+				Due - when the tick was due, in us
+				Stats - the worker's stats
+
+	Return:	Nil
+*/
+
+static void 	ServerMatchTick( ServerMatch* match, Uint64 due, ServerStats* stats )
+{
+	Uint64 start = ServerNow();
+
+	ServerMatchReceive( match, stats );
+
+	Uint8 inputs[PLAYER_MAX] = {};
+	for( Uint16 p = 0; p < SERVER_PLAYERS; p++ )
+		inputs[p] = match->inputs[p];
+
+	ArenaReset( &(match->game.frame_arena) );
+	GameTick( &(match->game), inputs, 1000 / FPS );
+
+	ServerMatchBroadcast( match, stats );
+
+	Uint64 end = ServerNow();
+	Uint32 cost = (Uint32)( end - start );
+	Uint32 latency = (Uint32)( end > due ? end - due : 0 );
+
+	++stats->match_ticks;
+	stats->cost_us += cost;
+	if ( cost > stats->cost_max_us )
+		stats->cost_max_us = cost;
+	if ( cost > match->budget_us )
+		++stats->over_budget;
+
+	++stats->latency[ServerLatencyBucket( latency )];
+	if ( latency > stats->latency_max_us )
+		stats->latency_max_us = latency;
+}
+
+/*
+	Server Worker Run
+
+	Purpose: A worker thread. Pins itself to its core,
+			then runs every one of its matches once per
+			tick, on a fixed schedule. If it falls too
+			far behind, the missed ticks are dropped.
+
+	Parameters: Data - the ServerWorker, and the Server
+					running it
+
+	Return:	0
+*/
+
+static int 		ServerWorkerRun( void* data )
+{
+	ServerWorker* worker = (ServerWorker*)data;
+	Server* server = worker->server;
+
+	ServerPinThread( worker->core );
+
+	const Uint64 period = 1000000 / FPS;
+	Uint64 due = ServerNow();
+
+	while( SDL_AtomicGet( &(server->running) ) )
+	{
+		ServerWaitUntil( due );
+
+		for( Uint16 m = 0; m < worker->match_count; m++ )
+			ServerMatchTick( worker->matches[m], due, &(worker->stats) );
+
+		++worker->stats.frames;
+		due += period;
+
+		Uint64 now = ServerNow();
+		if ( now > due + SERVER_CATCHUP_TICKS * period )
+		{
+			Uint64 behind = ( now - due ) / period;
+			worker->stats.late_frames += (Uint32)behind;
+			due += behind * period;
+		}
+
+		SDL_AtomicLock( &(worker->published_lock) );
+		worker->published = worker->stats;
+		SDL_AtomicUnlock( &(worker->published_lock) );
+	}
+
+	return 0;
+}
+
+/*
+	Server Schedule
+
+	Purpose: Places every match on a worker, by its tick
+			budget. Each goes on the worker with the
+			least load, as long as the worker has room
+			for it in its tick.
+
+	Parameters: Server - the server
+
+	Return:	The number of matches placed
+*/
+
+static Uint16 	ServerSchedule( Server* server )
+{
+	const Uint32 capacity = ( 1000000 / FPS ) * SERVER_WORKER_LOAD / 100;
+	Uint16 placed = 0;
+
+	for( Uint16 m = 0; m < server->match_count; m++ )
+	{
+		ServerMatch* match = &(server->matches[m]);
+
+		ServerWorker* best = &(server->workers[0]);
+		for( Uint16 w = 1; w < server->worker_count; w++ )
+		{
+			if ( server->workers[w].load_us < best->load_us )
+				best = &(server->workers[w]);
+		}
+
+		if ( best->load_us + match->budget_us > capacity )
+			continue;
+
+		match->worker = best->index;
+		best->matches[best->match_count++] = match;
+		best->load_us += match->budget_us;
+		++placed;
+	}
+
+	if ( placed < server->match_count )
+		printf( "Error: Only %u of %u matches fit on %u workers, at %u us of each %u us tick\n",
+				placed, server->match_count, server->worker_count, capacity, 1000000 / FPS );
+
+	return placed;
+}
+
+/*
+	Server Stats Gather
+
+	Purpose: Adds up the stats every worker has
+			published.
+
+	Parameters: Server - the server
+				Total - receives the sum
+
+	Return:	Nil
+*/
+
+static void 	ServerStatsGather( Server* server, ServerStats* total )
+{
+	*total = ServerStats();
+
+	for( Uint16 w = 0; w < server->worker_count; w++ )
+	{
+		ServerWorker* worker = &(server->workers[w]);
+
+		SDL_AtomicLock( &(worker->published_lock) );
+		ServerStats stats = worker->published;
+		SDL_AtomicUnlock( &(worker->published_lock) );
+
+		total->match_ticks 	+= stats.match_ticks;
+		total->frames 		+= stats.frames;
+		total->cost_us 		+= stats.cost_us;
+		total->over_budget 	+= stats.over_budget;
+		total->late_frames 	+= stats.late_frames;
+		total->packets_in 	+= stats.packets_in;
+		total->packets_out 	+= stats.packets_out;
+		total->bytes_out 	+= stats.bytes_out;
+
+		if ( stats.cost_max_us > total->cost_max_us )
+			total->cost_max_us = stats.cost_max_us;
+		if ( stats.latency_max_us > total->latency_max_us )
+			total->latency_max_us = stats.latency_max_us;
+
+		for( Uint32 b = 0; b < SERVER_LATENCY_BUCKETS; b++ )
+			total->latency[b] += stats.latency[b];
+	}
+}
+
+/*
+	Server Report
+
+	Purpose: Prints the metrics for the time since the
+			last report: matches per core, ticks run,
+			tick latency and cost, and traffic.
+
+	Parameters: Server - the server
+				Last - the totals at the last report,
+					updated to now
+				Seconds - the time since the last report
+
+	Return:	Nil
+*/
+
+static void 	ServerReport( Server* server, ServerStats* last, double seconds )
+{
+	ServerStats now;
+	ServerStatsGather( server, &now );
+
+	ServerStats interval = now;
+	interval.match_ticks 	-= last->match_ticks;
+	interval.cost_us 		-= last->cost_us;
+	interval.over_budget 	-= last->over_budget;
+	interval.late_frames 	-= last->late_frames;
+	interval.packets_in 	-= last->packets_in;
+	interval.packets_out 	-= last->packets_out;
+	interval.bytes_out 		-= last->bytes_out;
+
+	for( Uint32 b = 0; b < SERVER_LATENCY_BUCKETS; b++ )
+		interval.latency[b] -= last->latency[b];
+
+	Uint32 p50 = ServerLatencyPercentile( interval.latency, 50 );
+	Uint32 p99 = ServerLatencyPercentile( interval.latency, 99 );
+
+	// Buckets are only so fine
+	if ( p50 > now.latency_max_us )
+		p50 = now.latency_max_us;
+	if ( p99 > now.latency_max_us )
+		p99 = now.latency_max_us;
+
+	Uint16 hosted = 0;
+	for( Uint16 w = 0; w < server->worker_count; w++ )
+		hosted += server->workers[w].match_count;
+
+	printf( "Server: %u matches on %u workers (%.1f per core), %.0f ticks/s, %u late ticks\n",
+			hosted, server->worker_count, (double)hosted / server->worker_count,
+			(double)interval.match_ticks / seconds, interval.late_frames );
+	printf( "Server: tick latency p50 %u us, p99 %u us, max %u us so far, cost %.1f us per tick (%u us max), %u over budget\n",
+			p50, p99, now.latency_max_us,
+			interval.match_ticks > 0 ? (double)interval.cost_us / interval.match_ticks : 0.0,
+			now.cost_max_us, interval.over_budget );
+	printf( "Server: %.0f packets/s in, %.0f packets/s out, %.0f KB/s out (%.0f bytes per state)\n",
+			(double)interval.packets_in / seconds, (double)interval.packets_out / seconds,
+			(double)interval.bytes_out / seconds / 1024,
+			interval.packets_out > 0 ? (double)interval.bytes_out / interval.packets_out : 0.0 );
+
+	*last = now;
+}
+
+/*
+	Server Clients Run
+
+	Purpose: The synthetic client thread. Plays both
+			seats of every match over loopback, sending
+			input every tick and timing how long the
+			server takes to acknowledge it.
+
+	Parameters: Data - the Server
+
+	Return:	0
+*/
+
+static int 		ServerClientsRun( void* data )
+{
+	Server* server = (Server*)data;
+	ServerClients* clients = server->clients;
+	Uint32 loopback = ServerLoopback();
+
+	const Uint64 period = 1000000 / FPS;
+	Uint64 due = ServerNow();
+
+	while( SDL_AtomicGet( &(server->running) ) )
+	{
+		ServerWaitUntil( due );
+		due += period;
+
+		Uint64 now = ServerNow();
+		Uint32 frame = clients->frame++;
+
+		for( Uint16 m = 0; m < server->match_count; m++ )
+		{
+			ServerMatch* match = &(server->matches[m]);
+			clients->sent_us[m][frame % SERVER_CLIENT_HISTORY] = now;
+
+			for( Uint16 p = 0; p < SERVER_PLAYERS; p++ )
+			{
+				int socket = clients->sockets[m][p];
+				if ( socket < 0 )
+					continue;
+
+				// Take in the states, timing the newest input they acknowledge.
+				// They aren't decoded, only their ticks are acknowledged
+				Uint8 packet[server_state_header_size + NET_STATE_BYTES_MAX];
+				Uint32 ip;
+				Uint16 port;
+				Uint32 size;
+
+				while( ( size = ServerSocketReceive( socket, packet, sizeof(packet), &ip, &port ) ) > 0 )
+				{
+					Uint32 state_tick, baseline_tick;
+					if ( size < server_state_header_size ||
+						 !NetStatePeek( packet + server_state_header_size, size - server_state_header_size, &state_tick, &baseline_tick ) )
+						continue;
+
+					const Uint8* at = packet + 2 + 2;
+					Uint32 ack;
+					ServerGet( at, &ack, 4 );
+
+					++clients->states;
+					clients->state_bytes += size;
+
+					Uint32* newest = &(clients->state_ticks[m][p]);
+					if ( *newest == NET_TICK_NONE || state_tick > *newest )
+						*newest = state_tick;
+
+					if ( ack <= clients->acked[m][p] || ack > frame || frame - ack >= SERVER_CLIENT_HISTORY )
+						continue;
+
+					clients->acked[m][p] = ack;
+
+					Uint32 round_trip = (Uint32)( now - clients->sent_us[m][(ack - 1) % SERVER_CLIENT_HISTORY] );
+					clients->round_trip_us += round_trip;
+					++clients->round_trips;
+					if ( round_trip > clients->round_trip_max_us )
+						clients->round_trip_max_us = round_trip;
+				}
+
+				// Start the match, and fly about shooting, the seats changing direction at different times
+				Uint8 input = INPUT_START | INPUT_SHOOT;
+				if ( p == 0 )
+					input |= ( (frame + m) / 45 % 2 == 0 ? INPUT_LEFT : INPUT_RIGHT );
+				else
+					input |= ( (frame + m) / 70 % 2 == 0 ? INPUT_UP : INPUT_DOWN );
+
+				Uint8 input_packet[SERVER_PACKET_MAX];
+				Uint8* put = input_packet;
+				Uint16 magic = SERVER_INPUT_MAGIC;
+				Uint8 player = (Uint8)p;
+
+				ServerPut( put, &magic, 2 );
+				ServerPut( put, &(match->id), 2 );
+				ServerPut( put, &player, 1 );
+				ServerPut( put, &frame, 4 );
+				ServerPut( put, &input, 1 );
+				ServerPut( put, &(clients->state_ticks[m][p]), 4 );
+
+				ServerSocketSend( socket, loopback, ServerPortOrder( match->port ), input_packet, (Uint32)(put - input_packet) );
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+	Server Clients Start
+
+	Purpose: Opens a socket for both seats of every
+			match, and starts the synthetic client
+			thread.
+
+	Parameters: Server - the server
+
+	Return:	True if the clients started
+*/
+
+static bool 	ServerClientsStart( Server* server )
+{
+	server->clients = new ServerClients;
+	ServerClients* clients = server->clients;
+
+	memset( clients->acked, 0, sizeof(clients->acked) );
+	memset( clients->sockets, -1, sizeof(clients->sockets) );
+	memset( clients->state_ticks, 0xFF, sizeof(clients->state_ticks) );
+
+	for( Uint16 m = 0; m < server->match_count; m++ )
+	{
+		for( Uint16 p = 0; p < SERVER_PLAYERS; p++ )
+		{
+			clients->sockets[m][p] = ServerSocketOpen( 0 );
+			if ( clients->sockets[m][p] < 0 )
+			{
+				printf( "Error: Unable to open a client socket for match %u\n", m );
+				return false;
+			}
+		}
+	}
+
+	clients->thread = SDL_CreateThread( ServerClientsRun, "Clients", server );
+	if ( clients->thread == nullptr )
+	{
+		printf( "Error: Unable to start the client thread\n" );
+		return false;
+	}
+
+	printf( "Clients: %u players on loopback\n", server->match_count * SERVER_PLAYERS );
+	return true;
+}
+
+/*
+	Server Clients Stop
+
+	Purpose: Waits for the client thread, prints what it
+			saw, and closes its sockets.
+
+	Parameters: Server - the server
+
+	Return:	Nil
+*/
+
+static void 	ServerClientsStop( Server* server )
+{
+	ServerClients* clients = server->clients;
+
+	if ( clients == nullptr )
+		return;
+
+	if ( clients->thread != nullptr )
+		SDL_WaitThread( clients->thread, nullptr );
+
+	Uint32 expected = clients->frame * server->match_count * SERVER_PLAYERS;
+
+	printf( "Clients: %u of %u states received, %.0f bytes each, round trip %.2f ms on average, %.2f ms at most\n",
+			clients->states, expected,
+			clients->states > 0 ? (double)clients->state_bytes / clients->states : 0.0,
+			clients->round_trips > 0 ? (double)clients->round_trip_us / clients->round_trips / 1000.0 : 0.0,
+			clients->round_trip_max_us / 1000.0 );
+
+	for( Uint16 m = 0; m < server->match_count; m++ )
+	{
+		for( Uint16 p = 0; p < SERVER_PLAYERS; p++ )
+		{
+			if ( clients->sockets[m][p] >= 0 )
+				ServerSocketClose( clients->sockets[m][p] );
+		}
+	}
+
+	delete clients;
+	server->clients = nullptr;
+}
+
+/*
+	Server Read Option
+
+	Purpose: Reads a number following an option on the
+			command line.
+
+	Parameters: Argc, Argv - the command line
+				I - the option's index, moved past the
+					number
+				Value - receives the number
+
+	Return:	True if there was a number
+*/
+
+static bool 	ServerReadOption( int argc, char** argv, int* i, Uint32* value )
+{
+	if ( *i + 1 >= argc )
+	{
+		printf( "Error: %s needs a number\n", argv[*i] );
+		return false;
+	}
+
+	*value = (Uint32)strtoul( argv[++(*i)], nullptr, 10 );
+	return true;
+}
+
+/*
+	Usage:
+
+	JetFighterServer [--matches N] [--workers N] [--port P]
+					 [--budget US] [--seconds S] [--clients]
+
+	Matches use ports P to P + N - 1. Workers default to
+	one per core, and each is given as many matches as
+	fit their tick budget. 0 seconds runs until Ctrl-C.
+	--clients plays every match from this machine, for
+	load testing.
+*/
+
+int main( int argc, char** argv )
+{
+	static Server server;
+
+	Uint32 matches = 16;
+	Uint32 workers = (Uint32)SDL_GetCPUCount();
+	Uint32 port = SERVER_PORT;
+	bool synthetic_clients = false;
+
+	for( int i = 1; i < argc; i++ )
+	{
+		bool read = true;
+
+		if ( strcmp( argv[i], "--matches" ) == 0 )
+			read = ServerReadOption( argc, argv, &i, &matches );
+		else if ( strcmp( argv[i], "--workers" ) == 0 )
+			read = ServerReadOption( argc, argv, &i, &workers );
+		else if ( strcmp( argv[i], "--port" ) == 0 )
+			read = ServerReadOption( argc, argv, &i, &port );
+		else if ( strcmp( argv[i], "--budget" ) == 0 )
+			read = ServerReadOption( argc, argv, &i, &(server.budget_us) );
+		else if ( strcmp( argv[i], "--seconds" ) == 0 )
+			read = ServerReadOption( argc, argv, &i, &(server.seconds) );
+		else if ( strcmp( argv[i], "--clients" ) == 0 )
+			synthetic_clients = true;
+		else
+		{
+			printf( "Error: Unknown option %s\n", argv[i] );
+			read = false;
+		}
+
+		if ( !read )
+			return -1;
+	}
+
+	if ( matches < 1 || matches > SERVER_MATCHES_MAX || port + matches > 0xFFFF )
+	{
+		printf( "Error: Between 1 and %u matches can be hosted, on ports up to 65535\n", SERVER_MATCHES_MAX );
+		return -1;
+	}
+
+	server.match_count 	= (Uint16)matches;
+	server.worker_count = (Uint16)( workers < 1 ? 1 : ( workers > SERVER_WORKERS_MAX ? SERVER_WORKERS_MAX : workers ) );
+	server.port 		= (Uint16)port;
+
+	printf( "--- JetFighter Server ---\n\n" );
+
+	// Pick the collision kernel before any worker needs it
+	UtilityAabbKernelBest();
+
+	// Matches are big, and need their member defaults
+	server.matches = new ServerMatch[server.match_count];
+	server.workers = new ServerWorker[server.worker_count];
+
+	int result = 0;
+
+	for( Uint16 m = 0; m < server.match_count; m++ )
+	{
+		server.matches[m].budget_us = server.budget_us;
+
+		if ( !ServerMatchSetup( &(server.matches[m]), m, (Uint16)( server.port + m ) ) )
+			result = -2;
+	}
+
+	Uint16 cores = (Uint16)SDL_GetCPUCount();
+	for( Uint16 w = 0; w < server.worker_count; w++ )
+	{
+		server.workers[w].server = &server;
+		server.workers[w].index = w;
+		server.workers[w].core 	= ( cores > 0 ? w % cores : 0 );
+	}
+
+	if ( result == 0 && ServerSchedule( &server ) < server.match_count )
+		result = -3;
+
+	if ( result == 0 )
+	{
+		SDL_AtomicSet( &(server.running), 1 );
+		signal( SIGINT, ServerSignal );
+
+		printf( "Server: %u matches on ports %u-%u, %u workers, %u us budget per match tick\n",
+				server.match_count, server.port, server.port + server.match_count - 1,
+				server.worker_count, server.budget_us );
+
+		for( Uint16 w = 0; w < server.worker_count; w++ )
+		{
+			server.workers[w].thread = SDL_CreateThread( ServerWorkerRun, "Worker", &(server.workers[w]) );
+			if ( server.workers[w].thread == nullptr )
+			{
+				printf( "Error: Unable to start worker %u\n", w );
+				result = -4;
+			}
+		}
+
+		if ( result == 0 && synthetic_clients && !ServerClientsStart( &server ) )
+			result = -5;
+
+		ServerStats last;
+		Uint64 start = ServerNow();
+		Uint64 report = start;
+
+		while( result == 0 && !server_interrupted &&
+			   ( server.seconds == 0 || ServerNow() - start < (Uint64)server.seconds * 1000000 ) )
+		{
+			SDL_Delay( 100 );
+
+			Uint64 now = ServerNow();
+			if ( now - report >= SERVER_REPORT_SECONDS * 1000000 )
+			{
+				ServerReport( &server, &last, (now - report) / 1e6 );
+				report = now;
+			}
+		}
+
+		SDL_AtomicSet( &(server.running), 0 );
+
+		ServerClientsStop( &server );
+
+		for( Uint16 w = 0; w < server.worker_count; w++ )
+		{
+			if ( server.workers[w].thread != nullptr )
+				SDL_WaitThread( server.workers[w].thread, nullptr );
+		}
+
+		// Over the whole run
+		ServerStats none;
+		ServerReport( &server, &none, ( ServerNow() - start ) / 1e6 );
+	}
+
+	for( Uint16 m = 0; m < server.match_count; m++ )
+		ServerMatchFree( &(server.matches[m]) );
+
+	delete[] server.workers;
+	delete[] server.matches;
+
+	return result;
+}